@@ -83,6 +83,136 @@ CREATE TABLE `man` (
 INSERT INTO man VALUES ('Man_01', 60, 1000, 1500, 3000, 2000);
 INSERT INTO man VALUES ('Man_02', 60, 1000, 1500, 3000, 2000);
 
+-- Recipes are optional: winders without a position run without a recipe.
+-- Spooler carriers are loaded with packages of one recipe only
+CREATE TABLE `masterrecipelist` (
+  `RecipeID` VARCHAR(20) NOT NULL PRIMARY KEY,
+  `RecipeName` VARCHAR(50)
+);
+INSERT INTO masterrecipelist VALUES ('AA', 'Recipe AA');
+INSERT INTO masterrecipelist VALUES ('BB', 'Recipe BB');
+INSERT INTO masterrecipelist VALUES ('CC', 'Recipe CC');
+INSERT INTO masterrecipelist VALUES ('DD', 'Recipe DD');
+INSERT INTO masterrecipelist VALUES ('EE', 'Recipe EE');
+
+CREATE TABLE `winder_positions` (
+  `WinderID` VARCHAR(20) NOT NULL PRIMARY KEY,
+  `RecipeID` VARCHAR(20) NOT NULL
+);
+INSERT INTO winder_positions VALUES ('W_01', 'AA');
+INSERT INTO winder_positions VALUES ('W_02', 'AA');
+INSERT INTO winder_positions VALUES ('W_03', 'AA');
+INSERT INTO winder_positions VALUES ('W_04', 'BB');
+INSERT INTO winder_positions VALUES ('W_05', 'BB');
+INSERT INTO winder_positions VALUES ('W_06', 'CC');
+INSERT INTO winder_positions VALUES ('W_07', 'CC');
+INSERT INTO winder_positions VALUES ('W_08', 'CC');
+INSERT INTO winder_positions VALUES ('W_09', 'CC');
+INSERT INTO winder_positions VALUES ('W_10', 'CC');
+INSERT INTO winder_positions VALUES ('W_11', 'DD');
+INSERT INTO winder_positions VALUES ('W_12', 'DD');
+INSERT INTO winder_positions VALUES ('W_13', 'DD');
+INSERT INTO winder_positions VALUES ('W_14', 'DD');
+INSERT INTO winder_positions VALUES ('W_15', 'DD');
+INSERT INTO winder_positions VALUES ('W_16', 'EE');
+INSERT INTO winder_positions VALUES ('W_17', 'EE');
+INSERT INTO winder_positions VALUES ('W_18', 'EE');
+INSERT INTO winder_positions VALUES ('W_19', 'EE');
+INSERT INTO winder_positions VALUES ('W_20', 'EE');
+
+-- Priorities are optional: without rows tasks are served in the order of
+-- creation. The lower Prio the earlier the winder is served
+CREATE TABLE `prio_doff` (
+  `Prio` INTEGER NOT NULL,
+  `Position_ID` VARCHAR(20) NOT NULL,
+  `Doffer_ID` VARCHAR(20) NOT NULL
+);
+INSERT INTO prio_doff VALUES (1, 'W_01', 'D_01');
+INSERT INTO prio_doff VALUES (2, 'W_02', 'D_01');
+INSERT INTO prio_doff VALUES (3, 'W_03', 'D_01');
+INSERT INTO prio_doff VALUES (4, 'W_04', 'D_01');
+INSERT INTO prio_doff VALUES (5, 'W_05', 'D_01');
+INSERT INTO prio_doff VALUES (1, 'W_06', 'D_02');
+INSERT INTO prio_doff VALUES (2, 'W_07', 'D_02');
+INSERT INTO prio_doff VALUES (3, 'W_08', 'D_02');
+INSERT INTO prio_doff VALUES (4, 'W_09', 'D_02');
+INSERT INTO prio_doff VALUES (5, 'W_10', 'D_02');
+INSERT INTO prio_doff VALUES (1, 'W_11', 'D_03');
+INSERT INTO prio_doff VALUES (2, 'W_12', 'D_03');
+INSERT INTO prio_doff VALUES (3, 'W_13', 'D_03');
+INSERT INTO prio_doff VALUES (4, 'W_14', 'D_03');
+INSERT INTO prio_doff VALUES (5, 'W_15', 'D_03');
+INSERT INTO prio_doff VALUES (1, 'W_16', 'D_04');
+INSERT INTO prio_doff VALUES (2, 'W_17', 'D_04');
+INSERT INTO prio_doff VALUES (3, 'W_18', 'D_04');
+INSERT INTO prio_doff VALUES (4, 'W_19', 'D_04');
+INSERT INTO prio_doff VALUES (5, 'W_20', 'D_04');
+
+CREATE TABLE `prio_sleever` (
+  `Prio` INTEGER NOT NULL,
+  `Position_ID` VARCHAR(20) NOT NULL,
+  `Sleever_ID` VARCHAR(20) NOT NULL
+);
+INSERT INTO prio_sleever VALUES (1, 'W_01', 'S_01');
+INSERT INTO prio_sleever VALUES (2, 'W_02', 'S_01');
+INSERT INTO prio_sleever VALUES (3, 'W_03', 'S_01');
+INSERT INTO prio_sleever VALUES (4, 'W_04', 'S_01');
+INSERT INTO prio_sleever VALUES (5, 'W_05', 'S_01');
+INSERT INTO prio_sleever VALUES (1, 'W_06', 'S_02');
+INSERT INTO prio_sleever VALUES (2, 'W_07', 'S_02');
+INSERT INTO prio_sleever VALUES (3, 'W_08', 'S_02');
+INSERT INTO prio_sleever VALUES (4, 'W_09', 'S_02');
+INSERT INTO prio_sleever VALUES (5, 'W_10', 'S_02');
+INSERT INTO prio_sleever VALUES (1, 'W_11', 'S_03');
+INSERT INTO prio_sleever VALUES (2, 'W_12', 'S_03');
+INSERT INTO prio_sleever VALUES (3, 'W_13', 'S_03');
+INSERT INTO prio_sleever VALUES (4, 'W_14', 'S_03');
+INSERT INTO prio_sleever VALUES (5, 'W_15', 'S_03');
+INSERT INTO prio_sleever VALUES (1, 'W_16', 'S_04');
+INSERT INTO prio_sleever VALUES (2, 'W_17', 'S_04');
+INSERT INTO prio_sleever VALUES (3, 'W_18', 'S_04');
+INSERT INTO prio_sleever VALUES (4, 'W_19', 'S_04');
+INSERT INTO prio_sleever VALUES (5, 'W_20', 'S_04');
+
 
   
   
+
+-- Failure rates are optional: objects without a row never fail. Times
+-- between failures and to repair are drawn from exponential distributions
+-- with these means (s). Doffers, sleevers and men break down between tasks
+CREATE TABLE `failure_rates` (
+  `ObjectID` VARCHAR(20) NOT NULL PRIMARY KEY,
+  `mtbf_s` INTEGER NOT NULL,
+  `mttr_s` INTEGER NOT NULL
+);
+INSERT INTO failure_rates VALUES ('W_01', 360000, 1800);
+INSERT INTO failure_rates VALUES ('W_02', 360000, 1800);
+INSERT INTO failure_rates VALUES ('W_03', 360000, 1800);
+INSERT INTO failure_rates VALUES ('W_04', 360000, 1800);
+INSERT INTO failure_rates VALUES ('W_05', 360000, 1800);
+INSERT INTO failure_rates VALUES ('W_06', 360000, 1800);
+INSERT INTO failure_rates VALUES ('W_07', 360000, 1800);
+INSERT INTO failure_rates VALUES ('W_08', 360000, 1800);
+INSERT INTO failure_rates VALUES ('W_09', 360000, 1800);
+INSERT INTO failure_rates VALUES ('W_10', 360000, 1800);
+INSERT INTO failure_rates VALUES ('W_11', 360000, 1800);
+INSERT INTO failure_rates VALUES ('W_12', 360000, 1800);
+INSERT INTO failure_rates VALUES ('W_13', 360000, 1800);
+INSERT INTO failure_rates VALUES ('W_14', 360000, 1800);
+INSERT INTO failure_rates VALUES ('W_15', 360000, 1800);
+INSERT INTO failure_rates VALUES ('W_16', 360000, 1800);
+INSERT INTO failure_rates VALUES ('W_17', 360000, 1800);
+INSERT INTO failure_rates VALUES ('W_18', 360000, 1800);
+INSERT INTO failure_rates VALUES ('W_19', 360000, 1800);
+INSERT INTO failure_rates VALUES ('W_20', 360000, 1800);
+INSERT INTO failure_rates VALUES ('D_01', 900000, 3600);
+INSERT INTO failure_rates VALUES ('D_02', 900000, 3600);
+INSERT INTO failure_rates VALUES ('D_03', 900000, 3600);
+INSERT INTO failure_rates VALUES ('D_04', 900000, 3600);
+INSERT INTO failure_rates VALUES ('S_01', 900000, 3600);
+INSERT INTO failure_rates VALUES ('S_02', 900000, 3600);
+INSERT INTO failure_rates VALUES ('S_03', 900000, 3600);
+INSERT INTO failure_rates VALUES ('S_04', 900000, 3600);
+INSERT INTO failure_rates VALUES ('Man_01', 14400, 900);
+INSERT INTO failure_rates VALUES ('Man_02', 14400, 900);
@@ -0,0 +1,608 @@
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QDebug>
+#include "analyser.h"
+
+const qint64 readChunk = 1 << 20;   // trace file read size (bytes)
+// Task type of the trace and the resource its session stands for
+struct TaskRole
+{
+  const char *type;       // task type name
+  int cause;              // resource the winder waits for while the task lasts
+  bool direct;            // true if the task serves the winder, false if it is the group activity
+};
+const TaskRole taskRoles[] = {
+  {"START_WINDER", RunAnalyser::MAN, true},
+  {"ROTATE_SPOOLER", RunAnalyser::SPOOLER, false},
+  {"CHANGE_SPOOLER", RunAnalyser::SPOOLER, false},
+  {"LOAD_SLEEVER", RunAnalyser::MAN, false},
+  {"DELIVER_BOBBINS", RunAnalyser::DOFFER, true},
+  {"DELIVER_SLEEVE", RunAnalyser::SLEEVER, true},
+  {"MOVE_SLEEVER", RunAnalyser::SLEEVER, true},
+  {"MOVE_DOFFER_SLEEVER", RunAnalyser::DOFFER, true},
+  {"HANDLE_COLLISION", RunAnalyser::COLLISION, false},
+  {"CUTEDGE_WINDER", RunAnalyser::MAN, true}
+};
+const int taskRoleCount = sizeof(taskRoles) / sizeof(taskRoles[0]);
+const char *const causeNames[] = {"doffer", "sleever", "spooler change", "man", "collision linking", "breakdown"};
+const char *const gainNames[] = {"+1 doffer", "+1 sleever", "", "+1 man", "no collision linking", ""};
+//_________________________________________________________
+//
+// Return the role index of the task type, -1 for state slices
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+static int findRole(const QString &type)
+{
+  for(int i = 0; i < taskRoleCount; i++)
+    if (type == taskRoles[i].type) return i;
+  return -1;
+}
+//_________________________________________________________
+//
+// Reset values of all causes
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+template<class T> static void clearCauses(T *values)
+{
+  for(int i = 0; i < RunAnalyser::CAUSE_COUNT; i++)
+    values[i] = 0;
+}
+//_________________________________________________________
+//
+// Object constructor. Nothing is analysed yet
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+RunAnalyser::RunAnalyser()
+{
+  m_men = 0;
+  m_events = 0;
+  m_beginTime = 0;
+  m_plant.winders = 0;
+  m_plant.productive = 0;
+  m_plant.idle = 0;
+  clearCauses(m_plant.loss);
+  clearCauses(m_plant.queue);
+}
+//_________________________________________________________
+//
+// Analyse the trace file. The first pass collects objects, task
+// sessions and winder failures, the second one shares task slices
+// among the failures
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool RunAnalyser::analyse(const QString &fileName)
+{
+  m_winderPids.clear();
+  m_men = 0;
+  m_tasks.clear();
+  m_winders.clear();
+  m_windows.clear();
+  m_winderWindows.clear();
+  m_groupWinders.clear();
+  m_groups.clear();
+
+  if (!readEvents(fileName, 0)) return false;
+  indexWindows();
+  if (!readEvents(fileName, 1)) return false;
+  resolveWindows();
+  sumGroups();
+  return true;
+}
+//_________________________________________________________
+//
+// Read trace events of the file and pass them to the pass handler.
+// Events are objects of the second nesting level, only their bounds
+// are looked for while reading and every event is parsed on its own
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool RunAnalyser::readEvents(const QString &fileName, int pass)
+{
+  QFile file(fileName);
+  if (!file.open(QIODevice::ReadOnly))
+  {
+    qDebug() << "Trace reading failed" << file.errorString() << fileName;
+    return false;
+  }
+  m_events = 0;
+  m_beginId.clear();
+
+  QByteArray event;
+  int depth = 0;
+  bool inString = false;
+  bool escaped = false;
+  while (!file.atEnd())
+  {
+    QByteArray chunk = file.read(readChunk);
+    const char *data = chunk.constData();
+    int eventStart = depth > 2 ? 0 : -1;
+    for(int i = 0; i < chunk.size(); i++)
+    {
+      char c = data[i];
+      if (inString)
+      {
+        if (escaped)
+          escaped = false;
+        else if (c == '\\')
+          escaped = true;
+        else if (c == '"')
+          inString = false;
+        continue;
+      }
+      if (c == '"')
+        inString = true;
+      else if (c == '{' || c == '[')
+      {
+        if (depth == 2 && c == '{')
+          eventStart = i;
+        depth++;
+      }
+      else if (c == '}' || c == ']')
+      {
+        depth--;
+        if (depth == 2 && eventStart >= 0)
+        {
+          event.append(data + eventStart, i + 1 - eventStart);
+          eventStart = -1;
+
+          QJsonParseError error;
+          QJsonDocument doc = QJsonDocument::fromJson(event, &error);
+          event.clear();
+          if (error.error != QJsonParseError::NoError)
+          {
+            qDebug() << "Trace event parsing failed" << error.errorString() << m_events;
+            return false;
+          }
+          m_events++;
+          if (pass == 0)
+            collectEvent(doc.object());
+          else
+            attributeEvent(doc.object());
+        }
+      }
+    }
+    // the event goes on in the next chunk
+    if (eventStart >= 0)
+      event.append(data + eventStart, chunk.size() - eventStart);
+  }
+  file.close();
+  return true;
+}
+//_________________________________________________________
+//
+// First pass handler: collect winders, men, task sessions and winder
+// status slices. Status slices of one object are recorded in the time
+// order, so the winding cycle of every failure is known at once
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void RunAnalyser::collectEvent(const QJsonObject &event)
+{
+  QString ph = event.value("ph").toString();
+  QString name = event.value("name").toString();
+  int pid = event.value("pid").toInt();
+
+  // trace processes are named by the object kind and Id
+  if (ph == "M")
+  {
+    if (name != "process_name") return;
+    QString process = event.value("args").toObject().value("name").toString();
+    if (process.startsWith("Winder "))
+    {
+      WinderTotals winder;
+      winder.cycleStart = -1;
+      winder.down = false;
+      winder.productive = 0;
+      winder.idle = 0;
+      clearCauses(winder.loss);
+      clearCauses(winder.queue);
+      m_winderPids.insert(pid, process.mid(7));
+      m_winders.insert(process.mid(7), winder);
+    }
+    else if (process.startsWith("Man "))
+      m_men++;
+  }
+  // winder status slices
+  else if (ph == "X")
+  {
+    if (event.value("cat").toString() != "status" || !m_winderPids.contains(pid)) return;
+    QString idWinder = m_winderPids.value(pid);
+    WinderTotals &winder = m_winders[idWinder];
+    qint64 time = qint64(event.value("ts").toDouble());
+    qint64 duration = qint64(event.value("dur").toDouble());
+
+    if (name == "EMPTY")
+    {
+      // the winder waits to be started by a man
+      winder.idle += duration;
+      winder.loss[MAN] += duration;
+      winder.queue[MAN] += duration;
+    }
+    else if (name == "DOWN")
+    {
+      // the winder is under repair, the cycle is lost
+      winder.idle += duration;
+      winder.loss[BREAKDOWN] += duration;
+      winder.cycleStart = -1;
+      winder.down = true;
+    }
+    else if (name == "FAIL" && winder.down)
+    {
+      // the repaired winder waits to be started by a man
+      winder.idle += duration;
+      winder.loss[MAN] += duration;
+      winder.queue[MAN] += duration;
+      winder.down = false;
+    }
+    else if (name == "FAIL" && duration == 0)
+    {
+      // the breakdown traces DOWN at once, no failure window
+    }
+    else if (name == "FAIL")
+    {
+      LossWindow window;
+      window.idWinder = idWinder;
+      window.start = winder.cycleStart >= 0 ? winder.cycleStart : time;
+      window.end = time;
+      window.loss = duration;
+      clearCauses(window.weight);
+      clearCauses(window.queue);
+      clearCauses(window.blocked);
+      clearCauses(window.activity);
+      clearCauses(window.activityQueue);
+      m_windows.append(window);
+      winder.idle += duration;
+      winder.cycleStart = -1;
+    }
+    else
+    {
+      // the cycle starts when bobbins are ready
+      winder.productive += duration;
+      if (name == "READY" || name == "CUTEDGE" || winder.cycleStart < 0)
+        winder.cycleStart = time;
+    }
+  }
+  // task sessions, state slices of the session are skipped
+  else if (ph == "b" && event.value("cat").toString() == "task")
+  {
+    int role = findRole(name);
+    if (role < 0) return;
+    QJsonObject args = event.value("args").toObject();
+    TaskInfo task;
+    task.role = role;
+    task.idObject = args.value("object").toString();
+    task.idGroup = args.value("group").toString();
+    m_tasks.insert(event.value("id").toString(), task);
+
+    // the group of the winder is known from its tasks
+    if (taskRoles[role].direct && m_winders.contains(task.idObject))
+    {
+      WinderTotals &winder = m_winders[task.idObject];
+      if (winder.idGroup.isEmpty())
+        winder.idGroup = task.idGroup;
+    }
+  }
+}
+//_________________________________________________________
+//
+// Put failure windows to their winders. Windows of one winder are its
+// successive cycles, so they are collected in the failure time order
+// and never overlap
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void RunAnalyser::indexWindows()
+{
+  for(int i = 0; i < m_windows.size(); i++)
+  {
+    const QString &idWinder = m_windows.at(i).idWinder;
+    QVector<int> &windows = m_winderWindows[idWinder];
+    if (windows.isEmpty())
+      m_groupWinders[m_winders.value(idWinder).idGroup].append(idWinder);
+    windows.append(i);
+  }
+}
+//_________________________________________________________
+//
+// Second pass handler: pair begin and end of task state slices. Both
+// events are recorded one after another
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void RunAnalyser::attributeEvent(const QJsonObject &event)
+{
+  if (event.value("cat").toString() != "task") return;
+  QString ph = event.value("ph").toString();
+  QString id = event.value("id").toString();
+  QString name = event.value("name").toString();
+  qint64 time = qint64(event.value("ts").toDouble());
+
+  if (ph == "b")
+  {
+    if (findRole(name) >= 0) return;
+    m_beginId = id;
+    m_beginName = name;
+    m_beginTime = time;
+    return;
+  }
+  if (ph != "e" || id != m_beginId || name != m_beginName) return;
+  m_beginId.clear();
+
+  QHash<QString, TaskInfo>::const_iterator it = m_tasks.constFind(id);
+  if (it != m_tasks.constEnd())
+    attributeSlice(it.value(), name, m_beginTime, time);
+}
+//_________________________________________________________
+//
+// Add the task state slice to the failure windows it overlaps. Winder
+// tasks are checked against windows of their winder, group activities
+// against windows of every failed winder of the group
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void RunAnalyser::attributeSlice(const TaskInfo &task, const QString &state, qint64 start, qint64 end)
+{
+  if (end <= start) return;
+  bool waiting = state == "NEW";
+  bool paused = state == "PAUSED";
+
+  if (taskRoles[task.role].direct)
+  {
+    QHash<QString, QVector<int> >::const_iterator it = m_winderWindows.constFind(task.idObject);
+    if (it != m_winderWindows.constEnd())
+      attributeWinder(it.value(), task, waiting, paused, start, end);
+    return;
+  }
+  foreach(const QString &idWinder, m_groupWinders.value(task.idGroup))
+    attributeWinder(m_winderWindows[idWinder], task, waiting, paused, start, end);
+}
+//_________________________________________________________
+//
+// Add the slice to the windows of one winder. The first window which
+// failed after the slice start is found by the binary search, windows
+// do not overlap, so only the last visited one may miss the slice
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void RunAnalyser::attributeWinder(const QVector<int> &windows, const TaskInfo &task, bool waiting, bool paused, qint64 start, qint64 end)
+{
+  const TaskRole &role = taskRoles[task.role];
+  int low = 0;
+  int high = windows.size();
+  while (low < high)
+  {
+    int middle = (low + high) >> 1;
+    if (m_windows.at(windows[middle]).end < start)
+      low = middle + 1;
+    else
+      high = middle;
+  }
+
+  for(int i = low; i < windows.size() && m_windows.at(windows[i]).start < end; i++)
+  {
+    LossWindow &window = m_windows[windows[i]];
+    qint64 overlap = qMin(end, window.end) - qMax(start, window.start);
+    if (overlap <= 0) continue;
+
+    if (!role.direct)
+    {
+      window.activity[role.cause] += overlap;
+      if (waiting)
+        window.activityQueue[role.cause] += overlap;
+    }
+    else if (paused)
+      window.blocked[role.cause] += overlap;
+    else
+    {
+      window.weight[role.cause] += overlap;
+      if (waiting)
+        window.queue[role.cause] += overlap;
+    }
+  }
+}
+//_________________________________________________________
+//
+// Share the failure time of every window among its causes. Paused
+// winder tasks wait for group activities (spooler changes, collision
+// linking, sleever loading) and are shared among them, if there are
+// none the assignee itself is the cause. A window without any waiting
+// is the sleever failure: the tray is not loaded in time
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void RunAnalyser::resolveWindows()
+{
+  for(int i = 0; i < m_windows.size(); i++)
+  {
+    LossWindow &window = m_windows[i];
+    qint64 active = 0;
+    for(int c = 0; c < CAUSE_COUNT; c++)
+      active += window.activity[c];
+
+    for(int c = 0; c < CAUSE_COUNT; c++)
+    {
+      if (window.blocked[c] == 0) continue;
+      if (active == 0)
+      {
+        window.weight[c] += window.blocked[c];
+        continue;
+      }
+      for(int k = 0; k < CAUSE_COUNT; k++)
+      {
+        window.weight[k] += qRound64(double(window.blocked[c]) * window.activity[k] / active);
+        window.queue[k] += qRound64(double(window.blocked[c]) * window.activityQueue[k] / active);
+      }
+    }
+
+    qint64 total = 0;
+    for(int c = 0; c < CAUSE_COUNT; c++)
+      total += window.weight[c];
+    if (total == 0)
+    {
+      window.weight[SLEEVER] = 1;
+      total = 1;
+    }
+
+    WinderTotals &winder = m_winders[window.idWinder];
+    for(int c = 0; c < CAUSE_COUNT; c++)
+    {
+      winder.loss[c] += double(window.loss) * window.weight[c] / total;
+      winder.queue[c] += double(window.loss) * window.queue[c] / total;
+    }
+  }
+}
+//_________________________________________________________
+//
+// Sum winder totals up by groups ordered by Id and for the plant
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void RunAnalyser::sumGroups()
+{
+  m_groups.clear();
+  m_plant.idGroup = "plant";
+  m_plant.winders = 0;
+  m_plant.productive = 0;
+  m_plant.idle = 0;
+  clearCauses(m_plant.loss);
+  clearCauses(m_plant.queue);
+
+  foreach(const WinderTotals &winder, m_winders)
+  {
+    int pos = 0;
+    while (pos < m_groups.size() && m_groups.at(pos).idGroup < winder.idGroup)
+      pos++;
+    if (pos == m_groups.size() || m_groups.at(pos).idGroup != winder.idGroup)
+    {
+      GroupTotals group;
+      group.idGroup = winder.idGroup;
+      group.winders = 0;
+      group.productive = 0;
+      group.idle = 0;
+      clearCauses(group.loss);
+      clearCauses(group.queue);
+      m_groups.insert(pos, group);
+    }
+
+    GroupTotals *totals[] = {&m_groups[pos], &m_plant};
+    for(int i = 0; i < 2; i++)
+    {
+      totals[i]->winders++;
+      totals[i]->productive += winder.productive;
+      totals[i]->idle += winder.idle;
+      for(int c = 0; c < CAUSE_COUNT; c++)
+      {
+        totals[i]->loss[c] += winder.loss[c];
+        totals[i]->queue[c] += winder.queue[c];
+      }
+    }
+  }
+}
+//_________________________________________________________
+//
+// Return the cause of the most non-productive time of the group,
+// -1 if winders of the group have not been idle
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+int RunAnalyser::getCritical(const GroupTotals &group) const
+{
+  int critical = -1;
+  for(int c = 0; c < CAUSE_COUNT; c++)
+    if (group.loss[c] > 0.0 && (critical < 0 || group.loss[c] > group.loss[critical]))
+      critical = c;
+  return critical;
+}
+//_________________________________________________________
+//
+// Estimate the non-productive time (us) saved by one more resource of
+// the cause. One more doffer or sleever halves the waiting for the busy
+// one, one more man shares the waiting for men (spooler changes
+// included) among one more, collision linking is saved completely
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+double RunAnalyser::getGain(const GroupTotals &group, Cause cause) const
+{
+  switch(cause)
+  {
+    case DOFFER:
+    case SLEEVER:
+      return group.queue[cause] / 2;
+    case MAN:
+      return (group.queue[MAN] + group.queue[SPOOLER]) / (m_men + 1);
+    case COLLISION:
+      return group.loss[COLLISION];
+    default:
+      return 0.0;
+  }
+}
+//_________________________________________________________
+//
+// Print the analysis: causes of the non-productive time, the critical
+// resource and what-if gains of every group and of the plant
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void RunAnalyser::print() const
+{
+  qDebug() << "Trace events:" << m_events << "task sessions:" << m_tasks.size()
+           << "failures:" << m_windows.size() << "men:" << m_men;
+
+  QList<GroupTotals> groups = m_groups;
+  groups.append(m_plant);
+  foreach(const GroupTotals &group, groups)
+  {
+    qint64 total = group.productive + group.idle;
+    qDebug() << "Group" << (group.idGroup.isEmpty() ? QString("-") : group.idGroup)
+             << "winders:" << group.winders
+             << "idle:" << group.idle / 1000 << "ms"
+             << QString::number(total > 0 ? 100.0 * group.idle / total : 0.0, 'f', 1) + "%";
+    if (group.idle == 0) continue;
+
+    for(int c = 0; c < CAUSE_COUNT; c++)
+      qDebug() << "  waiting for" << causeNames[c] << qRound64(group.loss[c] / 1000) << "ms"
+               << QString::number(100.0 * group.loss[c] / group.idle, 'f', 1) + "%";
+    int critical = getCritical(group);
+    if (critical >= 0)
+      qDebug() << "  critical resource:" << causeNames[critical];
+    for(int c = 0; c < CAUSE_COUNT; c++)
+    {
+      if (gainNames[c][0] == 0) continue;
+      double gain = getGain(group, Cause(c));
+      qDebug() << "  " << gainNames[c] << "saves" << QString::number(100.0 * gain / group.idle, 'f', 1) + "%"
+               << "of idle time";
+    }
+  }
+}
+//_________________________________________________________
+//
+// Save the analysis as JSON
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool RunAnalyser::save(const QString &fileName) const
+{
+  QJsonObject root;
+  root["events"] = m_events;
+  root["sessions"] = m_tasks.size();
+  root["failures"] = m_windows.size();
+  root["men"] = m_men;
+
+  QJsonArray groups;
+  foreach(const GroupTotals &it, m_groups)
+    groups.append(groupReport(it));
+  root["groups"] = groups;
+  root["plant"] = groupReport(m_plant);
+
+  QFile file(fileName);
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+  {
+    qDebug() << "Analysis saving failed" << file.errorString() << fileName;
+    return false;
+  }
+  file.write(QJsonDocument(root).toJson(QJsonDocument::Indented));
+  file.close();
+  return true;
+}
+//_________________________________________________________
+//
+// Return group totals as JSON, times are in ms, gains are percents
+// of the non-productive time
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+QJsonObject RunAnalyser::groupReport(const GroupTotals &group) const
+{
+  QJsonObject report;
+  report["id"] = group.idGroup;
+  report["winders"] = group.winders;
+  report["productive"] = group.productive / 1000;
+  report["idle"] = group.idle / 1000;
+
+  QJsonObject causes;
+  QJsonObject gains;
+  for(int c = 0; c < CAUSE_COUNT; c++)
+  {
+    causes[causeNames[c]] = qRound64(group.loss[c] / 1000);
+    if (gainNames[c][0] != 0)
+      gains[gainNames[c]] = group.idle > 0 ? 100.0 * getGain(group, Cause(c)) / group.idle : 0.0;
+  }
+  report["causes"] = causes;
+  report["gains"] = gains;
+
+  int critical = getCritical(group);
+  report["critical"] = critical >= 0 ? QString(causeNames[critical]) : QString();
+  return report;
+}
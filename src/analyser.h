@@ -0,0 +1,114 @@
+#ifndef ANALYSER_H
+#define ANALYSER_H
+
+#include <QString>
+#include <QList>
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+#include <QJsonObject>
+//_________________________________________________________
+//
+// Class analyses the recorded trace of the run. Non-productive time
+// of every winder (empty or failed) is attributed to its causes: the
+// failure is shared among the resources which kept bobbins and the
+// sleeve of the last winding cycle waiting. Causes are summed up per
+// doffer group to find its critical resource and to estimate gains
+// of one more resource. The trace file is read twice as a stream of
+// events, so the time is linear in the amount of events and the memory
+// depends on the amount of task sessions only.
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+class RunAnalyser
+{
+public:
+  // Causes of non-productive winder time
+  enum Cause
+  {
+    DOFFER = 0,     // waiting for the doffer
+    SLEEVER,        // waiting for the sleever
+    SPOOLER,        // waiting for a spooler change
+    MAN,            // waiting for a man
+    COLLISION,      // waiting for collision linking
+    BREAKDOWN,      // winder breakdown and repair
+    CAUSE_COUNT
+  };
+
+  RunAnalyser();
+
+  bool analyse(const QString &fileName);
+  void print() const;
+  bool save(const QString &fileName) const;
+
+private:
+  // Task session of the trace
+  struct TaskInfo
+  {
+    int role;               // task role index
+    QString idObject;       // task object Id
+    QString idGroup;        // doffer group Id of the object
+  };
+  // Winding cycle of the failed winder, the time it failed is the end
+  struct LossWindow
+  {
+    QString idWinder;             // failed winder Id
+    qint64 start;                 // cycle start (us)
+    qint64 end;                   // failure time (us)
+    qint64 loss;                  // time the winder stayed failed (us)
+    qint64 weight[CAUSE_COUNT];   // waiting time by causes (us)
+    qint64 queue[CAUSE_COUNT];    // part of the waiting time the task was not started (us)
+    qint64 blocked[CAUSE_COUNT];  // paused time of the winder tasks by assignee (us)
+    qint64 activity[CAUSE_COUNT]; // group activities time by causes (us)
+    qint64 activityQueue[CAUSE_COUNT];  // part of the activities time they were not started (us)
+  };
+  // Winder time totals
+  struct WinderTotals
+  {
+    QString idGroup;              // doffer group Id
+    qint64 cycleStart;            // current cycle start (us), -1 if not known
+    bool down;                    // true if the winder has broken down
+    qint64 productive;            // winding time (us)
+    qint64 idle;                  // non-productive time (us)
+    double loss[CAUSE_COUNT];     // non-productive time by causes (us)
+    double queue[CAUSE_COUNT];    // part of the loss tasks were waiting for the assignee (us)
+  };
+  // Group time totals
+  struct GroupTotals
+  {
+    QString idGroup;              // doffer group Id
+    int winders;                  // winders amount
+    qint64 productive;            // winding time of winders (us)
+    qint64 idle;                  // non-productive time of winders (us)
+    double loss[CAUSE_COUNT];     // non-productive time by causes (us)
+    double queue[CAUSE_COUNT];    // part of the loss tasks were waiting for the assignee (us)
+  };
+
+  bool readEvents(const QString &fileName, int pass);
+  void collectEvent(const QJsonObject &event);
+  void attributeEvent(const QJsonObject &event);
+  void attributeSlice(const TaskInfo &task, const QString &state, qint64 start, qint64 end);
+  void attributeWinder(const QVector<int> &windows, const TaskInfo &task, bool waiting, bool paused, qint64 start, qint64 end);
+  void indexWindows();
+  void resolveWindows();
+  void sumGroups();
+  int getCritical(const GroupTotals &group) const;
+  double getGain(const GroupTotals &group, Cause cause) const;
+  QJsonObject groupReport(const GroupTotals &group) const;
+
+  QHash<int, QString> m_winderPids;             // winder Id by trace process id
+  int m_men;                                    // men amount
+  QHash<QString, TaskInfo> m_tasks;             // task sessions by session Id
+  QHash<QString, WinderTotals> m_winders;       // winder totals by winder Id
+  QList<LossWindow> m_windows;                  // failure windows
+  QHash<QString, QVector<int> > m_winderWindows;  // window indexes of the winder ordered by the failure time
+  QHash<QString, QStringList> m_groupWinders;   // failed winders of the group
+  QList<GroupTotals> m_groups;                  // group totals
+  GroupTotals m_plant;                          // totals of all groups
+  qint64 m_events;                              // events read by the last pass
+
+  // the async slice begin waiting for its end
+  QString m_beginId;                            // session Id
+  QString m_beginName;                          // slice name
+  qint64 m_beginTime;                           // slice start (us)
+};
+
+#endif
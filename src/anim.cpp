@@ -1,32 +1,51 @@
 #include "winder.h"
 #include "anim.h"
-
-const int timerResolution = 70;
+#include "profiler.h"
+//_________________________________________________________
+//
+// Object constructor. The animation is stopped
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Animator::Animator()
+{
+  m_type = SPOOL1;
+  m_active = false;
+}
 //_________________________________________________________
 //
-// Object constructor. Set common styles and resize the control
+// Start the animation of the type in the area
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-Animator::Animator(Type srcType, int controlWidth, int controlHeight, QWidget *parent /*=0*/) :
-  QFrame(parent)
+void Animator::start(Type srcType, const QRect &rect)
 {
-  setLineWidth(1);
-  setFrameStyle(NoFrame | Plain);
-  setSizePolicy(QSizePolicy::Fixed, QSizePolicy::Fixed);
-  resize(controlWidth, controlHeight);
   m_type = srcType;   // set initial animation form
+  m_rect = rect;
+  m_active = true;
 }
 //_________________________________________________________
 //
-// Draw the control content according to the type
+// Move the overlay area to the new position
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-void Animator::paintEvent(QPaintEvent *pe)
+void Animator::moveTo(int x, int y)
 {
-  Q_UNUSED(pe)
-
-  QPainter painter;
-  QRect srcRect = rect();
+  m_rect.moveTo(x, y);
+}
+//_________________________________________________________
+//
+// Stop the animation
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Animator::stop()
+{
+  m_active = false;
+}
+//_________________________________________________________
+//
+// Draw the overlay content according to the type
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Animator::render(QPainter &painter, const QRect &exposed)
+{
+  if (!m_active || !m_rect.intersects(exposed)) return;
+  PROFILE_SCOPE("Animator::render");
 
-  painter.begin(this);      // open drawing context
+  QRect srcRect = m_rect;
 
   // use winder drawing static methods
   switch(m_type)
@@ -42,8 +61,24 @@ void Animator::paintEvent(QPaintEvent *pe)
     default:
       break;
   }
-  painter.end();        // close drawing context
 }
-
-
-
+//_________________________________________________________
+//
+// Append the compact state of the running animation: type and area
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Animator::saveState(QVector<qint32> &state)
+{
+  state.append(m_type);
+  state.append(m_rect.x());
+  state.append(m_rect.y());
+  state.append(m_rect.width());
+  state.append(m_rect.height());
+}
+//_________________________________________________________
+//
+// Start the animation recorded by saveState
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Animator::restoreState(const qint32 *state)
+{
+  start((Type)state[0], QRect(state[1], state[2], state[3], state[4]));
+}
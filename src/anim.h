@@ -1,15 +1,15 @@
 #ifndef ANIMATOR_H
 #define ANIMATOR_H
 
-#include <QFrame>
 #include <QtGui>
 //_________________________________________________________
 //
-// Class represents animation widget for doffer and sleever.
+// Class represents the animation overlay for doffer and sleever.
+// It is a plain state value owned by the locator and drawn by the
+// canvas, so starting and stopping animations allocates nothing
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-class Animator : public QFrame
+class Animator
 {
-  Q_OBJECT
 public:
   enum Type
   {
@@ -18,17 +18,23 @@ public:
     SLEEVE1,      // draw only half-length empty sleeve
     SLEEVE2       // draw only full-length empty sleeve
   };
-  explicit Animator(Type srcType, int controlWidth, int controlHeight, QWidget *parent = 0);
+  Animator();
 
-signals:
+  bool isActive() {return m_active;}
+  QRect getRect() {return m_rect;}
 
-public slots:
-
-protected:
-  virtual void paintEvent(QPaintEvent *);
+  void start(Type srcType, const QRect &rect);
+  void moveTo(int x, int y);
+  void stop();
+  void render(QPainter &painter, const QRect &exposed);
+  void saveState(QVector<qint32> &state);
+  void restoreState(const qint32 *state);
+  static int stateSize() {return 5;}
 
 private:
-  Type m_type;  // animation type
+  Type m_type;    // animation type
+  QRect m_rect;   // overlay area on the canvas
+  bool m_active;  // true if the animation is running
 };
 
 #endif
@@ -0,0 +1,62 @@
+#include <QElapsedTimer>
+#include <QDebug>
+#include "dispatchbench.h"
+//_________________________________________________________
+//
+// Object constructor. Connect the signal the way the supervisor did
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+DispatchBenchmark::DispatchBenchmark(QObject *parent /*=0*/) :
+  QObject(parent)
+{
+  m_sum = 0;
+  connect(this, SIGNAL(movement(QString,QPoint,int)), this, SLOT(moved(QString,QPoint,int)));
+}
+//_________________________________________________________
+//
+// Dispatch the amount of movement events both ways and print
+// events per second
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void DispatchBenchmark::run(int events)
+{
+  QElapsedTimer timer;
+  QString id("D1");
+  QPoint pos(100, 20);
+  LocatorObserver *observer = this;
+
+  timer.start();
+  for(int i = 0; i < events; i++)
+    emit movement(id, pos, i & 7);
+  qint64 signalNs = timer.nsecsElapsed();
+
+  timer.restart();
+  for(int i = 0; i < events; i++)
+    observer->locatorMoved(NULL, i & 7);
+  qint64 directNs = timer.nsecsElapsed();
+
+  double signalRate = signalNs > 0 ? events * 1e9 / signalNs : 0.0;
+  double directRate = directNs > 0 ? events * 1e9 / directNs : 0.0;
+  qDebug() << "Movement events:" << events << "checksum:" << m_sum;
+  qDebug() << "SIGNAL/SLOT events/sec:" << qRound64(signalRate);
+  qDebug() << "Observer events/sec:" << qRound64(directRate);
+  if (signalRate > 0.0)
+    qDebug() << "Speedup:" << directRate / signalRate;
+}
+//_________________________________________________________
+//
+// Slot handler of the string based connection
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void DispatchBenchmark::moved(QString idLocator, QPoint newPos, int delta)
+{
+  Q_UNUSED(idLocator)
+  Q_UNUSED(newPos)
+  m_sum += delta;
+}
+//_________________________________________________________
+//
+// Observer handler of the direct dispatch
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void DispatchBenchmark::locatorMoved(Locator *locator, int delta)
+{
+  Q_UNUSED(locator)
+  m_sum += delta;
+}
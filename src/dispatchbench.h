@@ -0,0 +1,32 @@
+#ifndef DISPATCHBENCH_H
+#define DISPATCHBENCH_H
+
+#include <QObject>
+#include <QPoint>
+#include "locator.h"
+//_________________________________________________________
+//
+// Class measures the locator movement dispatch: the former string
+// based signal / slot connection against the direct observer call.
+// Handlers do the same trivial work, so only the dispatch is counted
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+class DispatchBenchmark : public QObject, public LocatorObserver
+{
+  Q_OBJECT
+public:
+  explicit DispatchBenchmark(QObject *parent = 0);
+
+  void run(int events);
+  virtual void locatorMoved(Locator *locator, int delta);
+
+signals:
+  void movement(QString, QPoint, int);
+
+private slots:
+  void moved(QString idLocator, QPoint newPos, int delta);
+
+private:
+  qint64 m_sum;   // handled deltas, keeps handlers from being optimised out
+};
+
+#endif
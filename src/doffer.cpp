@@ -1,13 +1,18 @@
 #include "supervisor.h"
 #include "winder.h"
 #include "doffer.h"
+#include "profiler.h"
+#include "tracer.h"
+#include "simclock.h"
 
 const int timerResolution = 70;   // default tick latency for get & put doffer timers
+const int defaultCapacity = 2;    // bobbins of one full winder
+const char *const statusNames[] = {"IDLE", "DELIVER", "READY", "BUSY", "WAIT", "WAITWINDER"};   // status names for the trace
 //_________________________________________________________
 //
 // Object constructor. Set parameters from model, count max brake distance as extraWidth
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-Doffer::Doffer(DofferModel &model, QWidget *parent /*=0*/) :
+Doffer::Doffer(DofferModel &model, QObject *parent /*=0*/) :
   Locator(parent)
 {
   // count extra width and drawing control height
@@ -21,13 +26,14 @@ Doffer::Doffer(DofferModel &model, QWidget *parent /*=0*/) :
   m_timeGetIn = model.timeGetIn;
   m_timePutDown = model.timePutDown;
   m_id = model.idDoffer;
+  m_kind = DOFFER;
   m_speed = supervisor->toPixels(model.speed);
   m_accel = supervisor->toPixels(model.acceleration);
   m_amount = 0;
+  m_capacity = model.capacity > 0 ? model.capacity : defaultCapacity;
 
   // set idle state
   m_status = IDLE;
-  m_anim = NULL;
 
   m_getres_timer = 0;
   m_putres_timer = 0;
@@ -38,24 +44,20 @@ Doffer::Doffer(DofferModel &model, QWidget *parent /*=0*/) :
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 Doffer::~Doffer()
 {
-  destroyAnimator();
 }
 //_________________________________________________________
 //
 // Draw the control content according to its state
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-void Doffer::paintEvent(QPaintEvent *pe)
+void Doffer::draw(QPainter &painter)
 {
-  Q_UNUSED(pe)
+  PROFILE_SCOPE("Doffer::draw");
 
   // count beam sizes
-  QPainter painter;
   QRect srcRect = rect();
   QRect rct(srcRect.left(), srcRect.top(), srcRect.width(), controlHeight);
   QRect beamLeft(QPoint(srcRect.left(), srcRect.top()), m_bobbinsSize);
 
-  // open drawing context
-  painter.begin(this);
   painter.setPen(QPen(Qt::white, 1, Qt::SolidLine));
 
   // draw background and bobbins if its delivery state
@@ -81,9 +83,33 @@ void Doffer::paintEvent(QPaintEvent *pe)
 
   // draw the caption
   painter.drawText(rct.left() + 20, 15, m_id);
-
-  // close drawing context
-  painter.end();
+}
+//_________________________________________________________
+//
+// Append the compact state: position, status and bobbins onboard
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Doffer::saveState(QVector<qint32> &state)
+{
+  Locator::saveState(state);
+  state.append(m_status);
+  state.append(m_amount);
+}
+//_________________________________________________________
+//
+// Return the amount of state words
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+int Doffer::stateSize()
+{
+  return Locator::stateSize() + 2;
+}
+//_________________________________________________________
+//
+// Swap drawing fields with the recorded ones
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Doffer::exchangeState(qint32 *state)
+{
+  exchangeField(m_status, state[0]);
+  exchangeField(m_amount, state[1]);
 }
 //_________________________________________________________
 //
@@ -102,19 +128,19 @@ void Doffer::timerEvent(QTimerEvent* te)
     if (m_timeReach != 0)
       delta = (m_timeReach - m_timeLeft) * (pos().y() - m_destY) / m_timeReach;
     // move animator widget
-    m_anim->move(pos().x(), m_destY + delta);
+    moveAnimator(pos().x(), m_destY + delta);
     // if timer is over
     if (m_timeLeft == 0)
     {
-      // kill timer and destroy animator
-      killTimer(te->timerId());
+      // kill timer and stop animation
+      SimClock::killTimer(te->timerId());
       m_getres_timer = 0;
-      destroyAnimator();
+      hideAnimator();
       // update busy counter for the object
       updateLoggerItem(m_id, Logger::TIME_BUSY);
       // change status
       setStatus(DELIVER);
-      update();
+      refresh();
       // notify supervisor
       emit bobAboard(m_session);
     }
@@ -127,14 +153,14 @@ void Doffer::timerEvent(QTimerEvent* te)
     if (m_timeReach != 0 && m_amount > 0)
       delta = (m_timeReach - m_timeLeft) * ((m_destY - pos().y()) / m_amount) / m_timeReach;
     // move animator widget
-    m_anim->move(pos().x(), pos().y() + delta);
+    moveAnimator(pos().x(), pos().y() + delta);
     // if timer is over
     if (m_timeLeft == 0)
     {
-      // kill timer and destroy animator
-      killTimer(te->timerId());
+      // kill timer and stop animation
+      SimClock::killTimer(te->timerId());
       m_putres_timer = 0;
-      destroyAnimator();
+      hideAnimator();
       // update busy counter for the object
       updateLoggerItem(m_id, Logger::TIME_BUSY);
       // change status depending on amount left
@@ -156,7 +182,7 @@ void Doffer::timerEvent(QTimerEvent* te)
         emit taskCompleted(m_session);
       }
       // refresh widget after status change
-      update();
+      refresh();
     }
   }
 }
@@ -177,21 +203,21 @@ void Doffer::startMachine(OperFunc operation)
       break;
     case GETRES:  // get bobbins onboard action
       setStatus(BUSY);
-      update();
+      refresh();
       m_timeLeft = m_timeGetIn;
       m_timeReach = m_timeLeft;
-      m_movement_timer = 0;
+      haltMovement();
       m_putres_timer = 0;
-      m_getres_timer = startTimer(timerResolution);
+      m_getres_timer = SimClock::startTimer(this, timerResolution);
       break;
     case PUTRES:  // put bobbins action
       setStatus(BUSY);
-      update();
+      refresh();
       m_timeLeft = m_timePutDown;
       m_timeReach = m_timeLeft;
-      m_movement_timer = 0;
+      haltMovement();
       m_getres_timer = 0;
-      m_putres_timer = startTimer(timerResolution);
+      m_putres_timer = SimClock::startTimer(this, timerResolution);
       break;
     default:
       break;
@@ -203,7 +229,12 @@ void Doffer::startMachine(OperFunc operation)
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void Doffer::setStatus(Status state)
 {
+  Status prevStatus = m_status;
   m_status = state;
+  TraceRecorder::setStatus(m_id, statusNames[state]);
+  // notify supervisor
+  if (prevStatus != state)
+    emit statusChanged(m_id, prevStatus, state);
 }
 //_________________________________________________________
 //
@@ -214,12 +245,12 @@ void Doffer::getResult(QString idSession, int amount)
   // doffer should be in ready state
   if (m_status != READY) return;
 
-  // set amount to deliver
-  m_amount = amount;
+  // add amount to deliver, bobbins of several winders can be collected in one trip
+  m_amount += amount;
   // assign supervisor session
   m_session = idSession;
-  // create animator widget
-  createAnimator(m_amount == 1 ? Animator::SPOOL1 : Animator::SPOOL2, m_destY);
+  // start animation
+  showAnimator(amount == 1 ? Animator::SPOOL1 : Animator::SPOOL2, getDestX(), m_destY);
 
   // update idle counter for the object
   updateLoggerItem(m_id, Logger::TIME_IDLE);
@@ -241,8 +272,8 @@ void Doffer::putResult(QString idSession, int row, int column, int amount)
   m_amount = amount;
   // assign supervisor session
   m_session = idSession;
-  // create animator widget
-  createAnimator(m_amount == 1 ? Animator::SPOOL1 : Animator::SPOOL2, y());
+  // start animation
+  showAnimator(m_amount == 1 ? Animator::SPOOL1 : Animator::SPOOL2, getDestX(), y());
 
   // update idle counter for the object
   updateLoggerItem(m_id, Logger::TIME_IDLE);
@@ -251,35 +282,6 @@ void Doffer::putResult(QString idSession, int row, int column, int amount)
 }
 //_________________________________________________________
 //
-// Create animator widget
-//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-void Doffer::createAnimator(Animator::Type type, int yPos)
-{
-  // if already exists, destroy animator
-  destroyAnimator();
-  // create widget and set its position
-  m_anim = new Animator(type, m_bobbinsSize.width(), m_bobbinsSize.height(), parentWidget());
-  m_anim->move(m_destX, yPos);
-  // show widget
-  m_anim->show();
-}
-//_________________________________________________________
-//
-// Destroy animator widget
-//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-void Doffer::destroyAnimator()
-{
-  // if animation exists
-  if (m_anim != NULL)
-  {
-    // destroy it
-    m_anim->hide();
-    delete m_anim;
-  }
-  m_anim = NULL;
-}
-//_________________________________________________________
-//
 // Public action method for reaching
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void Doffer::reachObject(QString idSession, int x, int y, bool doEmit /* = true*/)
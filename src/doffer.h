@@ -1,7 +1,6 @@
 #ifndef DOFFER_H
 #define DOFFER_H
 
-#include <QFrame>
 #include <QtGui>
 #include "anim.h"
 #include "locator.h"
@@ -32,11 +31,15 @@ public:
     PUTRES        // put bobbins
   };
 
-  explicit Doffer(DofferModel &model, QWidget *parent = 0);
+  explicit Doffer(DofferModel &model, QObject *parent = 0);
   virtual ~Doffer();
+  virtual void draw(QPainter &painter);
+  virtual void saveState(QVector<qint32> &state);
+  virtual int stateSize();
 
   Status getStatus() {return m_status;}
   int getAmount() {return m_amount;}
+  int getCapacity() {return m_capacity;}
   int getControlHeight() {return controlHeight;}
 
   void setStatus(Status state);
@@ -46,6 +49,7 @@ public:
   virtual void reachObject(QString idSession, int x, int y, bool doEmit=true);
 
 signals:
+  void statusChanged(QString idObject, int prevStatus, int status);
   void bobAboard(QString idSession);
   void bobPlaced(QString idSession);
   void taskCompleted(QString);
@@ -54,19 +58,17 @@ public slots:
 
 protected:
   virtual void timerEvent(QTimerEvent *);
-  virtual void paintEvent(QPaintEvent *);
+  virtual void exchangeState(qint32 *state);
 
 private:
   void startMachine(OperFunc operation);
-  void createAnimator(Animator::Type, int yPos);
-  void destroyAnimator();
 
   Status m_status;      // current doffer status
   int m_timeGetIn;      // time setting for getting bobbins process
   int m_timePutDown;    // time setting for putting bobbins process
   int m_amount;         // amount of bobbings onboard
+  int m_capacity;       // max amount of bobbins onboard
 
-  Animator *m_anim;     // animator reference
   int controlHeight;    // drawing control height (real height includes bobbins as well)
 
   int m_getres_timer;   // timer id for getting bobbins process
@@ -0,0 +1,122 @@
+#include <math.h>
+#include "failure.h"
+
+const quint64 goldenGamma = Q_UINT64_C(0x9E3779B97F4A7C15);   // random stream increment
+const quint64 fnvBasis = Q_UINT64_C(0xCBF29CE484222325);      // object Id hash basis
+const quint64 fnvPrime = Q_UINT64_C(0x100000001B3);           // object Id hash multiplier
+//_________________________________________________________
+//
+// Object constructor. Nothing is scheduled
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+FailureScheduler::FailureScheduler()
+{
+  m_seed = 0;
+}
+//_________________________________________________________
+//
+// Drop all objects and events
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void FailureScheduler::clear()
+{
+  m_slots.clear();
+  m_index.clear();
+  m_events.clear();
+}
+//_________________________________________________________
+//
+// Add the object and schedule its first breakdown. Objects with
+// zero mean time between failures never fail
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void FailureScheduler::append(const QString &idObject, qint64 mtbf, qint64 mttr, qint64 now)
+{
+  if (mtbf <= 0 || m_index.contains(idObject)) return;
+
+  Slot slot;
+  slot.idObject = idObject;
+  slot.mtbf = mtbf;
+  slot.mttr = mttr;
+  // the stream depends on the Id, qHash is seeded per process
+  quint64 hash = fnvBasis;
+  for(int i = 0; i < idObject.size(); i++)
+    hash = (hash ^ idObject.at(i).unicode()) * fnvPrime;
+  slot.random = m_seed ^ hash;
+  slot.down = false;
+  m_slots.append(slot);
+  m_index.insert(idObject, m_slots.size() - 1);
+  schedule(m_slots.size() - 1, now + draw(m_slots.last(), mtbf), false);
+}
+//_________________________________________________________
+//
+// Return true if the object is broken
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool FailureScheduler::isDown(const QString &idObject) const
+{
+  int slot = m_index.value(idObject, -1);
+  return slot >= 0 && m_slots[slot].down;
+}
+//_________________________________________________________
+//
+// Take the earliest event if it is due by the time
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool FailureScheduler::takeDue(qint64 now, FailureEvent &event)
+{
+  if (m_events.isEmpty() || m_events.top().dueAt > now) return false;
+  event = m_events.pop();
+  return true;
+}
+//_________________________________________________________
+//
+// Break the object down and schedule its repair. Times are counted
+// from the due time, not from the time the event is handled
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void FailureScheduler::breakDown(const FailureEvent &event)
+{
+  Slot &slot = m_slots[event.slot];
+  slot.down = true;
+  schedule(event.slot, event.dueAt + draw(slot, slot.mttr), true);
+}
+//_________________________________________________________
+//
+// Repair the object and schedule its next breakdown
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void FailureScheduler::repair(const FailureEvent &event)
+{
+  Slot &slot = m_slots[event.slot];
+  slot.down = false;
+  schedule(event.slot, event.dueAt + draw(slot, slot.mtbf), false);
+}
+//_________________________________________________________
+//
+// Put the event off, i.e. until the object finishes its task
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void FailureScheduler::postpone(const FailureEvent &event, qint64 delay)
+{
+  schedule(event.slot, event.dueAt + qMax<qint64>(delay, 1), event.repair);
+}
+//_________________________________________________________
+//
+// Draw the exponential time with the mean value (ms). The stream
+// is the splitmix generator, the uniform value is never zero
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+qint64 FailureScheduler::draw(Slot &slot, qint64 mean)
+{
+  if (mean <= 0) return 0;
+  quint64 z = (slot.random += goldenGamma);
+  z = (z ^ (z >> 30)) * Q_UINT64_C(0xBF58476D1CE4E5B9);
+  z = (z ^ (z >> 27)) * Q_UINT64_C(0x94D049BB133111EB);
+  z ^= z >> 31;
+  double uniform = ((z >> 11) + 1) * (1.0 / 9007199254740992.0);
+  return qint64(-log(uniform) * mean);
+}
+//_________________________________________________________
+//
+// Push the event of the slot
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void FailureScheduler::schedule(int slot, qint64 dueAt, bool repair)
+{
+  FailureEvent event;
+  event.dueAt = dueAt;
+  event.slot = slot;
+  event.repair = repair;
+  m_events.push(event);
+}
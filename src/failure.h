@@ -0,0 +1,68 @@
+#ifndef FAILURE_H
+#define FAILURE_H
+
+#include <QString>
+#include <QVector>
+#include <QHash>
+#include "prioheap.h"
+// Scheduled breakdown or repair of the plant object
+struct FailureEvent
+{
+  qint64 dueAt;           // time the event is due (ms)
+  int slot;               // object slot
+  bool repair;            // true if the object gets repaired, false if it breaks down
+
+  bool operator<(const FailureEvent &other) const
+  {
+    return dueAt < other.dueAt || (dueAt == other.dueAt && slot < other.slot);
+  }
+};
+//_________________________________________________________
+//
+// Class schedules breakdowns and repairs of plant objects as future
+// events on the heap, nothing is rolled per tick. Times between
+// failures and to repair are drawn from exponential distributions.
+// Every object draws from its own random stream derived from the seed
+// and its Id, so the object gets the same times under the same seed
+// whatever the order events are handled in and other objects fail.
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+class FailureScheduler
+{
+public:
+  FailureScheduler();
+
+  void clear();
+  void setSeed(quint64 seed) {m_seed = seed;}
+  quint64 getSeed() const {return m_seed;}
+  void append(const QString &idObject, qint64 mtbf, qint64 mttr, qint64 now);
+
+  bool isDown(const QString &idObject) const;
+  QString getId(int slot) const {return m_slots[slot].idObject;}
+  qint64 nextDue() const {return m_events.isEmpty() ? -1 : m_events.top().dueAt;}
+  bool takeDue(qint64 now, FailureEvent &event);
+
+  void breakDown(const FailureEvent &event);
+  void repair(const FailureEvent &event);
+  void postpone(const FailureEvent &event, qint64 delay);
+
+private:
+  // Failure state of the object
+  struct Slot
+  {
+    QString idObject;     // object Id
+    qint64 mtbf;          // mean time between failures (ms)
+    qint64 mttr;          // mean time to repair (ms)
+    quint64 random;       // random stream state
+    bool down;            // true if the object is broken
+  };
+
+  qint64 draw(Slot &slot, qint64 mean);
+  void schedule(int slot, qint64 dueAt, bool repair);
+
+  quint64 m_seed;                   // random seed of the run
+  QVector<Slot> m_slots;            // objects which can fail
+  QHash<QString, int> m_index;      // object slot by Id
+  PriorityHeap<FailureEvent> m_events;  // scheduled events, the earliest first
+};
+
+#endif
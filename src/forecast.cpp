@@ -0,0 +1,36 @@
+#include "forecast.h"
+//_________________________________________________________
+//
+// Put predicted bobbins into the carriers. Arrivals should be sorted
+// by the ready time
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void FillForecaster::forecast(const QVector<CarrierState> &carriers, const QList<Arrival> &arrivals)
+{
+  QVector<CarrierState> state = carriers;
+  m_fillAt.fill(-1, state.size());
+  m_keptFor.fill(QString(), state.size());
+
+  foreach(const Arrival &it, arrivals)
+  {
+    for(int bobbin = 0; bobbin < it.bobbins; bobbin++)
+    {
+      // carrier of the recipe first, then an empty one
+      int carrier = -1;
+      for(int i = 0; i < state.size() && carrier < 0; i++)
+        if (state[i].idRecipe == it.idRecipe && state[i].freeCells > 0)
+          carrier = i;
+      for(int i = 0; i < state.size() && carrier < 0; i++)
+        if (state[i].idRecipe.isEmpty() && state[i].freeCells > 0)
+        {
+          carrier = i;
+          state[i].idRecipe = it.idRecipe;
+          m_keptFor[i] = it.idRecipe;
+        }
+
+      // the bobbin waits for a carrier change
+      if (carrier < 0) continue;
+      if (--state[carrier].freeCells == 0)
+        m_fillAt[carrier] = it.readyAt;
+    }
+  }
+}
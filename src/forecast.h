@@ -0,0 +1,41 @@
+#ifndef FORECAST_H
+#define FORECAST_H
+
+#include <QString>
+#include <QList>
+#include <QVector>
+// Carrier state for the fill forecast
+struct CarrierState
+{
+  QString idSpooler;      // Spooler Id
+  QString idRecipe;       // recipe the active side is dedicated to, empty if not dedicated
+  int freeCells;          // cells left on the active side
+};
+// Predicted bobbins of the doffer group
+struct Arrival
+{
+  qint64 readyAt;         // time the bobbins are ready (ms)
+  QString idRecipe;       // bobbins recipe
+  int bobbins;            // bobbins amount
+};
+//_________________________________________________________
+//
+// Class forecasts the filling of carriers of one doffer group. Predicted
+// bobbins are put into carriers in the time order the way reservations
+// are done: carriers of the recipe first, then an empty one. The forecast
+// tells when every carrier gets full and which recipe takes every
+// empty carrier first.
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+class FillForecaster
+{
+public:
+  void forecast(const QVector<CarrierState> &carriers, const QList<Arrival> &arrivals);
+  qint64 fillAt(int carrier) const {return m_fillAt[carrier];}
+  QString keptFor(int carrier) const {return m_keptFor[carrier];}
+
+private:
+  QVector<qint64> m_fillAt;     // time the carrier gets full, -1 if not predicted
+  QVector<QString> m_keptFor;   // recipe which takes the empty carrier first
+};
+
+#endif
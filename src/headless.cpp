@@ -0,0 +1,250 @@
+#include <QCoreApplication>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QFile>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QDebug>
+#include "headless.h"
+#include "simclock.h"
+
+const int batchTime = 20;             // wall time of one simulation batch, the event loop runs between batches (ms)
+const int headlessWidth = 1600;       // fixed plant width in pixels without main window
+//_________________________________________________________
+//
+// Object constructor.
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+HeadlessRunner::HeadlessRunner(qint64 duration, const QString &reportFile, QObject *parent /*=0*/) :
+  QObject(parent)
+{
+  m_supervisor = NULL;
+  m_duration = duration;
+  m_reportFile = reportFile;
+  m_timeCoefficient = 0;
+  m_failureSeed = 0;
+  m_endTime = 0;
+  m_run_timer = 0;
+
+  m_captureInterval = 0;
+  m_captureRaw = false;
+  m_frames = 0;
+  m_capture_timer = 0;
+}
+//_________________________________________________________
+//
+// Object destructor.
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+HeadlessRunner::~HeadlessRunner()
+{
+  if (m_supervisor != NULL) delete m_supervisor;
+}
+//_________________________________________________________
+//
+// Capture the plant every interval of simulation time (ms) into
+// the directory as numbered PNG files or as one raw frame stream
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void HeadlessRunner::setCapture(const QString &dir, qint64 interval, bool raw)
+{
+  m_captureDir = dir;
+  m_captureInterval = interval > 0 ? interval : 1000;
+  m_captureRaw = raw;
+}
+//_________________________________________________________
+//
+// Create supervisor and start the simulation. The clock is
+// advanced by the runner instead of the supervisor ticks
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void HeadlessRunner::start()
+{
+  m_supervisor = new Supervisor();
+  m_supervisor->SetWholeWidthPixels(headlessWidth);
+  m_supervisor->setTimeCoefficient(m_timeCoefficient);
+  m_supervisor->setFailureSeed(m_failureSeed);
+  m_supervisor->setExternalClock(true);
+  m_supervisor->start();
+  m_supervisor->startWinders();
+
+  // simulation time is the session clock time multiplied by the coefficient
+  int timeCoefficient = qMax(1, m_supervisor->getConfigModel().timeCoefficient);
+  m_endTime = (m_duration + timeCoefficient - 1) / timeCoefficient;
+  if (!m_captureDir.isEmpty() && startCapture())
+  {
+    captureFrame();
+    m_capture_timer = SimClock::startTimer(this, int(qMax<qint64>(1, m_captureInterval / timeCoefficient)));
+  }
+  m_run_timer = startTimer(0);
+}
+//_________________________________________________________
+//
+// Event handler for timer counters
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void HeadlessRunner::timerEvent(QTimerEvent *te)
+{
+  if (te->timerId() == m_run_timer)
+    run();
+  else if (te->timerId() == m_capture_timer)
+    captureFrame();
+}
+//_________________________________________________________
+//
+// Run the simulation batch. The clock jumps to the next due event
+// and delivers it until the batch time is over or the run end
+// is reached
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void HeadlessRunner::run()
+{
+  QElapsedTimer batch;
+  batch.start();
+  while (batch.elapsed() < batchTime)
+  {
+    qint64 due = SimClock::nextDue();
+    if (due < 0 || due > m_endTime)
+    {
+      SimClock::advanceTo(m_endTime);
+      finish();
+      return;
+    }
+    SimClock::advanceTo(due);
+  }
+}
+//_________________________________________________________
+//
+// Stop the simulation, save the report and quit
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void HeadlessRunner::finish()
+{
+  killTimer(m_run_timer);
+  m_run_timer = 0;
+  stopCapture();
+
+  bool result = m_reportFile.isEmpty() || saveReport();
+  m_supervisor->stop();
+  QCoreApplication::exit(result ? 0 : 1);
+}
+//_________________________________________________________
+//
+// Save simulation results as JSON
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool HeadlessRunner::saveReport()
+{
+  QJsonObject root;
+  root["duration"] = m_duration;
+  root["simTime"] = m_supervisor->simTime();
+  // the seed as a string, JSON numbers can not hold 64 bits
+  root["failureSeed"] = QString::number(m_supervisor->getFailureSeed());
+
+  // rolling window KPIs
+  QList<KpiValue> values;
+  m_supervisor->getKpiValues(values);
+  QJsonArray kpis;
+  foreach(const KpiValue &it, values)
+  {
+    QJsonObject kpi;
+    kpi["name"] = it.name;
+    kpi["unit"] = it.unit;
+    kpi["last5min"] = it.value[KpiEngine::LAST_5MIN];
+    kpi["lastHour"] = it.value[KpiEngine::LAST_HOUR];
+    kpi["shift"] = it.value[KpiEngine::SHIFT];
+    kpis.append(kpi);
+  }
+  root["kpi"] = kpis;
+
+  // winder start plans with predicted peak doffer queues
+  QJsonArray plans;
+  foreach(const StartPlanReport &it, m_supervisor->getStartPlans())
+  {
+    QJsonObject plan;
+    plan["doffer"] = it.idDoffer;
+    plan["winders"] = it.winders;
+    plan["spacing"] = it.spacing;
+    plan["peakBefore"] = it.peakBefore;
+    plan["peakAfter"] = it.peakAfter;
+    plans.append(plan);
+  }
+  root["startPlan"] = plans;
+
+  // captured frames
+  if (!m_captureDir.isEmpty())
+  {
+    QJsonObject frames;
+    frames["dir"] = m_captureDir;
+    frames["format"] = m_captureRaw ? "rgb32" : "png";
+    frames["interval"] = m_captureInterval;
+    frames["width"] = m_frame.width();
+    frames["height"] = m_frame.height();
+    frames["count"] = m_frames;
+    root["frames"] = frames;
+  }
+
+  QFile file(m_reportFile);
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+  {
+    qDebug() << "Report saving failed" << file.errorString() << m_reportFile;
+    return false;
+  }
+  file.write(QJsonDocument(root).toJson(QJsonDocument::Indented));
+  file.close();
+  return true;
+}
+//_________________________________________________________
+//
+// Prepare the frame buffer and the output
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool HeadlessRunner::startCapture()
+{
+  QDir dir;
+  if (!dir.mkpath(m_captureDir))
+  {
+    qDebug() << "Capture directory creation failed" << m_captureDir;
+    return false;
+  }
+
+  // frame width is even to keep video encoders happy
+  QSize size = m_supervisor->getLayoutSize();
+  m_frame = QImage((size.width() + 1) & ~1, (size.height() + 1) & ~1, QImage::Format_RGB32);
+
+  if (m_captureRaw)
+  {
+    m_rawFile.setFileName(QDir(m_captureDir).filePath("frames.rgb32"));
+    if (!m_rawFile.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+      qDebug() << "Capture stream creation failed" << m_rawFile.errorString() << m_rawFile.fileName();
+      return false;
+    }
+  }
+  m_frames = 0;
+  return true;
+}
+//_________________________________________________________
+//
+// Render the current plant state and write it. Frames are due
+// on the simulation clock, so none of them is skipped
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void HeadlessRunner::captureFrame()
+{
+  m_supervisor->renderTo(m_frame);
+
+  if (m_captureRaw)
+    m_rawFile.write((const char *)m_frame.constBits(), m_frame.bytesPerLine() * m_frame.height());
+  else
+  {
+    QString fileName = QString("frame%1.png").arg(m_frames, 6, 10, QChar('0'));
+    if (!m_frame.save(QDir(m_captureDir).filePath(fileName)))
+      qDebug() << "Frame saving failed" << fileName;
+  }
+  m_frames++;
+}
+//_________________________________________________________
+//
+// Stop capture and close the output
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void HeadlessRunner::stopCapture()
+{
+  if (m_capture_timer > 0)
+  {
+    SimClock::killTimer(m_capture_timer);
+    m_capture_timer = 0;
+  }
+  if (m_rawFile.isOpen())
+    m_rawFile.close();
+}
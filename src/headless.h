@@ -0,0 +1,57 @@
+#ifndef HEADLESS_H
+#define HEADLESS_H
+
+#include <QObject>
+#include <QJsonObject>
+#include <QImage>
+#include <QFile>
+#include "supervisor.h"
+//_________________________________________________________
+//
+// Class runs the simulation without main window for the given
+// simulation time and saves the JSON report at the end. The
+// simulation clock jumps from one due event to the next, so the
+// run takes as long as the events take to handle
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+class HeadlessRunner : public QObject
+{
+  Q_OBJECT
+public:
+  explicit HeadlessRunner(qint64 duration, const QString &reportFile, QObject *parent = 0);
+  virtual ~HeadlessRunner();
+
+  void setTimeCoefficient(int timeCoefficient) {m_timeCoefficient = timeCoefficient;}
+  void setFailureSeed(quint64 seed) {m_failureSeed = seed;}
+  void setCapture(const QString &dir, qint64 interval, bool raw);
+  void start();
+
+protected:
+  virtual void timerEvent(QTimerEvent *);
+
+private:
+  void run();
+  void finish();
+  bool saveReport();
+  bool startCapture();
+  void captureFrame();
+  void stopCapture();
+
+  Supervisor *m_supervisor;   // simulation supervisor
+  qint64 m_duration;          // simulation time to run (ms)
+  QString m_reportFile;       // report file name, empty if not necessary
+  int m_timeCoefficient;      // time coefficient override, 0 to use the database value
+  quint64 m_failureSeed;      // breakdowns random seed, 0 to take it from the clock
+  qint64 m_endTime;           // session clock time of the run end (ms)
+  int m_run_timer;            // simulation batch timer id
+
+  // frame capture
+  QString m_captureDir;       // frames directory, empty if capture is off
+  qint64 m_captureInterval;   // simulation time between frames (ms)
+  bool m_captureRaw;          // true to write one raw RGB32 stream instead of PNG files
+  int m_frames;               // captured frames amount
+  QImage m_frame;             // reusable frame buffer
+  QFile m_rawFile;            // raw frame stream
+  int m_capture_timer;        // frame capture timer id of the simulation clock
+};
+
+#endif
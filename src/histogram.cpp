@@ -0,0 +1,82 @@
+#include <QtAlgorithms>
+#include "histogram.h"
+//_________________________________________________________
+//
+// Object constructor. All buckets are empty
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Histogram::Histogram()
+{
+  reset();
+}
+//_________________________________________________________
+//
+// Clean up all buckets and counters
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Histogram::reset()
+{
+  for(int i = 0; i < BUCKET_COUNT; i++)
+    m_buckets[i] = 0;
+  m_count = 0;
+  m_sum = 0;
+  m_max = 0;
+}
+//_________________________________________________________
+//
+// Add the sample. Negative values are counted as 0
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Histogram::add(qint64 value)
+{
+  if (value < 0) value = 0;
+  m_buckets[bucketIndex(value)]++;
+  m_count++;
+  m_sum += value;
+  if (value > m_max)
+    m_max = value;
+}
+//_________________________________________________________
+//
+// Return the value below which p (0..1) part of samples fall
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+qint64 Histogram::percentile(double p) const
+{
+  if (m_count == 0) return 0;
+
+  // count the rank of the requested sample
+  qint64 rank = (qint64)(p * m_count + 0.5);
+  if (rank < 1) rank = 1;
+  if (rank > m_count) rank = m_count;
+
+  // walk buckets until the rank is reached
+  qint64 counter = 0;
+  for(int i = 0; i < BUCKET_COUNT; i++)
+  {
+    counter += m_buckets[i];
+    if (counter >= rank)
+      return qMin(bucketValue(i), m_max);
+  }
+  return m_max;
+}
+//_________________________________________________________
+//
+// Calculate bucket index: values below 16 are exact, others keep
+// 4 bits after the most significant one
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+int Histogram::bucketIndex(qint64 value)
+{
+  if (value < SUB_COUNT) return (int)value;
+  int msb = 63 - qCountLeadingZeroBits((quint64)value);
+  int shift = msb - SUB_BITS;
+  int mantissa = (int)(value >> shift) & (SUB_COUNT - 1);
+  return ((shift + 1) << SUB_BITS) + mantissa;
+}
+//_________________________________________________________
+//
+// Calculate the lowest value which falls into the bucket
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+qint64 Histogram::bucketValue(int index)
+{
+  if (index < SUB_COUNT) return index;
+  int shift = (index >> SUB_BITS) - 1;
+  int mantissa = index & (SUB_COUNT - 1);
+  return (qint64)(SUB_COUNT + mantissa) << shift;
+}
@@ -0,0 +1,143 @@
+#include "history.h"
+//_________________________________________________________
+//
+// Object constructor. The history is empty
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+StateHistory::StateHistory(qint64 depth, int keyframeInterval)
+{
+  m_depth = depth;
+  m_keyframeInterval = keyframeInterval > 0 ? keyframeInterval : 1;
+  m_count = 0;
+}
+//_________________________________________________________
+//
+// Drop all states
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void StateHistory::clear()
+{
+  m_segments.clear();
+  m_count = 0;
+}
+//_________________________________________________________
+//
+// Add the state at the simulation time. The new keyframe is
+// started when the segment is full or the delta gets too big
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void StateHistory::append(qint64 time, const QVector<qint32> &state)
+{
+  bool isKeyframe = m_segments.isEmpty() || m_segments.last().times.size() >= m_keyframeInterval;
+  if (!isKeyframe)
+  {
+    Segment &segment = m_segments.last();
+    int start = segment.deltas.size();
+    encodeDelta(segment, state);
+    // the delta is bigger than a half of the state, the keyframe is cheaper
+    if ((segment.deltas.size() - start) * 2 > state.size())
+    {
+      segment.deltas.resize(start);
+      isKeyframe = true;
+    }
+    else
+    {
+      segment.offsets.append(start);
+      segment.times.append(time);
+    }
+  }
+  if (isKeyframe)
+  {
+    Segment segment;
+    segment.keyframe = state;
+    segment.times.append(time);
+    m_segments.append(segment);
+  }
+  m_count++;
+
+  // drop the oldest segments out of the depth, the newest one is always kept
+  while (m_segments.size() > 1 && time - m_segments.at(1).times.first() >= m_depth)
+  {
+    m_count -= m_segments.first().times.size();
+    m_segments.removeFirst();
+  }
+}
+//_________________________________________________________
+//
+// Append the delta record of the state against the segment keyframe
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void StateHistory::encodeDelta(Segment &segment, const QVector<qint32> &state)
+{
+  const QVector<qint32> &key = segment.keyframe;
+  int start = segment.deltas.size();
+  segment.deltas.append(state.size());
+  segment.deltas.append(0);
+  int pairs = 0;
+  for(int i = 0; i < state.size(); i++)
+  {
+    if (i < key.size() && key.at(i) == state.at(i)) continue;
+    segment.deltas.append(i);
+    segment.deltas.append(state.at(i));
+    pairs++;
+  }
+  segment.deltas[start + 1] = pairs;
+}
+//_________________________________________________________
+//
+// Return the segment of the state index and convert the index
+// into the segment one. Return -1 if the index is out of range
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+int StateHistory::findSegment(int &index)
+{
+  if (index < 0 || index >= m_count) return -1;
+  for(int i = 0; i < m_segments.size(); i++)
+  {
+    int count = m_segments.at(i).times.size();
+    if (index < count)
+      return i;
+    index -= count;
+  }
+  return -1;
+}
+//_________________________________________________________
+//
+// Return the simulation time of the state, the oldest state is 0
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+qint64 StateHistory::timeAt(int index)
+{
+  int segment = findSegment(index);
+  if (segment < 0) return 0;
+  return m_segments.at(segment).times.at(index);
+}
+//_________________________________________________________
+//
+// Restore the state from the keyframe and its delta
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool StateHistory::stateAt(int index, QVector<qint32> &state)
+{
+  int found = findSegment(index);
+  if (found < 0) return false;
+
+  const Segment &segment = m_segments.at(found);
+  state = segment.keyframe;
+  if (index == 0) return true;
+
+  const qint32 *delta = segment.deltas.constData() + segment.offsets.at(index - 1);
+  state.resize(delta[0]);
+  int pairs = delta[1];
+  delta += 2;
+  for(int i = 0; i < pairs; i++, delta += 2)
+    state[delta[0]] = delta[1];
+  return true;
+}
+//_________________________________________________________
+//
+// Return the approximate memory used by the states (bytes)
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+qint64 StateHistory::memoryUsage()
+{
+  qint64 total = 0;
+  foreach(const Segment &it, m_segments)
+  {
+    total += it.keyframe.size() * sizeof(qint32) + it.deltas.size() * sizeof(qint32);
+    total += it.times.size() * sizeof(qint64) + it.offsets.size() * sizeof(int);
+  }
+  return total;
+}
@@ -0,0 +1,44 @@
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include <QList>
+#include <QVector>
+//_________________________________________________________
+//
+// Class keeps the bounded history of compact plant states. Every
+// state is a flat array of words. States are grouped in segments:
+// the first state of the segment is stored completely as keyframe,
+// the others as sparse deltas against it, so any state is restored
+// from the keyframe and one delta. Segments older than the depth
+// are dropped as a whole.
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+class StateHistory
+{
+public:
+  StateHistory(qint64 depth, int keyframeInterval);
+
+  void clear();
+  void append(qint64 time, const QVector<qint32> &state);
+  int size() {return m_count;}
+  qint64 timeAt(int index);
+  bool stateAt(int index, QVector<qint32> &state);
+  qint64 memoryUsage();
+
+private:
+  struct Segment
+  {
+    QVector<qint32> keyframe;   // complete first state
+    QVector<qint64> times;      // simulation time of every state, keyframe first (ms)
+    QVector<int> offsets;       // delta start for every state after the keyframe
+    QVector<qint32> deltas;     // delta records: length, pairs amount, (index, value) pairs
+  };
+  void encodeDelta(Segment &segment, const QVector<qint32> &state);
+  int findSegment(int &index);
+
+  QList<Segment> m_segments;    // segments ring, the oldest first
+  int m_count;                  // amount of states in all segments
+  qint64 m_depth;               // simulation time span to keep (ms)
+  int m_keyframeInterval;       // max amount of states in the segment
+};
+
+#endif
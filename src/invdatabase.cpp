@@ -2,16 +2,17 @@
 #include <QSqlQuery>
 #include <QSqlError>
 #include <QSqlRecord>
+#include <QHash>
 #include <QDebug>
 #include "invdatabase.h"
 
 //_________________________________________________________
 //
-// Open scirocco database
+// Open scirocco database. Every thread needs its own connection name
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-QSqlDatabase InventoryDatabase::open()
+QSqlDatabase InventoryDatabase::open(const QString &connectionName /*= "scirocco"*/)
 {
-  QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", "scirocco");
+  QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
   db.setDatabaseName("scirocco.db ");
   if (!db.open())
     {
@@ -89,6 +90,88 @@ bool InventoryDatabase::getWindersView(QSqlDatabase &db, QList<WinderModel *> &l
 }
 //_________________________________________________________
 //
+// Set recipes of winder models from winder positions. Recipe tables
+// are optional: winders of older databases run without recipes
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool InventoryDatabase::getWinderRecipes(QSqlDatabase &db, QList<WinderModel *> &list)
+{
+  // Check if database is opened
+  if (!db.isOpen())
+    return false;
+
+  // Run recipe query, positions of unknown recipes are skipped
+  QSqlQuery query(db);
+  if (!query.exec("SELECT p.WinderID, p.RecipeID FROM winder_positions p " \
+                  "JOIN masterrecipelist r ON r.RecipeID = p.RecipeID"))
+    {
+      qDebug() << "SELECT recipes failed, winders run without recipes" << query.lastError().text();
+      return false;
+    }
+
+  // map winder models by id
+  QHash<QString, WinderModel *> winders;
+  foreach(WinderModel *it, list)
+    winders.insert(it->idWinder, it);
+
+  // Reading records and set the recipes
+  QSqlRecord rec = query.record();
+  while (query.next())
+  {
+    WinderModel *winderModel = winders.value(query.value(rec.indexOf("WinderID")).toString(), NULL);
+    if (winderModel != NULL)
+      winderModel->idRecipe = query.value(rec.indexOf("RecipeID")).toString();
+  }
+  return true;
+}
+//_________________________________________________________
+//
+// Set doffing and sleeving priorities of winder models. Priority
+// tables are optional: without them tasks are served in the order
+// of creation. Rows of other doffers or sleevers are skipped
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool InventoryDatabase::getWinderPriorities(QSqlDatabase &db, QList<WinderModel *> &list)
+{
+  // Check if database is opened
+  if (!db.isOpen())
+    return false;
+
+  // map winder models by id
+  QHash<QString, WinderModel *> winders;
+  foreach(WinderModel *it, list)
+    winders.insert(it->idWinder, it);
+
+  // Run doffing priority query
+  QSqlQuery query(db);
+  if (!query.exec("SELECT Prio, Position_ID, Doffer_ID FROM prio_doff"))
+    {
+      qDebug() << "SELECT doffing priorities failed" << query.lastError().text();
+      return false;
+    }
+  QSqlRecord rec = query.record();
+  while (query.next())
+  {
+    WinderModel *winderModel = winders.value(query.value(rec.indexOf("Position_ID")).toString(), NULL);
+    if (winderModel != NULL && winderModel->idDoffer == query.value(rec.indexOf("Doffer_ID")).toString())
+      winderModel->prioDoff = query.value(rec.indexOf("Prio")).toInt();
+  }
+
+  // Run sleeving priority query
+  if (!query.exec("SELECT Prio, Position_ID, Sleever_ID FROM prio_sleever"))
+    {
+      qDebug() << "SELECT sleeving priorities failed" << query.lastError().text();
+      return false;
+    }
+  rec = query.record();
+  while (query.next())
+  {
+    WinderModel *winderModel = winders.value(query.value(rec.indexOf("Position_ID")).toString(), NULL);
+    if (winderModel != NULL && winderModel->idSleever == query.value(rec.indexOf("Sleever_ID")).toString())
+      winderModel->prioSleever = query.value(rec.indexOf("Prio")).toInt();
+  }
+  return true;
+}
+//_________________________________________________________
+//
 // Fill up doffer models list from database
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 bool InventoryDatabase::getDoffersView(QSqlDatabase &db, QList<DofferModel *> &list, int timeCoeff)
@@ -118,6 +201,7 @@ bool InventoryDatabase::getDoffersView(QSqlDatabase &db, QList<DofferModel *> &l
     itemModel->timePutDown = query.value(rec.indexOf("pdown_time_ms")).toInt();
     itemModel->acceleration = query.value(rec.indexOf("accel_mm_ss")).toInt();
     itemModel->width = query.value(rec.indexOf("width_mm")).toInt();
+    itemModel->capacity = query.value(rec.indexOf("capacity")).toInt();    // optional column
 
     if (timeCoeff > 0)
     {
@@ -261,6 +345,44 @@ bool InventoryDatabase::getMenView(QSqlDatabase &db, QList<ManServiceModel *> &l
 }
 //_________________________________________________________
 //
+// Fill up failure models list from database. The failure table is
+// optional: objects without rows never fail
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool InventoryDatabase::getFailuresView(QSqlDatabase &db, QList<FailureModel *> &list, int timeCoeff)
+{
+  // Check if database is opened
+  if (!db.isOpen())
+    return false;
+
+  // Run failure query
+  QSqlQuery query(db);
+  if (!query.exec("SELECT ObjectID, mtbf_s, mttr_s FROM failure_rates"))
+    {
+      qDebug() << "SELECT failure rates failed, objects run without failures" << query.lastError().text();
+      return false;
+    }
+
+  // Reading records and init the model
+  QSqlRecord rec = query.record();
+  while (query.next())
+  {
+    FailureModel *itemModel = new FailureModel();
+    itemModel->idObject = query.value(rec.indexOf("ObjectID")).toString();
+    itemModel->mtbf = query.value(rec.indexOf("mtbf_s")).toLongLong() * 1000;
+    itemModel->mttr = query.value(rec.indexOf("mttr_s")).toLongLong() * 1000;
+
+    if (timeCoeff > 0)
+    {
+      itemModel->mtbf /= timeCoeff;
+      itemModel->mttr /= timeCoeff;
+    }
+
+    list.append(itemModel);
+  }
+  return true;
+}
+//_________________________________________________________
+//
 // Fill up config model from database
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 bool InventoryDatabase::getConfigView(QSqlDatabase &db, ConfigModel &config)
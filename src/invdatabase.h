@@ -15,6 +15,9 @@ struct WinderModel
   int timeExchange;       // Exchange bobbins time (ms)
   int timeAlert;          // Winder about ready alert time (ms)
   int width;              // Winder width (mm)
+  QString idRecipe;       // Recipe Id of winder packages, empty if not set
+  int prioDoff;           // Doffing priority, the lower the earlier, 0 if not set
+  int prioSleever;        // Sleeving priority, the lower the earlier, 0 if not set
 
   QString getId() {return idWinder;}
 };
@@ -27,6 +30,7 @@ struct DofferModel
   int timePutDown;        // Putting bobbins time (ms)
   int width;              // Doffer width (mm)
   int acceleration;       // Doffer acceleration (mm/(s*s))
+  int capacity;           // Bobbins amount to carry in one trip, 0 if not set
 
   QString getId() {return idDoffer;}
 };
@@ -70,6 +74,15 @@ struct ManServiceModel
   QString getId() {return idMan;}
 };
 
+struct FailureModel
+{
+  QString idObject;         // Winder, doffer, sleever or man-service Id
+  qint64 mtbf;              // Mean time between failures (ms)
+  qint64 mttr;              // Mean time to repair (ms)
+
+  QString getId() {return idObject;}
+};
+
 struct ConfigModel
 {
   int spaceBetweenWinders;    // Space between winders in group (mm)
@@ -103,14 +116,17 @@ struct SleeverSyncModel
 class InventoryDatabase
 {
 public:
-  static QSqlDatabase open();
+  static QSqlDatabase open(const QString &connectionName = "scirocco");
   static void close(QSqlDatabase &db);
 
   static bool getWindersView(QSqlDatabase &db, QList<WinderModel *> &list, int timeCoeff);
+  static bool getWinderRecipes(QSqlDatabase &db, QList<WinderModel *> &list);
+  static bool getWinderPriorities(QSqlDatabase &db, QList<WinderModel *> &list);
   static bool getDoffersView(QSqlDatabase &db, QList<DofferModel *> &list, int timeCoeff);
   static bool getSleeversView(QSqlDatabase &db, QList<SleeverModel *> &list, int timeCoeff);
   static bool getSpoolersView(QSqlDatabase &db, QList<SpoolerModel *> &list);
   static bool getMenView(QSqlDatabase &db, QList<ManServiceModel *> &list, int timeCoeff);
+  static bool getFailuresView(QSqlDatabase &db, QList<FailureModel *> &list, int timeCoeff);
   static bool getConfigView(QSqlDatabase &db, ConfigModel &config);
 
   static bool updateDoffers(QSqlDatabase &db, QList<DofferSyncModel> &items);
@@ -0,0 +1,192 @@
+#include "kinematics.h"
+#include "locator.h"
+#include "profiler.h"
+#include "simclock.h"
+
+const int stepResolution = 70;      // movement step period (ms)
+const double msPerSec = 1000.0;     // speed and acceleration time units
+//_________________________________________________________
+//
+// Object constructor. The store is empty
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+KinematicsStore::KinematicsStore(QObject *parent /*=0*/) :
+  QObject(parent)
+{
+  m_step_timer = 0;
+}
+//_________________________________________________________
+//
+// Object destructor.
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+KinematicsStore::~KinematicsStore()
+{
+  clear();
+}
+//_________________________________________________________
+//
+// Add the locator slot with its speed and acceleration
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+int KinematicsStore::append(Locator *locator, int speed, int accel)
+{
+  m_locators.append(locator);
+  m_startX.append(0);
+  m_destX.append(0);
+  m_middleX.append(0);
+  m_curSpeed.append(0);
+  m_timeLeft.append(0);
+  m_timeReach.append(0);
+  m_phase.append(NONE);
+  m_speed.append(speed);
+  m_accel.append(accel);
+  m_speedScale.append(speed / msPerSec);
+  m_accelScale.append(accel / msPerSec);
+  m_halfAccel.append(accel / (2 * msPerSec * msPerSec));
+  m_active.append(0);
+  m_stepped.append(0);
+  m_delta.append(0);
+  m_prevDelta.append(0);
+  return m_locators.size() - 1;
+}
+//_________________________________________________________
+//
+// Stop the step timer and drop all slots
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void KinematicsStore::clear()
+{
+  if (m_step_timer > 0)
+  {
+    SimClock::killTimer(m_step_timer);
+    m_step_timer = 0;
+  }
+  m_locators.clear();
+  m_startX.clear();
+  m_destX.clear();
+  m_middleX.clear();
+  m_curSpeed.clear();
+  m_timeLeft.clear();
+  m_timeReach.clear();
+  m_phase.clear();
+  m_speed.clear();
+  m_accel.clear();
+  m_speedScale.clear();
+  m_accelScale.clear();
+  m_halfAccel.clear();
+  m_active.clear();
+  m_stepped.clear();
+  m_delta.clear();
+  m_prevDelta.clear();
+}
+//_________________________________________________________
+//
+// Start the new movement phase of the slot. Its first step is
+// done with the next tick, even if the current tick is not over
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void KinematicsStore::start(int slot)
+{
+  m_active[slot] = 1;
+  m_stepped[slot] = 0;
+  if (m_step_timer == 0)
+  {
+    m_step_timer = SimClock::startTimer(this, stepResolution);
+  }
+}
+//_________________________________________________________
+//
+// Stop the slot movement immediately
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void KinematicsStore::halt(int slot)
+{
+  m_active[slot] = 0;
+  m_stepped[slot] = 0;
+}
+//_________________________________________________________
+//
+// Advance all moving slots by one step. Distances of all phases
+// are counted and the current one is selected by masks, so the
+// loop body has no branches. Per-slot scale factors replace integer
+// divisions, squared times are doubles to keep long phases from
+// overflow. Distances are truncated as the integer division did
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void KinematicsStore::advance()
+{
+  const int count = m_phase.size();
+  const int *destX = m_destX.constData();
+  const int *middleX = m_middleX.constData();
+  int *curSpeed = m_curSpeed.data();
+  int *timeLeft = m_timeLeft.data();
+  const int *timeReach = m_timeReach.constData();
+  const int *phase = m_phase.constData();
+  const double *speedScale = m_speedScale.constData();
+  const double *accelScale = m_accelScale.constData();
+  const double *halfAccel = m_halfAccel.constData();
+  const int *active = m_active.constData();
+  int *stepped = m_stepped.data();
+  int *delta = m_delta.data();
+  int *prevDelta = m_prevDelta.data();
+
+  for(int i = 0; i < count; i++)
+  {
+    int isActive = active[i];
+    int isStarting = phase[i] == STARTING;
+    int isMoving = phase[i] == MOVING;
+    int isBraking = phase[i] == BRAKING;
+
+    // decrease time left until 0
+    int prevLeft = timeLeft[i];
+    int left = qMax(prevLeft - stepResolution, 0);
+    double elapsed = timeReach[i] - left;
+    double prevElapsed = timeReach[i] - prevLeft;
+    int distance = qAbs(destX[i] - middleX[i]);
+
+    // distances from the phase start for every phase
+    int starting = int(elapsed * elapsed * halfAccel[i]);
+    int prevStarting = int(prevElapsed * prevElapsed * halfAccel[i]);
+    int moving = int(elapsed * speedScale[i]);
+    int prevMoving = int(prevElapsed * speedScale[i]);
+    int braking = distance - int(double(left) * left * halfAccel[i]);
+    int prevBraking = distance - int(double(prevLeft) * prevLeft * halfAccel[i]);
+
+    // speed is counted while starting and braking only
+    int startSpeed = int(elapsed * accelScale[i]);
+    int brakeSpeed = qMax(curSpeed[i] - startSpeed, 0);
+    int newSpeed = isStarting * startSpeed + isBraking * brakeSpeed + (1 - isStarting - isBraking) * curSpeed[i];
+
+    delta[i] = isStarting * starting + isMoving * moving + isBraking * braking;
+    prevDelta[i] = isStarting * prevStarting + isMoving * prevMoving + isBraking * prevBraking;
+    curSpeed[i] += isActive * (newSpeed - curSpeed[i]);
+    timeLeft[i] += isActive * (left - prevLeft);
+    stepped[i] = isActive;
+  }
+}
+//_________________________________________________________
+//
+// Step timer handler: advance all moving slots by one step. The
+// simulation clock delivers every tick at its due time, so no step
+// is missed. Locators apply their steps in the slot order, a slot
+// which is restarted or halted by an earlier locator skips the step
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void KinematicsStore::timerEvent(QTimerEvent *te)
+{
+  if (te->timerId() != m_step_timer) return;
+  PROFILE_SCOPE("KinematicsStore::step");
+
+  advance();
+  for(int i = 0; i < m_locators.size(); i++)
+  {
+    if (m_stepped[i])
+    {
+      m_stepped[i] = 0;
+      m_locators[i]->applyStep();
+    }
+  }
+
+  // the timer is started again by the next movement
+  int moving = 0;
+  for(int i = 0; i < m_active.size(); i++)
+    moving |= m_active[i];
+  if (m_step_timer > 0 && moving == 0)
+  {
+    SimClock::killTimer(m_step_timer);
+    m_step_timer = 0;
+  }
+}
@@ -0,0 +1,79 @@
+#ifndef KINEMATICS_H
+#define KINEMATICS_H
+
+#include <QObject>
+#include <QVector>
+
+class Locator;
+//_________________________________________________________
+//
+// Class keeps the track movement state of all locators as parallel
+// arrays, one slot per locator. All moving slots are advanced by one
+// loop without branches on the movement phase, then locators apply
+// their new positions and handle phase ends in the slot order.
+// One step timer of the simulation clock drives all locators while
+// any of them moves.
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+class KinematicsStore : public QObject
+{
+  Q_OBJECT
+public:
+  // Movement phases, the same values as Locator::Movement
+  enum Phase
+  {
+    NONE = 0,   // slot is not moving
+    STARTING,   // slot is speeding up
+    MOVING,     // slot is moving with constant speed
+    BRAKING     // slot is pulling up
+  };
+
+  explicit KinematicsStore(QObject *parent = 0);
+  virtual ~KinematicsStore();
+
+  int append(Locator *locator, int speed, int accel);
+  void clear();
+
+  void start(int slot);
+  void halt(int slot);
+  bool isActive(int slot) {return m_active[slot] != 0;}
+  void advance();
+
+  // slot fields
+  int &startX(int slot) {return m_startX[slot];}
+  int &destX(int slot) {return m_destX[slot];}
+  int &middleX(int slot) {return m_middleX[slot];}
+  int &curSpeed(int slot) {return m_curSpeed[slot];}
+  int &timeLeft(int slot) {return m_timeLeft[slot];}
+  int &timeReach(int slot) {return m_timeReach[slot];}
+  int &phase(int slot) {return m_phase[slot];}
+  int speed(int slot) {return m_speed[slot];}
+  int accel(int slot) {return m_accel[slot];}
+  int delta(int slot) {return m_delta[slot];}
+  int prevDelta(int slot) {return m_prevDelta[slot];}
+
+protected:
+  virtual void timerEvent(QTimerEvent *);
+
+private:
+  QVector<Locator *> m_locators;  // slot owners
+  QVector<int> m_startX;          // movement starting point x position
+  QVector<int> m_destX;           // destination x position
+  QVector<int> m_middleX;         // current phase starting point
+  QVector<int> m_curSpeed;        // current speed
+  QVector<int> m_timeLeft;        // phase time left counter (ms)
+  QVector<int> m_timeReach;       // phase duration (ms)
+  QVector<int> m_phase;           // movement phase
+  QVector<int> m_speed;           // max constant speed
+  QVector<int> m_accel;           // acceleration value
+  QVector<double> m_speedScale;   // distance per ms of the constant speed
+  QVector<double> m_accelScale;   // speed gain per ms of acceleration
+  QVector<double> m_halfAccel;    // half of the acceleration per squared ms
+  QVector<int> m_active;          // 1 if the slot is moving
+  QVector<int> m_stepped;         // 1 if the last advance is valid for the slot
+  QVector<int> m_delta;           // distance from the phase start after the last advance
+  QVector<int> m_prevDelta;       // distance from the phase start before the last advance
+
+  int m_step_timer;               // step timer id
+};
+
+#endif
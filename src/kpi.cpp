@@ -0,0 +1,238 @@
+#include "kpi.h"
+
+// window geometry: bucket width (ms) and bucket count
+const qint64 windowBucketWidth[KpiEngine::WINDOW_COUNT] = {10000, 60000, 300000};
+const int windowBucketCount[KpiEngine::WINDOW_COUNT] = {30, 60, 96};
+//_________________________________________________________
+//
+// Object constructor. All buckets are empty
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+RollingWindow::RollingWindow(qint64 bucketWidth, int bucketCount) :
+  m_buckets(bucketCount, 0)
+{
+  m_bucketWidth = bucketWidth;
+  reset(0);
+}
+//_________________________________________________________
+//
+// Clean up all buckets and set the window start
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void RollingWindow::reset(qint64 origin)
+{
+  m_buckets.fill(0);
+  m_head = origin / m_bucketWidth;
+  m_origin = origin;
+  m_sum = 0;
+}
+//_________________________________________________________
+//
+// Move the window head to the time and drop expired buckets
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void RollingWindow::advance(qint64 time)
+{
+  qint64 bucket = time / m_bucketWidth;
+  if (bucket <= m_head) return;
+
+  int count = m_buckets.size();
+  if (bucket - m_head >= count)
+  {
+    // the whole window is expired
+    m_buckets.fill(0);
+    m_sum = 0;
+  }
+  else
+  {
+    for(qint64 i = m_head + 1; i <= bucket; i++)
+    {
+      int index = i % count;
+      m_sum -= m_buckets[index];
+      m_buckets[index] = 0;
+    }
+  }
+  m_head = bucket;
+}
+//_________________________________________________________
+//
+// Add the value at the time. Values older than the window are lost
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void RollingWindow::add(qint64 time, qint64 value)
+{
+  advance(time);
+  qint64 bucket = time / m_bucketWidth;
+  if (bucket <= m_head - m_buckets.size()) return;
+  m_buckets[bucket % m_buckets.size()] += value;
+  m_sum += value;
+}
+//_________________________________________________________
+//
+// Add the level integrated over the time span. The span is split
+// on bucket boundaries, only the part inside the window is added
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void RollingWindow::addSpan(qint64 from, qint64 to, qint64 level)
+{
+  if (level == 0 || to <= from) return;
+  advance(to);
+
+  qint64 windowStart = (m_head - m_buckets.size() + 1) * m_bucketWidth;
+  qint64 time = from > windowStart ? from : windowStart;
+  while (time < to)
+  {
+    qint64 bucketEnd = (time / m_bucketWidth + 1) * m_bucketWidth;
+    qint64 end = bucketEnd < to ? bucketEnd : to;
+    add(time, level * (end - time));
+    time = end;
+  }
+}
+//_________________________________________________________
+//
+// Return the sum of the window at the time
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+qint64 RollingWindow::sum(qint64 now)
+{
+  advance(now);
+  return m_sum;
+}
+//_________________________________________________________
+//
+// Return the time span covered by the window at the time.
+// It is shorter than the window right after the reset
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+qint64 RollingWindow::span(qint64 now)
+{
+  advance(now);
+  qint64 start = (m_head - m_buckets.size() + 1) * m_bucketWidth;
+  return now - (start > m_origin ? start : m_origin);
+}
+//==========================================================
+//_________________________________________________________
+//
+// Object constructor. Create windows for all metrics
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+KpiEngine::KpiEngine()
+{
+  for(int m = 0; m < METRIC_COUNT; m++)
+    for(int w = 0; w < WINDOW_COUNT; w++)
+      m_windows[m][w] = new RollingWindow(windowBucketWidth[w], windowBucketCount[w]);
+  reset(0, 0, 0, 0);
+}
+//_________________________________________________________
+//
+// Object destructor.
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+KpiEngine::~KpiEngine()
+{
+  for(int m = 0; m < METRIC_COUNT; m++)
+    for(int w = 0; w < WINDOW_COUNT; w++)
+      delete m_windows[m][w];
+}
+//_________________________________________________________
+//
+// Reset all metrics and set plant objects amount
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void KpiEngine::reset(qint64 now, int winders, int doffers, int sleevers)
+{
+  for(int m = 0; m < METRIC_COUNT; m++)
+  {
+    for(int w = 0; w < WINDOW_COUNT; w++)
+      m_windows[m][w]->reset(now);
+    m_level[m] = 0;
+    m_levelTime[m] = now;
+  }
+  m_winders = winders;
+  m_doffers = doffers;
+  m_sleevers = sleevers;
+}
+//_________________________________________________________
+//
+// Change the gauge level. The previous level is integrated first
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void KpiEngine::changeLevel(Metric metric, qint64 now, int delta)
+{
+  integrate(metric, now);
+  m_level[metric] += delta;
+  if (m_level[metric] < 0)
+    m_level[metric] = 0;
+}
+//_________________________________________________________
+//
+// Add the amount to the counter
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void KpiEngine::count(Metric metric, qint64 now, int amount /*= 1*/)
+{
+  for(int w = 0; w < WINDOW_COUNT; w++)
+    m_windows[metric][w]->add(now, amount);
+}
+//_________________________________________________________
+//
+// Integrate the gauge level from the last change until now
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void KpiEngine::integrate(Metric metric, qint64 now)
+{
+  if (now <= m_levelTime[metric]) return;
+  for(int w = 0; w < WINDOW_COUNT; w++)
+    m_windows[metric][w]->addSpan(m_levelTime[metric], now, m_level[metric]);
+  m_levelTime[metric] = now;
+}
+//_________________________________________________________
+//
+// Return the metric average over the window (per ms)
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+double KpiEngine::average(Metric metric, Window window, qint64 now)
+{
+  qint64 span = m_windows[metric][window]->span(now);
+  if (span <= 0) return 0.0;
+  return (double)m_windows[metric][window]->sum(now) / span;
+}
+//_________________________________________________________
+//
+// Calculate KPI values for all windows
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void KpiEngine::values(qint64 now, QList<KpiValue> &list)
+{
+  list.clear();
+  for(int m = 0; m < METRIC_COUNT; m++)
+    integrate((Metric)m, now);
+
+  KpiValue kpi;
+  for(int m = 0; m < METRIC_COUNT; m++)
+  {
+    double scale = 1.0;
+    switch(m)
+    {
+      case WINDER_WAIT:
+        kpi.name = "Winder wait for doffer";
+        kpi.unit = "%";
+        scale = m_winders > 0 ? 100.0 / m_winders : 0.0;
+        break;
+      case DOFFER_BUSY:
+        kpi.name = "Doffer utilisation";
+        kpi.unit = "%";
+        scale = m_doffers > 0 ? 100.0 / m_doffers : 0.0;
+        break;
+      case SLEEVER_BUSY:
+        kpi.name = "Sleever utilisation";
+        kpi.unit = "%";
+        scale = m_sleevers > 0 ? 100.0 / m_sleevers : 0.0;
+        break;
+      case MAN_QUEUE:
+        kpi.name = "Man-service queue depth";
+        kpi.unit = "tasks";
+        break;
+      case BOBBINS_DOFFED:
+        kpi.name = "Bobbins doffed";
+        kpi.unit = "per hour";
+        scale = 3600000.0;
+        break;
+      case BOBBINS_PLACED:
+        kpi.name = "Spooler fill rate";
+        kpi.unit = "bobbins per hour";
+        scale = 3600000.0;
+        break;
+      default:
+        break;
+    }
+    for(int w = 0; w < WINDOW_COUNT; w++)
+      kpi.value[w] = average((Metric)m, (Window)w, now) * scale;
+    list.append(kpi);
+  }
+}
@@ -0,0 +1,92 @@
+#ifndef KPI_H
+#define KPI_H
+
+#include <QString>
+#include <QList>
+#include <QVector>
+//_________________________________________________________
+//
+// Class represents the sliding time window as a ring buffer of
+// fixed width buckets. Old buckets are dropped while the window
+// moves, so every update is O(1) except long spans which are
+// limited by the bucket count.
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+class RollingWindow
+{
+public:
+  RollingWindow(qint64 bucketWidth, int bucketCount);
+
+  void add(qint64 time, qint64 value);
+  void addSpan(qint64 from, qint64 to, qint64 level);
+  qint64 sum(qint64 now);
+  qint64 span(qint64 now);
+  void reset(qint64 origin);
+
+private:
+  void advance(qint64 time);
+
+  QVector<qint64> m_buckets;    // bucket values
+  qint64 m_bucketWidth;         // bucket width (ms)
+  qint64 m_head;                // number of the newest bucket
+  qint64 m_origin;              // time of the window reset (ms)
+  qint64 m_sum;                 // sum of all buckets
+};
+// KPI values for all windows
+struct KpiValue
+{
+  QString name;               // KPI name
+  QString unit;               // Value units
+  double value[3];            // Values for 5 min, 1 hour and shift windows
+
+  QString getId() {return name;}
+};
+//_________________________________________________________
+//
+// Class calculates rolling window KPIs from supervisor events.
+// Gauges (amount of busy objects, queue depth) are integrated
+// over time, counters are summed up.
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+class KpiEngine
+{
+public:
+  // Available metrics
+  enum Metric
+  {
+    WINDER_WAIT = 0,    // Gauge: winders with ready bobbins waiting for the doffer
+    DOFFER_BUSY,        // Gauge: doffers which are not idle
+    SLEEVER_BUSY,       // Gauge: sleevers which are not idle
+    MAN_QUEUE,          // Gauge: man-service tasks waiting for the man
+    BOBBINS_DOFFED,     // Counter: bobbins taken from winders
+    BOBBINS_PLACED,     // Counter: bobbins put to spoolers
+    METRIC_COUNT
+  };
+  // Available windows
+  enum Window
+  {
+    LAST_5MIN = 0,      // last 5 minutes
+    LAST_HOUR,          // last hour
+    SHIFT,              // last 8 hours shift
+    WINDOW_COUNT
+  };
+
+  KpiEngine();
+  virtual ~KpiEngine();
+
+  void reset(qint64 now, int winders, int doffers, int sleevers);
+  void changeLevel(Metric metric, qint64 now, int delta);
+  void count(Metric metric, qint64 now, int amount = 1);
+  void values(qint64 now, QList<KpiValue> &list);
+
+private:
+  void integrate(Metric metric, qint64 now);
+  double average(Metric metric, Window window, qint64 now);
+
+  RollingWindow *m_windows[METRIC_COUNT][WINDOW_COUNT];   // metric windows
+  int m_level[METRIC_COUNT];                              // current gauge level
+  qint64 m_levelTime[METRIC_COUNT];                       // time of the last gauge integration (ms)
+  int m_winders;                                          // amount of winders
+  int m_doffers;                                          // amount of doffers
+  int m_sleevers;                                         // amount of sleevers
+};
+
+#endif
@@ -1,28 +1,28 @@
 #include "supervisor.h"
 #include "winder.h"
 #include "locator.h"
+#include "profiler.h"
+#include "tracer.h"
 
-const int timerResolution = 70;     // default tick latency for moving timers
+const char *const movementNames[] = {"", "STARTING", "MOVING", "BRAKING"};   // movement phase names for the trace
 //_________________________________________________________
 //
-// Object constructor. Set common styles and resize the control
+// Object constructor. Set initial values
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-Locator::Locator(QWidget *parent /*=0*/) :
-  QFrame(parent)
+Locator::Locator(QObject *parent /*=0*/) :
+  PlantItem(parent)
 {
-  setLineWidth(1);
-  setFrameStyle(NoFrame | Plain);
-  setSizePolicy(QSizePolicy::Fixed, QSizePolicy::Fixed);
-
   // initial values
   extraWidth = 0;
+  m_kind = OTHER;
 
   m_timeLeft = 0;
-  m_movement_timer = 0;
-  m_movingStatus = NONE;
-  m_middleX = 0;
-  m_curSpeed = 0;
+  m_timeReach = 0;
+  m_destY = 0;
+  m_kinematics = NULL;
+  m_slot = -1;
   m_emitReachEvent = true;
+  m_observer = NULL;
 }
 //_________________________________________________________
 
@@ -31,79 +31,65 @@ Locator::~Locator()
 }
 //_________________________________________________________
 //
-// Event handler for timer counters
+// Register the locator in the track movement store. Speed and
+// acceleration should be set before
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Locator::setKinematics(KinematicsStore *kinematics)
+{
+  m_kinematics = kinematics;
+  m_slot = kinematics->append(this, m_speed, m_accel);
+}
+//_________________________________________________________
+//
+// Apply the movement step advanced by the store: move to the new
+// position and switch the movement phase when the current one is over
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-void Locator::timerEvent(QTimerEvent* te)
+void Locator::applyStep()
 {
-  // count params for movement process to move the widget to new pos
-  int delta = 0;
-  int prevDelta = 0;
-  if (te->timerId() == m_movement_timer)
+  KinematicsStore &k = *m_kinematics;
+  int delta = k.delta(m_slot);
+  int prevDelta = k.prevDelta(m_slot);
+  int startX = k.startX(m_slot);
+  int destX = k.destX(m_slot);
+
+  // delta - new distance from middleX
+  QPoint newPos(destX > startX ? k.middleX(m_slot) + delta : k.middleX(m_slot) - delta, y());
+  // moving widget
+  moveTo(newPos.x(), newPos.y());
+  // notify supervisor
+  if (delta != prevDelta && m_emitReachEvent && m_observer != NULL)
+    m_observer->locatorMoved(this, destX >= startX ? (delta - prevDelta) : (prevDelta - delta));
+  // if the phase is over and the observer has not restarted the movement
+  if (k.timeLeft(m_slot) == 0 && k.isActive(m_slot))
   {
-    int prevTimeLeft = m_timeLeft;
-    // decreasing time left until 0
-    m_timeLeft = m_timeLeft <= timerResolution ? 0 : (m_timeLeft - timerResolution);
-    // count distance according to the current moving state
-    switch(m_movingStatus)
+    // halt and switch machine onto the next movement phase
+    k.halt(m_slot);
+    switch(k.phase(m_slot))
     {
       case STARTING:
-        delta = ((m_timeReach - m_timeLeft) * (m_timeReach - m_timeLeft) * m_accel / 1000000) >> 1;
-        prevDelta = ((m_timeReach - prevTimeLeft) * (m_timeReach - prevTimeLeft) * m_accel / 1000000) >> 1;
-        m_curSpeed = m_accel * (m_timeReach - m_timeLeft) / 1000;
+        k.phase(m_slot) = MOVING;
+        startMoving();
         break;
       case MOVING:
-        delta = (m_timeReach - m_timeLeft) * m_speed / 1000;
-        prevDelta = (m_timeReach - prevTimeLeft) * m_speed / 1000;
+        k.phase(m_slot) = BRAKING;
+        startMoving();
         break;
       case BRAKING:
-        delta = abs(m_destX - m_middleX) - ((m_timeLeft * m_timeLeft * m_accel / 1000000) >> 1);
-        prevDelta = abs(m_destX - m_middleX) - ((prevTimeLeft * prevTimeLeft * m_accel / 1000000) >> 1);
-        m_curSpeed -= m_accel * (m_timeReach - m_timeLeft) / 1000;
-        if (m_curSpeed < 0) m_curSpeed = 0;
+        // after the braking phase the goal has been reached
+        k.phase(m_slot) = NONE;
+        TraceRecorder::setMotion(m_id, movementNames[NONE]);
+        //update logger object
+        updateLoggerItem(m_id, Logger::TIME_MOVE);
+        // notify supervisor if necessary
+        if (m_emitReachEvent)
+          emit goalReached(m_session);
         break;
       case NONE:
+        k.curSpeed(m_slot) = 0;
+        break;
       default:
         break;
     }
-    // delta - new distance from middleX
-    QPoint newPos(m_destX > m_startX ? m_middleX + delta : m_middleX - delta, y());
-    // moving widget
-    move(newPos);
-    // notify supervisor
-    if (delta != prevDelta && m_emitReachEvent)
-      emit movement(m_id, newPos, m_destX >= m_startX ? (delta - prevDelta) : (prevDelta - delta));
-    //if timer expired
-    if (m_timeLeft == 0)
-    {
-      //kill timer and switch machine onto the next movement phase
-      killTimer(m_movement_timer);
-      m_movement_timer = 0;
-      switch(m_movingStatus)
-      {
-        case STARTING:
-          m_movingStatus = MOVING;
-          startMoving();
-          break;
-        case MOVING:
-          m_movingStatus = BRAKING;
-          startMoving();
-          break;
-        case BRAKING:
-          // after the braking phase the goal has been reached
-          m_movingStatus = NONE;
-          //update logger object
-          updateLoggerItem(m_id, Logger::TIME_MOVE);
-          // notify supervisor if necessary
-          if (m_emitReachEvent)
-            emit goalReached(m_session);
-          break;
-        case NONE:
-          m_curSpeed = 0;
-          break;
-        default:
-          break;
-      }
-    }
   }
 }
 //_________________________________________________________
@@ -115,25 +101,64 @@ void Locator::stopMoving(bool doEmit /*= true*/)
 {
   // if locator is not moving or pulling up then quit
   m_emitReachEvent = doEmit;
-  if (m_movement_timer == 0 || m_movingStatus == BRAKING) return;
-  // kill movement timer
-  killTimer(m_movement_timer);
-  m_movement_timer = 0;
+  if (!isMoving() || getMovingState() == BRAKING) return;
+  KinematicsStore &k = *m_kinematics;
 
   // count brake distance
   int brakeDelta = getBrakeDistance();
-  m_destX = m_destX > m_startX ? x() + brakeDelta : x() - brakeDelta;
+  k.destX(m_slot) = k.destX(m_slot) > k.startX(m_slot) ? x() + brakeDelta : x() - brakeDelta;
 
   // set widget x-pos as the starting point
-  m_startX = x();
-  m_middleX = x();
+  k.startX(m_slot) = x();
+  k.middleX(m_slot) = x();
 
-  // run new timer for braking phase using calculated brake distance
-  m_movingStatus = BRAKING;
-  m_timeLeft = round(1000 * sqrt((brakeDelta << 1) / (float)m_accel));
-  m_timeReach = m_timeLeft;
+  // run braking phase using calculated brake distance
+  k.phase(m_slot) = BRAKING;
+  k.timeLeft(m_slot) = round(1000 * sqrt((brakeDelta << 1) / (float)m_accel));
+  k.timeReach(m_slot) = k.timeLeft(m_slot);
   m_emitReachEvent = doEmit;
-  m_movement_timer = startTimer(timerResolution);
+  k.start(m_slot);
+  TraceRecorder::setMotion(m_id, movementNames[BRAKING]);
+}
+//_________________________________________________________
+//
+// Stop the track movement immediately, i.e. for subclass operations
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Locator::haltMovement()
+{
+  if (m_kinematics != NULL)
+    m_kinematics->halt(m_slot);
+}
+//_________________________________________________________
+//
+// Start the animation overlay at the position
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Locator::showAnimator(Animator::Type type, int x, int y)
+{
+  hideAnimator();
+  m_anim.start(type, QRect(QPoint(x, y), m_bobbinsSize));
+  refresh(m_anim.getRect());
+}
+//_________________________________________________________
+//
+// Move the animation overlay and invalidate both areas
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Locator::moveAnimator(int x, int y)
+{
+  if (!m_anim.isActive()) return;
+  refresh(m_anim.getRect());
+  m_anim.moveTo(x, y);
+  refresh(m_anim.getRect());
+}
+//_________________________________________________________
+//
+// Stop the animation overlay
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Locator::hideAnimator()
+{
+  if (!m_anim.isActive()) return;
+  refresh(m_anim.getRect());
+  m_anim.stop();
 }
 //_________________________________________________________
 //
@@ -143,7 +168,32 @@ int Locator::getBrakeDistance()
 {
   // check if the object is moving
   if (m_accel == 0 || !isMoving()) return 0;
-  return m_curSpeed * m_curSpeed / (m_accel << 1);
+  int curSpeed = m_kinematics->curSpeed(m_slot);
+  return curSpeed * curSpeed / (m_accel << 1);
+}
+//_________________________________________________________
+//
+// Estimate the time (ms) to reach x-pos from the standstill. Phases
+// are the same as in the movement: starting, constant speed, braking
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+int Locator::getTravelTime(int destX)
+{
+  return getTravelTime(x(), destX);
+}
+//_________________________________________________________
+//
+// Estimate the time (ms) of the trip between two x-positions
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+int Locator::getTravelTime(int fromX, int destX)
+{
+  if (m_speed == 0) return 0;
+  int distance = abs(destX - fromX);
+  if (m_accel == 0)
+    return 1000 * (qint64)distance / m_speed;
+  // there is no constant speed phase on short distances
+  if (distance <= (extraWidth << 1))
+    return round(2000 * sqrt(distance / (double)m_accel));
+  return round(2000 * sqrt((extraWidth << 1) / (double)m_accel)) + 1000 * (qint64)(distance - (extraWidth << 1)) / m_speed;
 }
 //_________________________________________________________
 //
@@ -151,37 +201,40 @@ int Locator::getBrakeDistance()
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void Locator::startMoving()
 {
+  KinematicsStore &k = *m_kinematics;
   // set current x-pos as the phase starting position
-  m_middleX = x();
+  k.middleX(m_slot) = x();
   // count the whole distance to move
-  int distance = abs(m_destX - m_startX);
+  int distance = abs(k.destX(m_slot) - k.startX(m_slot));
+  int &timeLeft = k.timeLeft(m_slot);
 
   // calculate necessary distance and time left
-  switch(m_movingStatus)
+  switch(k.phase(m_slot))
   {
     case STARTING:  // state for the movement beginning
       distance = (distance > (extraWidth << 1)) ? extraWidth : (distance >> 1);
-      m_timeLeft = round(1000 * sqrt((distance << 1) / (float)m_accel));
+      timeLeft = round(1000 * sqrt((distance << 1) / (float)m_accel));
       break;
     case MOVING: // state for the constant speed movement
       distance = (distance > (extraWidth << 1)) ? (distance - (extraWidth << 1)) : 0;
-      m_timeLeft = 1000 * distance / m_speed;
-      if (m_timeLeft > 0)
+      timeLeft = 1000 * distance / m_speed;
+      if (timeLeft > 0)
         break;
       // if constant speed moving phase is absent switch onto the braking phase
-      m_movingStatus = BRAKING;
-      distance = abs(m_destX - m_startX);
+      k.phase(m_slot) = BRAKING;
+      distance = abs(k.destX(m_slot) - k.startX(m_slot));
     case BRAKING: // state for the movement completion
       distance = (distance > (extraWidth << 1)) ? extraWidth : (distance >> 1);
-      m_timeLeft = round(1000 * sqrt((distance << 1) / (float)m_accel));
+      timeLeft = round(1000 * sqrt((distance << 1) / (float)m_accel));
       break;
     case NONE:
     default:
       break;
   }
-  // wind the specific movement timer
-  m_timeReach = m_timeLeft;
-  m_movement_timer = startTimer(timerResolution);
+  // start the phase in the store
+  k.timeReach(m_slot) = timeLeft;
+  k.start(m_slot);
+  TraceRecorder::setMotion(m_id, movementNames[k.phase(m_slot)]);
 }
 //_________________________________________________________
 //
@@ -189,11 +242,12 @@ void Locator::startMoving()
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void Locator::reachObject(QString idSession, int x, int y, bool doEmit /* = true*/)
 {
-  // Check if the speed exists
-  if (m_speed == 0) return;
+  // Check if the speed and the movement store exist
+  if (m_speed == 0 || m_kinematics == NULL) return;
+  KinematicsStore &k = *m_kinematics;
 
   // Check if we're already moving to this destination
-  if (isMoving() && x == m_destX)
+  if (isMoving() && x == k.destX(m_slot))
   {
     // assign session and emit event flag
     setDestPos(x, y);
@@ -207,7 +261,7 @@ void Locator::reachObject(QString idSession, int x, int y, bool doEmit /* = true
   {
     // just set params and inform supervisor if necessary
     setDestPos(x, y);
-    m_curSpeed = 0;
+    k.curSpeed(m_slot) = 0;
     m_session = idSession;
     m_emitReachEvent = doEmit;
     if (doEmit)
@@ -221,14 +275,14 @@ void Locator::reachObject(QString idSession, int x, int y, bool doEmit /* = true
   // update idle counter for the object
   updateLoggerItem(m_id, Logger::TIME_IDLE);
   // set widget x-pos as the starting point
-  m_startX = pos().x();
-  m_curSpeed = 0;
+  k.startX(m_slot) = pos().x();
+  k.curSpeed(m_slot) = 0;
   // init supervisor task session
   m_session = idSession;
   // set destination
   setDestPos(x, y);
   // launch the state machine
-  m_movingStatus = STARTING;
+  k.phase(m_slot) = STARTING;
   m_emitReachEvent = doEmit;
   startMoving();
 }
@@ -238,7 +292,8 @@ void Locator::reachObject(QString idSession, int x, int y, bool doEmit /* = true
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void Locator::setDestPos(int x, int y)
 {
-  m_destX = x;
+  if (m_kinematics != NULL)
+    m_kinematics->destX(m_slot) = x;
   m_destY = y;
 }
 //_________________________________________________________
@@ -1,16 +1,30 @@
 #ifndef LOCATOR_H
 #define LOCATOR_H
 
-#include <QFrame>
 #include <QtGui>
+#include "plantitem.h"
 #include "anim.h"
+#include "kinematics.h"
 #include "logger.h"
+class Locator;
+//_________________________________________________________
+//
+// Interface of the locator movement handler. Movement is the most
+// frequent simulation event, it is dispatched by the direct call
+// without the meta-object system and argument copies
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+class LocatorObserver
+{
+public:
+  virtual ~LocatorObserver() {}
+  virtual void locatorMoved(Locator *locator, int delta) = 0;
+};
 //_________________________________________________________
 //
 // Class represents locator widget which is possible to move
 // and brake with acceleration
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-class Locator : public QFrame
+class Locator : public PlantItem
 {
   Q_OBJECT
 public:
@@ -22,55 +36,70 @@ public:
     MOVING,     // Locator is moving with constant speed
     BRAKING     // Locator is pulling up
   };
-  explicit Locator(QWidget *parent = 0);
+  // Locator kinds, the observer casts the locator by its kind
+  enum Kind
+  {
+    OTHER = 0,  // Locator of the other kind
+    DOFFER,     // Locator is a doffer
+    SLEEVER     // Locator is a sleever
+  };
+  explicit Locator(QObject *parent = 0);
   virtual ~Locator();
 
   QString getId() {return m_id;}
+  Kind getKind() {return m_kind;}
   QString getSession() {return m_session;}
-  bool isMoving() {return m_movement_timer > 0;}
+  bool isMoving() {return m_kinematics != NULL && m_kinematics->isActive(m_slot);}
   int getDistance() {return extraWidth;}
-  int getDestX() {return m_destX;}
+  int getDestX() {return m_kinematics->destX(m_slot);}
   int getDestY() {return m_destY;}
-  int getCurrentSpeed() {return m_curSpeed;}
-  Movement getMovingState() {return m_movingStatus;}
+  int getCurrentSpeed() {return m_kinematics->curSpeed(m_slot);}
+  Movement getMovingState() {return (Movement)m_kinematics->phase(m_slot);}
+  Animator &getAnimator() {return m_anim;}
+  void setObserver(LocatorObserver *observer) {m_observer = observer;}
+  void setKinematics(KinematicsStore *kinematics);
+  void applyStep();
 
   void setDestPos(int x, int y);
   virtual void reachObject(QString idSession, int x, int y, bool doEmit=true);
   void stopMoving(bool doEmit = true);
   void setBobbinsSize(QSize srcSize);
   int getBrakeDistance();
+  int getTravelTime(int destX);
+  int getTravelTime(int fromX, int destX);
 
 signals:
   void goalReached(QString idSession);
-  void movement(QString, QPoint, int);
   void updateLoggerItem(QString idObject, Logger::FieldNames field);
 
 public slots:
 
 protected:
-  virtual void timerEvent(QTimerEvent *);
   void startMoving();
+  void haltMovement();
+  void showAnimator(Animator::Type type, int x, int y);
+  void moveAnimator(int x, int y);
+  void hideAnimator();
 
   int m_speed;          // max constant locator speed
   int m_accel;          // acceleration value
   QString m_id;         // object id
+  Kind m_kind;          // locator kind
 
   QString m_session;    // supervisor task session id
-  int m_timeLeft;       // time left counter
-  int m_timeReach;      // reaching time value
-  int m_startX;         // starting point x position
-  int m_destX;          // destination x position
+  int m_timeLeft;       // time left counter of subclass operations
+  int m_timeReach;      // duration of subclass operations
   int m_destY;          // destination y position
 
   int extraWidth;       // max brake distance value
 
-  int m_movement_timer;       // movement timer id
-  Movement m_movingStatus;    // current movement state
-  int m_middleX;              // current phase starting point (on starting, on movement or on braking)
-  int m_curSpeed;             // current speed
+  KinematicsStore *m_kinematics;  // track movement state store, NULL if not set
+  int m_slot;                     // locator slot in the store
   bool m_emitReachEvent;      // true if necessary to notify supervisor about object moving and arriving
+  LocatorObserver *m_observer;  // movement handler, NULL if not set
 
   QSize m_bobbinsSize;        // counted sizes using for drawing bobbins / sleeve
+  Animator m_anim;            // reusable bobbins / sleeve animation overlay
 };
 
 #endif
@@ -1,11 +1,66 @@
 #include "logger.h"
+
+const int refreshResolution = 250;    // min time latency between table view updates
 //_________________________________________________________
 //
 // Object constructor.
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-LoggerTableView::LoggerTableView(QObject *parent /*=0*/) :
+DirtyTableModel::DirtyTableModel(QObject *parent /*=0*/) :
   QAbstractTableModel(parent)
 {
+  resetDirty();
+}
+//_________________________________________________________
+//
+// Extend the changed rows range with the row
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void DirtyTableModel::markDirty(int row)
+{
+  if (row < 0) return;
+  if (m_dirtyFirst < 0 || row < m_dirtyFirst)
+    m_dirtyFirst = row;
+  if (row > m_dirtyLast)
+    m_dirtyLast = row;
+}
+//_________________________________________________________
+//
+// Mark all rows as changed
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void DirtyTableModel::markAllDirty()
+{
+  int rows = rowCount(QModelIndex());
+  if (rows == 0) return;
+  markDirty(0);
+  markDirty(rows - 1);
+}
+//_________________________________________________________
+//
+// Notify views about the changed rows range
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void DirtyTableModel::flushDirty()
+{
+  if (m_dirtyFirst < 0) return;
+  int columns = columnCount(QModelIndex());
+  emit dataChanged(index(m_dirtyFirst, 0), index(m_dirtyLast, columns - 1));
+  resetDirty();
+}
+//_________________________________________________________
+//
+// Clean up changed rows range
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void DirtyTableModel::resetDirty()
+{
+  m_dirtyFirst = -1;
+  m_dirtyLast = -1;
+}
+//==========================================================
+//_________________________________________________________
+//
+// Object constructor.
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+LoggerTableView::LoggerTableView(QObject *parent /*=0*/) :
+  DirtyTableModel(parent)
+{
 
 }
 //_________________________________________________________
@@ -22,9 +77,42 @@ LoggerTableView::~LoggerTableView()
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void LoggerTableView::clearItems()
 {
+  beginResetModel();
   foreach(LoggerModel *it, m_items)
     if (it != NULL) delete it;
   m_items.clear();
+  m_index.clear();
+  resetDirty();
+  endResetModel();
+}
+//_________________________________________________________
+//
+// Return the item by object id
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+LoggerModel *LoggerTableView::getItem(const QString &idObject)
+{
+  int row = m_index.value(idObject, -1);
+  return row < 0 ? NULL : m_items.at(row);
+}
+//_________________________________________________________
+//
+// Append the item as the last row
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void LoggerTableView::appendItem(LoggerModel *item)
+{
+  int row = m_items.size();
+  beginInsertRows(QModelIndex(), row, row);
+  m_items.append(item);
+  m_index.insert(item->getId(), row);
+  endInsertRows();
+}
+//_________________________________________________________
+//
+// Mark the item row as changed
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void LoggerTableView::itemChanged(const QString &idObject)
+{
+  markDirty(m_index.value(idObject, -1));
 }
 //_________________________________________________________
 
@@ -65,9 +153,9 @@ QVariant LoggerTableView::data(const QModelIndex &index, int role) const
   switch (index.column())
   {
     case 0: return model->getId();
-    case 1: return model->timeIdle;
-    case 2: return model->timeMoving;
-    case 3: return model->timeBusy;
+    case 1: return model->timeIdle / 1000;
+    case 2: return model->timeMoving / 1000;
+    case 3: return model->timeBusy / 1000;
     default: return QVariant();
   };
 }
@@ -91,25 +179,271 @@ QVariant LoggerTableView::headerData(int section, Qt::Orientation orientation, i
 //==========================================================
 //_________________________________________________________
 //
+// Object constructor.
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+LatencyTableView::LatencyTableView(QObject *parent /*=0*/) :
+  DirtyTableModel(parent)
+{
+
+}
+//_________________________________________________________
+//
+// Object destructor.
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+LatencyTableView::~LatencyTableView()
+{
+  clearItems();
+}
+//_________________________________________________________
+//
+// Cleanup the table
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void LatencyTableView::clearItems()
+{
+  beginResetModel();
+  foreach(LatencyModel *it, m_items)
+    if (it != NULL) delete it;
+  m_items.clear();
+  m_index.clear();
+  resetDirty();
+  endResetModel();
+}
+//_________________________________________________________
+//
+// Return the item by task type
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+LatencyModel *LatencyTableView::getItem(const QString &taskType)
+{
+  int row = m_index.value(taskType, -1);
+  return row < 0 ? NULL : m_items.at(row);
+}
+//_________________________________________________________
+//
+// Append the item as the last row
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void LatencyTableView::appendItem(LatencyModel *item)
+{
+  int row = m_items.size();
+  beginInsertRows(QModelIndex(), row, row);
+  m_items.append(item);
+  m_index.insert(item->getId(), row);
+  endInsertRows();
+}
+//_________________________________________________________
+//
+// Mark the item row as changed
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void LatencyTableView::itemChanged(const QString &taskType)
+{
+  markDirty(m_index.value(taskType, -1));
+}
+//_________________________________________________________
+
+int LatencyTableView::rowCount(const QModelIndex &parent) const
+{
+  Q_UNUSED(parent);
+  return m_items.size();
+}
+//_________________________________________________________
+
+int LatencyTableView::columnCount(const QModelIndex &parent) const
+{
+  Q_UNUSED(parent);
+  return 11;
+}
+//_________________________________________________________
+//
+// Return item for the table view. Every histogram takes
+// three columns: p50, p90 and p99 in seconds
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+QVariant LatencyTableView::data(const QModelIndex &index, int role) const
+{
+  if (!index.isValid())
+    return QVariant();
+  if (role == Qt::TextAlignmentRole)
+    return index.column() == 0 ? Qt::AlignLeft : Qt::AlignRight;
+
+  if (role != Qt::DisplayRole)
+    return QVariant();
+
+  const double percentiles[] = {0.5, 0.9, 0.99};
+  LatencyModel *model = m_items.at(index.row());
+  int column = index.column();
+  if (column == 0) return model->getId();
+  if (column == 1) return model->duration.count();
+
+  const Histogram *histogram = NULL;
+  switch ((column - 2) / 3)
+  {
+    case 0: histogram = &model->queueWait; break;
+    case 1: histogram = &model->pauseTime; break;
+    case 2: histogram = &model->duration; break;
+    default: return QVariant();
+  };
+  return QString::number(histogram->percentile(percentiles[(column - 2) % 3]) / 1000.0, 'f', 1);
+}
+//_________________________________________________________
+//
+// Return item header for the table view
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+QVariant LatencyTableView::headerData(int section, Qt::Orientation orientation, int role) const
+{
+  if (orientation != Qt::Horizontal || role != Qt::DisplayRole)
+    return QVariant();
+  switch (section)
+  {
+    case 0: return "Task";
+    case 1: return "Done";
+    case 2: return "Wait p50";
+    case 3: return "Wait p90";
+    case 4: return "Wait p99";
+    case 5: return "Pause p50";
+    case 6: return "Pause p90";
+    case 7: return "Pause p99";
+    case 8: return "Total p50";
+    case 9: return "Total p90";
+    case 10: return "Total p99";
+    default: return QVariant();
+  }
+}
+//==========================================================
+//_________________________________________________________
+//
+// Object constructor.
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+KpiTableView::KpiTableView(QObject *parent /*=0*/) :
+  DirtyTableModel(parent)
+{
+
+}
+//_________________________________________________________
+//
+// Object destructor.
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+KpiTableView::~KpiTableView()
+{
+}
+//_________________________________________________________
+//
+// Replace KPI values. Rows are inserted only once, the following
+// updates mark all rows as changed
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void KpiTableView::setItems(const QList<KpiValue> &items)
+{
+  if (items.size() != m_items.size())
+  {
+    beginResetModel();
+    m_items = items;
+    resetDirty();
+    endResetModel();
+    return;
+  }
+  m_items = items;
+  markAllDirty();
+}
+//_________________________________________________________
+//
+// Cleanup the table
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void KpiTableView::clearItems()
+{
+  beginResetModel();
+  m_items.clear();
+  resetDirty();
+  endResetModel();
+}
+//_________________________________________________________
+
+int KpiTableView::rowCount(const QModelIndex &parent) const
+{
+  Q_UNUSED(parent);
+  return m_items.size();
+}
+//_________________________________________________________
+
+int KpiTableView::columnCount(const QModelIndex &parent) const
+{
+  Q_UNUSED(parent);
+  return 5;
+}
+//_________________________________________________________
+//
+// Return item for the table view
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+QVariant KpiTableView::data(const QModelIndex &index, int role) const
+{
+  if (!index.isValid())
+    return QVariant();
+  if (role == Qt::TextAlignmentRole)
+    return index.column() < 2 ? Qt::AlignLeft : Qt::AlignRight;
+
+  if (role != Qt::DisplayRole)
+    return QVariant();
+
+  const KpiValue &item = m_items.at(index.row());
+  switch (index.column())
+  {
+    case 0: return item.name;
+    case 1: return item.unit;
+    case 2: return QString::number(item.value[KpiEngine::LAST_5MIN], 'f', 1);
+    case 3: return QString::number(item.value[KpiEngine::LAST_HOUR], 'f', 1);
+    case 4: return QString::number(item.value[KpiEngine::SHIFT], 'f', 1);
+    default: return QVariant();
+  };
+}
+//_________________________________________________________
+//
+// Return item header for the table view
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+QVariant KpiTableView::headerData(int section, Qt::Orientation orientation, int role) const
+{
+  if (orientation != Qt::Horizontal || role != Qt::DisplayRole)
+    return QVariant();
+  switch (section)
+  {
+    case 0: return "KPI";
+    case 1: return "Units";
+    case 2: return "5 min";
+    case 3: return "1 hour";
+    case 4: return "Shift";
+    default: return QVariant();
+  }
+}
+//==========================================================
+//_________________________________________________________
+//
 // Object constructor. Set common styles and resize the control
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 Logger::Logger(QWidget *parent /*=0*/): QDialog(parent)
 {
   setWindowTitle("Statistics");
   setMinimumSize(300, 200);
-  resize(500, 325);
+  resize(700, 650);
 
   m_table = new QTableView();
   m_table->setModel(&m_loggerView);
 
+  // task latency percentiles (sec)
+  m_latencyTable = new QTableView();
+  m_latencyTable->setModel(&m_latencyView);
+
+  // rolling window KPIs
+  m_kpiTable = new QTableView();
+  m_kpiTable->setModel(&m_kpiView);
+
   QPushButton* btnReset=new QPushButton("&Reset statistics");
   connect(btnReset, SIGNAL(clicked()), SLOT(resetStatistics()));
 
   QVBoxLayout* pvbxLayout = new QVBoxLayout(this);
   pvbxLayout->addWidget(m_table);
+  pvbxLayout->addWidget(m_latencyTable);
+  pvbxLayout->addWidget(m_kpiTable);
   pvbxLayout->addWidget(btnReset);
 
+  m_refresh_timer = 0;
   m_table->show();
+  m_latencyTable->show();
+  m_kpiTable->show();
 }
 //_________________________________________________________
 //
@@ -118,6 +452,8 @@ Logger::Logger(QWidget *parent /*=0*/): QDialog(parent)
 Logger::~Logger()
 {
   if (m_table != NULL) delete m_table;
+  if (m_latencyTable != NULL) delete m_latencyTable;
+  if (m_kpiTable != NULL) delete m_kpiTable;
 }
 //_________________________________________________________
 //
@@ -125,7 +461,61 @@ Logger::~Logger()
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void Logger::refresh()
 {
-  m_loggerView.layoutChanged();
+  m_loggerView.markAllDirty();
+  m_latencyView.markAllDirty();
+  scheduleRefresh();
+}
+//_________________________________________________________
+//
+// Mark logger item as changed. Views are updated by timer
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Logger::itemChanged(const QString &idObject)
+{
+  m_loggerView.itemChanged(idObject);
+  scheduleRefresh();
+}
+//_________________________________________________________
+//
+// Mark latency item as changed. Views are updated by timer
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Logger::latencyItemChanged(const QString &taskType)
+{
+  m_latencyView.itemChanged(taskType);
+  scheduleRefresh();
+}
+//_________________________________________________________
+//
+// Replace KPI values. Views are updated by timer
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Logger::setKpiItems(const QList<KpiValue> &items)
+{
+  m_kpiView.setItems(items);
+  scheduleRefresh();
+}
+//_________________________________________________________
+//
+// Start refresh timer if it is not started yet, so all changes
+// during the refresh period make one view update
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Logger::scheduleRefresh()
+{
+  if (m_refresh_timer == 0)
+    m_refresh_timer = startTimer(refreshResolution);
+}
+//_________________________________________________________
+//
+// Event handler for timer counters
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Logger::timerEvent(QTimerEvent *te)
+{
+  if (te->timerId() == m_refresh_timer)
+  {
+    killTimer(m_refresh_timer);
+    m_refresh_timer = 0;
+    m_loggerView.flushDirty();
+    m_latencyView.flushDirty();
+    m_kpiView.flushDirty();
+  }
 }
 //_________________________________________________________
 //
@@ -134,11 +524,13 @@ void Logger::refresh()
 void Logger::clear()
 {
   m_loggerView.clearItems();
-  refresh();
+  m_latencyView.clearItems();
+  m_kpiView.clearItems();
 }
 //_________________________________________________________
 //
-// Reset model statistics values
+// Reset model statistics values. Start time is set by the
+// statisticsReset signal receiver
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void Logger::resetStatistics()
 {
@@ -147,13 +539,14 @@ void Logger::resetStatistics()
     it->timeBusy = 0;
     it->timeIdle = 0;
     it->timeMoving = 0;
-    it->startTime = QDateTime::currentDateTime();
   }
+  foreach(LatencyModel *it, getLatencyItems())
+  {
+    it->queueWait.reset();
+    it->pauseTime.reset();
+    it->duration.reset();
+  }
+  emit statisticsReset();
 
   refresh();
 }
-
-
-
-
-
@@ -6,23 +6,58 @@
 #include <QtGui>
 #include <QVBoxLayout>
 #include <QPushButton>
+#include "histogram.h"
+#include "kpi.h"
 
 // Logger item models
 struct LoggerModel
 {
   QString idObject;
-  QDateTime startTime;     // Stating statistics point
+  qint64 startTime;          // Stating statistics point (simulation time, ms)
   qint64 timeIdle;           // Idle duration value (ms)
   qint64 timeMoving;         // Moving duration value(ms)
   qint64 timeBusy;           // Busy duration value (ms)
 
   QString getId() {return idObject;}
 };
+// Task latency models
+struct LatencyModel
+{
+  QString taskType;
+  Histogram queueWait;       // Time from task creation until the first progress (ms)
+  Histogram pauseTime;       // Paused time of the started task (ms)
+  Histogram duration;        // Time from task creation until done (ms)
+
+  QString getId() {return taskType;}
+};
+//_________________________________________________________
+//
+// Class represents the table model which collects changed rows
+// and notifies views with one dataChanged range on flush
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+class DirtyTableModel : public QAbstractTableModel
+{
+  Q_OBJECT
+public:
+
+  explicit DirtyTableModel(QObject *parent = 0);
+
+  void markDirty(int row);
+  void markAllDirty();
+  void flushDirty();
+
+protected:
+  void resetDirty();
+
+private:
+  int m_dirtyFirst;     // first changed row, -1 if nothing is changed
+  int m_dirtyLast;      // last changed row
+};
 //_________________________________________________________
 //
 // Class represents the table view for logger model list
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-class LoggerTableView : public QAbstractTableModel
+class LoggerTableView : public DirtyTableModel
 {
   Q_OBJECT
 public:
@@ -37,6 +72,9 @@ public:
   QVariant headerData(int section, Qt::Orientation orientation, int role) const Q_DECL_OVERRIDE;
 
   QList<LoggerModel *> &getItems() {return m_items;}
+  LoggerModel *getItem(const QString &idObject);
+  void appendItem(LoggerModel *item);
+  void itemChanged(const QString &idObject);
   void clearItems();
 signals:
 
@@ -46,6 +84,59 @@ protected:
 
 private:
   QList<LoggerModel *> m_items;
+  QHash<QString, int> m_index;    // object id -> row
+};
+//_________________________________________________________
+//
+// Class represents the table view for task latency percentiles
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+class LatencyTableView : public DirtyTableModel
+{
+  Q_OBJECT
+public:
+
+  explicit LatencyTableView(QObject *parent = 0);
+  virtual ~LatencyTableView();
+
+  int rowCount(const QModelIndex &parent) const Q_DECL_OVERRIDE;
+  int columnCount(const QModelIndex &parent) const Q_DECL_OVERRIDE;
+
+  QVariant data(const QModelIndex &index, int role) const Q_DECL_OVERRIDE;
+  QVariant headerData(int section, Qt::Orientation orientation, int role) const Q_DECL_OVERRIDE;
+
+  QList<LatencyModel *> &getItems() {return m_items;}
+  LatencyModel *getItem(const QString &taskType);
+  void appendItem(LatencyModel *item);
+  void itemChanged(const QString &taskType);
+  void clearItems();
+
+private:
+  QList<LatencyModel *> m_items;
+  QHash<QString, int> m_index;    // task type -> row
+};
+//_________________________________________________________
+//
+// Class represents the table view for rolling window KPIs
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+class KpiTableView : public DirtyTableModel
+{
+  Q_OBJECT
+public:
+
+  explicit KpiTableView(QObject *parent = 0);
+  virtual ~KpiTableView();
+
+  int rowCount(const QModelIndex &parent) const Q_DECL_OVERRIDE;
+  int columnCount(const QModelIndex &parent) const Q_DECL_OVERRIDE;
+
+  QVariant data(const QModelIndex &index, int role) const Q_DECL_OVERRIDE;
+  QVariant headerData(int section, Qt::Orientation orientation, int role) const Q_DECL_OVERRIDE;
+
+  void setItems(const QList<KpiValue> &items);
+  void clearItems();
+
+private:
+  QList<KpiValue> m_items;
 };
 //_________________________________________________________
 //
@@ -61,23 +152,49 @@ public:
     TIME_MOVE,
     TIME_BUSY
   };
+  enum LatencyFields
+  {
+    QUEUE_WAIT = 0,
+    PAUSE_TIME,
+    DURATION
+  };
 
   explicit Logger(QWidget *parent = 0);
   virtual ~Logger();
 
   QList<LoggerModel *> &getItems() {return m_loggerView.getItems();}
+  LoggerModel *getItem(const QString &idObject) {return m_loggerView.getItem(idObject);}
+  void appendItem(LoggerModel *item) {m_loggerView.appendItem(item);}
+  void itemChanged(const QString &idObject);
+
+  QList<LatencyModel *> &getLatencyItems() {return m_latencyView.getItems();}
+  LatencyModel *getLatencyItem(const QString &taskType) {return m_latencyView.getItem(taskType);}
+  void appendLatencyItem(LatencyModel *item) {m_latencyView.appendItem(item);}
+  void latencyItemChanged(const QString &taskType);
+
+  void setKpiItems(const QList<KpiValue> &items);
+
   void refresh();
   void clear();
 signals:
+  void statisticsReset();
 
 private slots:
   void resetStatistics();
 
 protected:
+  virtual void timerEvent(QTimerEvent *);
 
 private:
+  void scheduleRefresh();
+
   QTableView *m_table;
   LoggerTableView m_loggerView;
+  QTableView *m_latencyTable;
+  LatencyTableView m_latencyView;
+  QTableView *m_kpiTable;
+  KpiTableView m_kpiView;
+  int m_refresh_timer;      // coalesced table refresh timer id
 };
 
 #endif
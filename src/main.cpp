@@ -1,10 +1,90 @@
 #include <QApplication>
+#include <QCommandLineParser>
 
 #include "mainwindow.h"
+#include "headless.h"
+#include "dispatchbench.h"
+#include "manbench.h"
+#include "analyser.h"
 
 int main(int argc, char *argv[])
 {
+    // headless run does not need a display. Hash iteration order is
+    // fixed, so runs with the same seed reproduce
+    for (int i = 1; i < argc; i++)
+        if (qstrcmp(argv[i], "--headless") == 0)
+        {
+            qputenv("QT_QPA_PLATFORM", "offscreen");
+            qSetGlobalQHashSeed(0);
+        }
+
     QApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Scirocco doffing simulator");
+    parser.addHelpOption();
+    QCommandLineOption headlessOption("headless", "Run simulation without main window.");
+    QCommandLineOption durationOption("duration", "Simulation time to run headless (sec).", "seconds", "28800");
+    QCommandLineOption reportOption("report", "Save headless run or trace analysis results as JSON.", "file");
+    QCommandLineOption timeCoefOption("time-coef", "Override the database time coefficient.", "value");
+    QCommandLineOption seedOption("seed", "Random seed of breakdowns, 0 takes it from the clock.", "value", "0");
+    QCommandLineOption captureOption("capture", "Capture headless run frames into the directory.", "dir");
+    QCommandLineOption captureEveryOption("capture-every", "Simulation time between captured frames (sec).", "seconds", "10");
+    QCommandLineOption captureRawOption("capture-raw", "Write captured frames as one raw RGB32 stream instead of PNG files.");
+    QCommandLineOption benchmarkOption("benchmark-dispatch", "Measure movement event dispatch and quit.", "events");
+    QCommandLineOption benchmarkMenOption("benchmark-men", "Measure man route planning with the amount of pending tasks and quit.", "tasks");
+    QCommandLineOption analyseOption("analyse", "Attribute winder idle time of the recorded trace to its causes and quit.", "trace");
+    parser.addOption(headlessOption);
+    parser.addOption(durationOption);
+    parser.addOption(reportOption);
+    parser.addOption(timeCoefOption);
+    parser.addOption(seedOption);
+    parser.addOption(captureOption);
+    parser.addOption(captureEveryOption);
+    parser.addOption(captureRawOption);
+    parser.addOption(benchmarkOption);
+    parser.addOption(benchmarkMenOption);
+    parser.addOption(analyseOption);
+    parser.process(app);
+
+    if (parser.isSet(benchmarkOption))
+    {
+        DispatchBenchmark benchmark;
+        benchmark.run(qMax(1, parser.value(benchmarkOption).toInt()));
+        return 0;
+    }
+
+    if (parser.isSet(benchmarkMenOption))
+    {
+        ManDispatchBenchmark benchmark;
+        benchmark.run(qMax(1, parser.value(benchmarkMenOption).toInt()));
+        return 0;
+    }
+
+    if (parser.isSet(analyseOption))
+    {
+        RunAnalyser analyser;
+        if (!analyser.analyse(parser.value(analyseOption)))
+            return 1;
+        analyser.print();
+        if (parser.isSet(reportOption) && !analyser.save(parser.value(reportOption)))
+            return 1;
+        return 0;
+    }
+
+    if (parser.isSet(headlessOption))
+    {
+        HeadlessRunner runner(parser.value(durationOption).toLongLong() * 1000, parser.value(reportOption));
+        runner.setTimeCoefficient(parser.value(timeCoefOption).toInt());
+        runner.setFailureSeed(parser.value(seedOption).toULongLong());
+        if (parser.isSet(captureOption))
+            runner.setCapture(parser.value(captureOption),
+                              parser.value(captureEveryOption).toDouble() * 1000,
+                              parser.isSet(captureRawOption));
+        runner.start();
+        return app.exec();
+    }
+
     MainWindow window;
     window.showMaximized();
     return app.exec();
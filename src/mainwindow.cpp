@@ -1,6 +1,9 @@
 #include <QtWidgets>
 
 #include "mainwindow.h"
+#include "tracer.h"
+
+const double zoomStep = 1.25;   // zoom factor of one wheel step or zoom action
 //_________________________________________________________
 //
 // Object constructor. Set menus actions and other objects
@@ -12,21 +15,35 @@ MainWindow::MainWindow()
 
   // create logger
   statLog = new Logger(this);
+  connect(statLog, SIGNAL(statisticsReset()), this, SLOT(restartLoggerItems()));
+#ifdef SCIROCCO_PROFILE
+  profPanel = new ProfilerPanel(this);
+#endif
 
-  // create supervisor and set it to the scroll area
-  supervisor = new Supervisor();
-  connect(supervisor, SIGNAL(appendLoggerItem(QString)), this, SLOT(appendLoggerItem(QString)));
-  connect(supervisor, SIGNAL(updateLoggerItem(QString,Logger::FieldNames)), this, SLOT(updateLoggerItem(QString,Logger::FieldNames)));
+  // create plant canvas and set it to the scroll area
+  plantView = new PlantView();
+  connect(plantView, SIGNAL(appendLoggerItem(QString,qint64)), this, SLOT(appendLoggerItem(QString,qint64)));
+  connect(plantView, SIGNAL(updateLoggerItem(QString,Logger::FieldNames,qint64)), this, SLOT(updateLoggerItem(QString,Logger::FieldNames,qint64)));
+  connect(plantView, SIGNAL(updateLatency(QString,Logger::LatencyFields,qint64)), this, SLOT(updateLatencyItem(QString,Logger::LatencyFields,qint64)));
+  connect(plantView, SIGNAL(kpiUpdated(QList<KpiValue>)), this, SLOT(updateKpiItems(QList<KpiValue>)));
+  connect(plantView, SIGNAL(historyChanged()), this, SLOT(updateTimeline()));
 
   scroller = new QScrollArea();
-  scroller->setWidget(supervisor);
+  scroller->setWidget(plantView);
   scroller->setHorizontalScrollBarPolicy(Qt::ScrollBarAsNeeded);
   scroller->setVerticalScrollBarPolicy(Qt::ScrollBarAsNeeded);
 
+  // zoom with ctrl + wheel and pan by dragging the work area
+  isPanning = false;
+  plantView->installEventFilter(this);
+
+  // scrub recorded plant states along the timeline
+  createTimeline();
+
   // show the work area
   setCentralWidget(scroller);
   scroller->show();
-  supervisor->show();
+  plantView->show();
 
   // show window
   statusBar()->showMessage("Ready");
@@ -40,15 +57,27 @@ MainWindow::MainWindow()
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 MainWindow::~MainWindow()
 {
-  if (supervisor != NULL) delete supervisor;
+  if (plantView != NULL) delete plantView;
   if (scroller != NULL) delete scroller;
   if (statLog != NULL) delete statLog;
+#ifdef SCIROCCO_PROFILE
+  if (profPanel != NULL) delete profPanel;
+#endif
 
   if (appMenu != NULL) delete appMenu;
+  if (viewMenu != NULL) delete viewMenu;
   if (newAct != NULL) delete newAct;
   if (stopAct != NULL) delete stopAct;
   if (exitAct != NULL) delete exitAct;
   if (showStatAct != NULL) delete showStatAct;
+  if (traceAct != NULL) delete traceAct;
+  if (zoomInAct != NULL) delete zoomInAct;
+  if (zoomOutAct != NULL) delete zoomOutAct;
+  if (zoomResetAct != NULL) delete zoomResetAct;
+  if (liveAct != NULL) delete liveAct;
+#ifdef SCIROCCO_PROFILE
+  if (showProfAct != NULL) delete showProfAct;
+#endif
 }
 //_________________________________________________________
 //
@@ -56,10 +85,8 @@ MainWindow::~MainWindow()
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void MainWindow::startSession()
 {
-  // init containers and models from database
-  supervisor->start();
-  // start simulation
-  supervisor->startWinders();
+  // init containers and models from database and start simulation
+  plantView->start();
 }
 //_________________________________________________________
 //
@@ -68,7 +95,7 @@ void MainWindow::startSession()
 void MainWindow::stopSession()
 {
   // destroy simulation
-  supervisor->stop();
+  plantView->stop();
   statLog->clear();
 }
 //_________________________________________________________
@@ -91,6 +118,49 @@ void MainWindow::showStatistics()
 }
 //_________________________________________________________
 //
+// Start / Stop trace recording. Recorded trace is saved on stop
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void MainWindow::recordTrace()
+{
+  if (!TraceRecorder::isRecording())
+  {
+    plantView->startTrace();
+    traceAct->setChecked(true);
+    statusBar()->showMessage("Trace recording");
+    return;
+  }
+  plantView->stopTrace();
+  traceAct->setChecked(false);
+
+  QString fileName = QFileDialog::getSaveFileName(this, "Save trace", "scirocco-trace.json", "Trace files (*.json)");
+  if (fileName.isEmpty()) return;
+  if (TraceRecorder::save(fileName))
+    statusBar()->showMessage("Trace saved to " + fileName);
+  else
+    statusBar()->showMessage("Trace saving failed");
+}
+#ifdef SCIROCCO_PROFILE
+//_________________________________________________________
+//
+// Show / Hide profiler window
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void MainWindow::showProfiler()
+{
+  if (profPanel->isHidden())
+  {
+    profPanel->move(x() + width() - profPanel->width(), y() + height() - 350);
+    profPanel->show();
+    showProfAct->setChecked(true);
+  }
+  else
+  {
+    profPanel->hide();
+    showProfAct->setChecked(false);
+  }
+}
+#endif
+//_________________________________________________________
+//
 // Create all menu actions
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void MainWindow::createActions()
@@ -109,6 +179,38 @@ void MainWindow::createActions()
   showStatAct->setCheckable(true);
   connect(showStatAct, SIGNAL(triggered()), this, SLOT(showStatistics()));
 
+  traceAct = new QAction("Record &Trace", this);
+  traceAct->setStatusTip("Record task sessions and motion, save them as trace JSON on stop");
+  traceAct->setCheckable(true);
+  connect(traceAct, SIGNAL(triggered()), this, SLOT(recordTrace()));
+
+  zoomInAct = new QAction("Zoom &In", this);
+  zoomInAct->setShortcuts(QKeySequence::ZoomIn);
+  zoomInAct->setStatusTip("Zoom in the work area");
+  connect(zoomInAct, SIGNAL(triggered()), this, SLOT(zoomIn()));
+
+  zoomOutAct = new QAction("Zoom &Out", this);
+  zoomOutAct->setShortcuts(QKeySequence::ZoomOut);
+  zoomOutAct->setStatusTip("Zoom out the work area, simplified objects are shown at small scale");
+  connect(zoomOutAct, SIGNAL(triggered()), this, SLOT(zoomOut()));
+
+  zoomResetAct = new QAction("&Actual Size", this);
+  zoomResetAct->setShortcut(QKeySequence("Ctrl+0"));
+  zoomResetAct->setStatusTip("Show the work area in actual size");
+  connect(zoomResetAct, SIGNAL(triggered()), this, SLOT(zoomReset()));
+
+  liveAct = new QAction("&Live", this);
+  liveAct->setShortcut(QKeySequence("Ctrl+L"));
+  liveAct->setStatusTip("Leave the timeline and show the live plant");
+  connect(liveAct, SIGNAL(triggered()), this, SLOT(showLive()));
+
+#ifdef SCIROCCO_PROFILE
+  showProfAct = new QAction("&Profiler", this);
+  showProfAct->setStatusTip("Show live profiling counters");
+  showProfAct->setCheckable(true);
+  connect(showProfAct, SIGNAL(triggered()), this, SLOT(showProfiler()));
+#endif
+
   exitAct = new QAction("E&xit", this);
   exitAct->setShortcuts(QKeySequence::Quit);
   exitAct->setStatusTip("Exit the application");
@@ -125,10 +227,76 @@ void MainWindow::createMenus()
   appMenu->addAction(stopAct);
   appMenu->addSeparator();
   appMenu->addAction(showStatAct);
+  appMenu->addAction(traceAct);
+#ifdef SCIROCCO_PROFILE
+  appMenu->addAction(showProfAct);
+#endif
   appMenu->addSeparator();
   appMenu->addAction(exitAct);
 
+  viewMenu = new QMenu("&View");
+  viewMenu->addAction(zoomInAct);
+  viewMenu->addAction(zoomOutAct);
+  viewMenu->addAction(zoomResetAct);
+  viewMenu->addSeparator();
+  viewMenu->addAction(liveAct);
+
   menuBar()->addMenu(appMenu);
+  menuBar()->addMenu(viewMenu);
+}
+//_________________________________________________________
+//
+// Create the timeline tool bar: slider over recorded states,
+// shown state caption and the live button
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void MainWindow::createTimeline()
+{
+  timelineSlider = new QSlider(Qt::Horizontal);
+  timelineSlider->setRange(0, 0);
+  timelineSlider->setStatusTip("Drag to review recorded plant states");
+  connect(timelineSlider, SIGNAL(valueChanged(int)), this, SLOT(scrubTimeline(int)));
+
+  timelineLabel = new QLabel();
+  timelineLabel->setMinimumWidth(320);
+
+  timeline = new QToolBar("Timeline");
+  timeline->addWidget(timelineSlider);
+  timeline->addWidget(timelineLabel);
+  timeline->addAction(liveAct);
+  addToolBar(Qt::BottomToolBarArea, timeline);
+}
+//_________________________________________________________
+//
+// Extend the timeline with new recorded states. The slider
+// follows the newest state while the live plant is shown
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void MainWindow::updateTimeline()
+{
+  int count = plantView->getHistory().size();
+  timelineSlider->blockSignals(true);
+  timelineSlider->setRange(0, count > 0 ? count - 1 : 0);
+  if (!plantView->isReplaying())
+    timelineSlider->setValue(timelineSlider->maximum());
+  timelineSlider->blockSignals(false);
+  timelineLabel->setText(plantView->getHistoryCaption());
+}
+//_________________________________________________________
+//
+// Show the recorded state selected on the timeline
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void MainWindow::scrubTimeline(int index)
+{
+  plantView->showHistory(index);
+  timelineLabel->setText(plantView->getHistoryCaption());
+}
+//_________________________________________________________
+//
+// Return from the timeline to the live plant
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void MainWindow::showLive()
+{
+  plantView->showHistory(-1);
+  updateTimeline();
 }
 //_________________________________________________________
 //
@@ -138,41 +306,135 @@ void MainWindow::resizeEvent(QResizeEvent *ev)
 {
   Q_UNUSED(ev)
   // calculate aspect ratio for converting mm to pixels
-  supervisor->SetWholeWidthPixels(scroller->width());
+  plantView->SetWholeWidthPixels(scroller->width());
 }
 //_________________________________________________________
 //
-// Add new item to the statistics window
+// Work area event filter: ctrl + wheel zooms at the cursor,
+// dragging with the left button pans the work area
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-void MainWindow::appendLoggerItem(QString idObject)
+bool MainWindow::eventFilter(QObject *obj, QEvent *ev)
+{
+  if (obj != plantView)
+    return QMainWindow::eventFilter(obj, ev);
+
+  switch(ev->type())
+  {
+    case QEvent::Wheel:
+      {
+        QWheelEvent *we = (QWheelEvent *)ev;
+        if (!(we->modifiers() & Qt::ControlModifier)) break;
+        double factor = we->angleDelta().y() > 0 ? zoomStep : 1.0 / zoomStep;
+        zoomAt(plantView->getZoom() * factor, we->pos() + plantView->pos());
+        return true;
+      }
+    case QEvent::MouseButtonPress:
+      {
+        QMouseEvent *me = (QMouseEvent *)ev;
+        if (me->button() != Qt::LeftButton) break;
+        isPanning = true;
+        panStart = me->globalPos();
+        plantView->setCursor(Qt::ClosedHandCursor);
+        return true;
+      }
+    case QEvent::MouseMove:
+      {
+        if (!isPanning) break;
+        QMouseEvent *me = (QMouseEvent *)ev;
+        QPoint delta = me->globalPos() - panStart;
+        panStart = me->globalPos();
+        scroller->horizontalScrollBar()->setValue(scroller->horizontalScrollBar()->value() - delta.x());
+        scroller->verticalScrollBar()->setValue(scroller->verticalScrollBar()->value() - delta.y());
+        return true;
+      }
+    case QEvent::MouseButtonRelease:
+      {
+        if (!isPanning) break;
+        isPanning = false;
+        plantView->unsetCursor();
+        return true;
+      }
+    default:
+      break;
+  }
+  return QMainWindow::eventFilter(obj, ev);
+}
+//_________________________________________________________
+//
+// Zoom the work area keeping the layout point under the anchor
+// (viewport coordinates) in place
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void MainWindow::zoomAt(double zoom, QPoint anchor)
+{
+  QScrollBar *hBar = scroller->horizontalScrollBar();
+  QScrollBar *vBar = scroller->verticalScrollBar();
+  double oldZoom = plantView->getZoom();
+  double layoutX = (hBar->value() + anchor.x()) / oldZoom;
+  double layoutY = (vBar->value() + anchor.y()) / oldZoom;
+
+  plantView->setZoom(zoom);
+  double newZoom = plantView->getZoom();
+  hBar->setValue(round(layoutX * newZoom) - anchor.x());
+  vBar->setValue(round(layoutY * newZoom) - anchor.y());
+  statusBar()->showMessage(QString("Zoom %1%").arg(round(newZoom * 100)));
+}
+//_________________________________________________________
+//
+// Zoom in at the work area center
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void MainWindow::zoomIn()
+{
+  zoomAt(plantView->getZoom() * zoomStep, scroller->viewport()->rect().center());
+}
+//_________________________________________________________
+//
+// Zoom out at the work area center
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void MainWindow::zoomOut()
+{
+  zoomAt(plantView->getZoom() / zoomStep, scroller->viewport()->rect().center());
+}
+//_________________________________________________________
+//
+// Reset zoom to the actual size
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void MainWindow::zoomReset()
+{
+  zoomAt(1.0, scroller->viewport()->rect().center());
+}
+//_________________________________________________________
+//
+// Add new item to the statistics window. Time is the simulation
+// time the supervisor has created the object at (ms)
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void MainWindow::appendLoggerItem(QString idObject, qint64 time)
 {
   if (statLog == NULL) return;
 
   // create new logger model
   LoggerModel *pItem = new LoggerModel();
   pItem->idObject = idObject;
-  pItem->startTime = QDateTime::currentDateTime();
+  pItem->startTime = time;
   pItem->timeBusy = 0;
   pItem->timeMoving = 0;
   pItem->timeIdle = 0;
 
   // add to list
-  statLog->getItems().append(pItem);
-  statLog->refresh();
+  statLog->appendItem(pItem);
 }
 //_________________________________________________________
 //
-// Update logger item field
+// Update logger item field. Time is the simulation time of the
+// change (ms), durations do not depend on the signal delivery
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-void MainWindow::updateLoggerItem(QString idObject, Logger::FieldNames field)
+void MainWindow::updateLoggerItem(QString idObject, Logger::FieldNames field, qint64 time)
 {
   if (statLog == NULL) return;
   // get logger table item to update
-  LoggerModel *model = Supervisor::getItemById<LoggerModel>(idObject, statLog->getItems());
+  LoggerModel *model = statLog->getItem(idObject);
   if (model == NULL) return;
-  // count duration
-  int timeCoef = supervisor->getConfigModel().timeCoefficient;
-  qint64 duration = model->startTime.msecsTo(QDateTime::currentDateTime()) * timeCoef / 1000;
+  // count duration in simulation time
+  qint64 duration = time - model->startTime;
   //qDebug() << "update " << idObject << field << duration;
   // update logget model field
   switch(field)
@@ -190,6 +452,57 @@ void MainWindow::updateLoggerItem(QString idObject, Logger::FieldNames field)
       break;
   }
   // set new start time
-  model->startTime = QDateTime::currentDateTime();
-  statLog->refresh();
+  model->startTime = time;
+  statLog->itemChanged(idObject);
+}
+//_________________________________________________________
+//
+// Restart logger items counting after statistics reset
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void MainWindow::restartLoggerItems()
+{
+  qint64 now = plantView->simTime();
+  foreach(LoggerModel *it, statLog->getItems())
+    it->startTime = now;
+}
+//_________________________________________________________
+//
+// Add task latency sample to the statistics window
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void MainWindow::updateLatencyItem(QString taskType, Logger::LatencyFields field, qint64 value)
+{
+  if (statLog == NULL) return;
+  // get latency table item, create it for the first sample
+  LatencyModel *model = statLog->getLatencyItem(taskType);
+  if (model == NULL)
+  {
+    model = new LatencyModel();
+    model->taskType = taskType;
+    statLog->appendLatencyItem(model);
+  }
+  // add sample to the histogram
+  switch(field)
+  {
+    case Logger::QUEUE_WAIT:
+      model->queueWait.add(value);
+      break;
+    case Logger::PAUSE_TIME:
+      model->pauseTime.add(value);
+      break;
+    case Logger::DURATION:
+      model->duration.add(value);
+      break;
+    default:
+      break;
+  }
+  statLog->latencyItemChanged(taskType);
+}
+//_________________________________________________________
+//
+// Update rolling window KPIs in the statistics window
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void MainWindow::updateKpiItems(QList<KpiValue> values)
+{
+  if (statLog == NULL) return;
+  statLog->setKpiItems(values);
 }
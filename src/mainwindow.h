@@ -3,10 +3,13 @@
 
 #include <QMainWindow>
 #include <QScrollArea>
+#include <QSlider>
+#include <QLabel>
 
 #include "logger.h"
 #include "invdatabase.h"
-#include "supervisor.h"
+#include "plantview.h"
+#include "profiler.h"
 
 //_________________________________________________________
 //
@@ -23,31 +26,64 @@ public:
 
 protected:
   void resizeEvent(QResizeEvent *ev);
+  bool eventFilter(QObject *obj, QEvent *ev);
 
 public slots:
-  void appendLoggerItem(QString idObject);
-  void updateLoggerItem(QString idObject, Logger::FieldNames field);
+  void appendLoggerItem(QString idObject, qint64 time);
+  void updateLoggerItem(QString idObject, Logger::FieldNames field, qint64 time);
+  void updateLatencyItem(QString taskType, Logger::LatencyFields field, qint64 value);
+  void updateKpiItems(QList<KpiValue> values);
 
 private slots:
   void startSession();
   void stopSession();
   void showStatistics();
+  void restartLoggerItems();
+  void recordTrace();
+  void zoomIn();
+  void zoomOut();
+  void zoomReset();
+  void updateTimeline();
+  void scrubTimeline(int index);
+  void showLive();
+#ifdef SCIROCCO_PROFILE
+  void showProfiler();
+#endif
 
 private:
   void createActions();
   void createMenus();
+  void createTimeline();
+  void zoomAt(double zoom, QPoint anchor);
 
   QMenu *appMenu;         //app menu reference
+  QMenu *viewMenu;        //view menu reference
 
   // menu action widgets
   QAction *newAct;
   QAction *stopAct;
   QAction *exitAct;
   QAction *showStatAct;
+  QAction *traceAct;
+  QAction *zoomInAct;
+  QAction *zoomOutAct;
+  QAction *zoomResetAct;
+  QAction *liveAct;
+#ifdef SCIROCCO_PROFILE
+  QAction *showProfAct;
+#endif
 
   QScrollArea *scroller;    //scrolling widget as workarea
-  Supervisor *supervisor;   // supervisor reference
+  bool isPanning;           // true while the work area is dragged
+  QPoint panStart;          // last mouse position of the drag (global)
+  QToolBar *timeline;       // timeline tool bar
+  QSlider *timelineSlider;  // recorded plant state selector
+  QLabel *timelineLabel;    // shown state time and task summary
+  PlantView *plantView;     // plant canvas, the simulation runs on its own thread
   Logger *statLog;
+#ifdef SCIROCCO_PROFILE
+  ProfilerPanel *profPanel;  // live counters window
+#endif
 };
 
 #endif
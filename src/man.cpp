@@ -1,18 +1,18 @@
 #include "supervisor.h"
 #include "man.h"
+#include "profiler.h"
+#include "tracer.h"
+#include "simclock.h"
 
 const int timerResolution = 70;   // default tick latency for timers
+const char *const statusNames[] = {"IDLE", "READY", "BUSY"};   // status names for the trace
 //_________________________________________________________
 //
-// Object constructor. Set parameters from model, common styles and sizes
+// Object constructor. Set parameters and sizes from model
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-ManService::ManService(ManServiceModel &model, QWidget *parent /*=0*/) :
-  QFrame(parent)
+ManService::ManService(ManServiceModel &model, QObject *parent /*=0*/) :
+  PlantItem(parent)
 {
-  setLineWidth(1);
-  setFrameStyle(NoFrame | Plain);
-  setSizePolicy(QSizePolicy::Fixed, QSizePolicy::Fixed);
-
   // assume man sizes as 1000 mm x 300 mm
   Supervisor *supervisor = (Supervisor *)parent;
   int controlWidth = supervisor->toPixels(1000);
@@ -31,6 +31,7 @@ ManService::ManService(ManServiceModel &model, QWidget *parent /*=0*/) :
   // set idle state
   m_status = IDLE;
   m_timeLeft = 0;
+  m_busyStart = 0;
   m_timeReach = 0;
 
   // init timer ids
@@ -51,15 +52,12 @@ ManService::~ManService()
 //
 // Draw the control content according to its state
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-void ManService::paintEvent(QPaintEvent *pe)
+void ManService::draw(QPainter &painter)
 {
-  Q_UNUSED(pe)
+  PROFILE_SCOPE("ManService::draw");
 
-  QPainter painter;
   QRect rct = rect();
 
-  // open drawing context
-  painter.begin(this);
   painter.setPen(QPen(Qt::white, 1, Qt::SolidLine));
 
   // draw background according to the state
@@ -79,9 +77,31 @@ void ManService::paintEvent(QPaintEvent *pe)
 
   // draw caption
   painter.drawText(rct.left() + 5, 15, m_id);
-
-  // close drawing context
-  painter.end();
+}
+//_________________________________________________________
+//
+// Append the compact state: position and status
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void ManService::saveState(QVector<qint32> &state)
+{
+  PlantItem::saveState(state);
+  state.append(m_status);
+}
+//_________________________________________________________
+//
+// Return the amount of state words
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+int ManService::stateSize()
+{
+  return PlantItem::stateSize() + 1;
+}
+//_________________________________________________________
+//
+// Swap drawing fields with the recorded ones
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void ManService::exchangeState(qint32 *state)
+{
+  exchangeField(m_status, state[0]);
 }
 //_________________________________________________________
 //
@@ -92,7 +112,7 @@ void ManService::stopMoving(bool doEmit /*= true*/)
   // check if we're moving
   if (m_movement_timer == 0) return;
   // kill timer
-  killTimer(m_movement_timer);
+  SimClock::killTimer(m_movement_timer);
   m_movement_timer = 0;
   // notify supervisor if needed
   if (doEmit)
@@ -104,6 +124,7 @@ void ManService::stopMoving(bool doEmit /*= true*/)
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void ManService::timerEvent(QTimerEvent* te)
 {
+  PROFILE_SCOPE("ManService::timerEvent");
   // count params for movement process to move the widget to new pos
   int delta = 0;
   if (te->timerId() == m_movement_timer)
@@ -113,7 +134,7 @@ void ManService::timerEvent(QTimerEvent* te)
     // calculate the new distance
     delta = (m_timeReach - m_timeLeft) * m_speed / 1000;
     // move widget
-    move(m_destX > m_startX ? m_startX + delta : m_startX - delta, pos().y());
+    moveTo(m_destX > m_startX ? m_startX + delta : m_startX - delta, pos().y());
     // if timer expired stop moving
     if (m_timeLeft == 0)
       stopMoving();
@@ -127,14 +148,14 @@ void ManService::timerEvent(QTimerEvent* te)
            te->timerId() == m_loadSleever_timer ||
            te->timerId() == m_cutEdge_timer)
   {
-    killTimer(te->timerId());
+    SimClock::killTimer(te->timerId());
     m_startWinder_timer = 0;
     m_rotateSpooler_timer = 0;
     m_changeSpooler_timer = 0;
     m_loadSleever_timer = 0;
     m_cutEdge_timer = 0;
     setStatus(IDLE);
-    update();
+    refresh();
     emit taskCompleted(m_session);
   }
 }
@@ -160,79 +181,119 @@ void ManService::startMachine(OperFunc operation)
         m_changeSpooler_timer = 0;
         m_loadSleever_timer = 0;
         m_cutEdge_timer = 0;
-        m_movement_timer = startTimer(timerResolution);
+        m_movement_timer = SimClock::startTimer(this, timerResolution);
         break;
       }
     // all other tasks are timer actions in specific duration
     case START_WINDER:
       setStatus(BUSY);
-      update();
+      refresh();
       m_timeLeft = m_timeStartWinder;
+      m_busyStart = SimClock::now();
 
       m_rotateSpooler_timer = 0;
       m_changeSpooler_timer = 0;
       m_loadSleever_timer = 0;
       m_movement_timer = 0;
       m_cutEdge_timer = 0;
-      m_startWinder_timer = startTimer(m_timeStartWinder);
+      m_startWinder_timer = SimClock::startTimer(this, m_timeStartWinder);
       break;
     case CUT_EDGE:
       setStatus(BUSY);
-      update();
+      refresh();
       m_timeLeft = m_timeCutEdge;
+      m_busyStart = SimClock::now();
 
       m_rotateSpooler_timer = 0;
       m_changeSpooler_timer = 0;
       m_loadSleever_timer = 0;
       m_movement_timer = 0;
       m_startWinder_timer = 0;
-      m_cutEdge_timer = startTimer(m_timeCutEdge);
+      m_cutEdge_timer = SimClock::startTimer(this, m_timeCutEdge);
       break;
     case ROTATE_SPOOLER:
       setStatus(BUSY);
-      update();
+      refresh();
       m_timeLeft = m_timeRotateSpooler;
+      m_busyStart = SimClock::now();
 
       m_changeSpooler_timer = 0;
       m_loadSleever_timer = 0;
       m_movement_timer = 0;
       m_startWinder_timer = 0;
       m_cutEdge_timer = 0;
-      m_rotateSpooler_timer = startTimer(m_timeRotateSpooler);
+      m_rotateSpooler_timer = SimClock::startTimer(this, m_timeRotateSpooler);
       break;
     case CHANGE_SPOOLER:
       setStatus(BUSY);
-      update();
+      refresh();
       m_timeLeft = m_timeChangeSpooler;
+      m_busyStart = SimClock::now();
 
       m_loadSleever_timer = 0;
       m_movement_timer = 0;
       m_startWinder_timer = 0;
       m_rotateSpooler_timer = 0;
       m_cutEdge_timer = 0;
-      m_changeSpooler_timer = startTimer(m_timeChangeSpooler);
+      m_changeSpooler_timer = SimClock::startTimer(this, m_timeChangeSpooler);
       break;
     case LOAD_SLEEVER:
       setStatus(BUSY);
-      update();
+      refresh();
       m_timeLeft = m_timeLoadSleever;
+      m_busyStart = SimClock::now();
 
       m_movement_timer = 0;
       m_startWinder_timer = 0;
       m_rotateSpooler_timer = 0;
       m_changeSpooler_timer = 0;
       m_cutEdge_timer = 0;
-      m_loadSleever_timer = startTimer(m_timeLoadSleever);
+      m_loadSleever_timer = SimClock::startTimer(this, m_timeLoadSleever);
       break;
   }
 }
 //_________________________________________________________
 //
+// Return the duration of the operation
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+int ManService::getOperationTime(OperFunc operation)
+{
+  switch(operation)
+  {
+    case START_WINDER:
+      return m_timeStartWinder;
+    case ROTATE_SPOOLER:
+      return m_timeRotateSpooler;
+    case CHANGE_SPOOLER:
+      return m_timeChangeSpooler;
+    case LOAD_SLEEVER:
+      return m_timeLoadSleever;
+    case CUT_EDGE:
+      return m_timeCutEdge;
+    default:
+      return 0;
+  }
+}
+//_________________________________________________________
+//
+// Return the time until the current movement or operation is over
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+int ManService::getTimeToFree()
+{
+  if (m_movement_timer > 0)
+    return m_timeLeft;
+  if (m_status == BUSY)
+    return qMax<qint64>(m_timeLeft - (SimClock::now() - m_busyStart), 0);
+  return 0;
+}
+//_________________________________________________________
+//
 // Public status setting method
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void ManService::setStatus(Status state)
 {
   m_status = state;
+  TraceRecorder::setStatus(m_id, statusNames[state]);
 }
 //_________________________________________________________
 //
@@ -245,7 +306,7 @@ void ManService::reachObject(QString idSession, int x, int y)
   // stop if we're moving
   if (m_movement_timer != 0)
   {
-    killTimer(m_movement_timer);
+    SimClock::killTimer(m_movement_timer);
     m_movement_timer = 0;
   }
   // set destination pos, init session and start the state machine
@@ -1,15 +1,15 @@
 #ifndef MAN_H
 #define MAN_H
 
-#include <QFrame>
 #include <QtGui>
+#include "plantitem.h"
 #include "invdatabase.h"
 //_________________________________________________________
 //
 // Class represents man service widget which is possible to move
 // with contsant speed
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-class ManService : public QFrame
+class ManService : public PlantItem
 {
   Q_OBJECT
 public:
@@ -30,13 +30,21 @@ public:
     LOAD_SLEEVER,       // reload sleever task in progress
     CUT_EDGE            // cut bobbin edge task in progress
   };
-  explicit ManService(ManServiceModel &model, QWidget *parent = 0);
+  explicit ManService(ManServiceModel &model, QObject *parent = 0);
   virtual ~ManService();
+  virtual void draw(QPainter &painter);
+  virtual void saveState(QVector<qint32> &state);
+  virtual int stateSize();
 
   QString getId() {return m_id;}
   Status getStatus() {return m_status;}
   bool isMoving() {return m_movement_timer>0;}
   void setStatus(Status state);
+  QString getSession() {return m_session;}
+  int getSpeed() {return m_speed;}
+  int getDestX() {return m_destX;}
+  int getOperationTime(OperFunc operation);
+  int getTimeToFree();
 
   void setDestPos(int x, int y);
   void reachObject(QString idSession, int x, int y);
@@ -55,7 +63,7 @@ public slots:
 
 protected:
   virtual void timerEvent(QTimerEvent *);
-  virtual void paintEvent(QPaintEvent *);
+  virtual void exchangeState(qint32 *state);
 
 private:
   void startMachine(OperFunc operation);
@@ -75,6 +83,7 @@ private:
   int m_startX;               // starting point x position
   int m_destX;                // destination x position
   int m_destY;                // destination y position
+  qint64 m_busyStart;         // session clock time of the operation start (ms)
 
   int m_movement_timer;       // movement timer id
   int m_startWinder_timer;    // start winder timer id
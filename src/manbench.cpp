@@ -0,0 +1,101 @@
+#include <QElapsedTimer>
+#include <QDebug>
+#include "manbench.h"
+
+const quint64 benchSeed = Q_UINT64_C(0x5c1cc0de);   // fixed seed of the synthetic plant
+const int plantWidth = 3000;                        // plant width (pixels)
+const int manSpeed = 100;                           // man walking speed (pixels per sec)
+const int budgetNs = 1000000;                       // planning budget of one event (ns)
+//_________________________________________________________
+//
+// Object constructor
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ManDispatchBenchmark::ManDispatchBenchmark()
+{
+  m_state = benchSeed;
+  m_nextId = 0;
+}
+//_________________________________________________________
+//
+// Plan the routes for the amount of events keeping the amount of
+// pending tasks, print the mean and the worst planning time
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void ManDispatchBenchmark::run(int tasks, int men /*= 3*/, int events /*= 1000*/)
+{
+  m_state = benchSeed;
+  m_nextId = 0;
+  QVector<ManJob> jobs;
+  for(int i = 0; i < tasks; i++)
+    jobs.append(makeJob(men));
+
+  ManDispatcher dispatcher;
+  QVector<ManState> states(men);
+  for(int m = 0; m < men; m++)
+  {
+    states[m].idMan = QString("M%1").arg(m);
+    states[m].x = draw(plantWidth);
+    states[m].speed = manSpeed;
+    states[m].freeIn = draw(30000);
+  }
+  QElapsedTimer timer;
+  qint64 totalNs = 0;
+  qint64 worstNs = 0;
+  int overBudget = 0;
+
+  for(int e = 0; e < events; e++)
+  {
+    // one man has done a task and got busy with the next one
+    if (!jobs.isEmpty())
+    {
+      int done = draw(jobs.size());
+      ManState &state = states[draw(men)];
+      state.x = jobs[done].x;
+      state.freeIn = jobs[done].durations[0];
+      jobs.remove(done);
+    }
+    // the new task arrives
+    jobs.append(makeJob(men));
+
+    timer.start();
+    dispatcher.plan(states, jobs);
+    qint64 ns = timer.nsecsElapsed();
+    totalNs += ns;
+    worstNs = qMax(worstNs, ns);
+    if (ns > budgetNs)
+      overBudget++;
+  }
+
+  qDebug() << "Men:" << men << "pending tasks:" << tasks << "events:" << events;
+  qDebug() << "Mean plan time (us):" << (events > 0 ? totalNs / events / 1000 : 0);
+  qDebug() << "Worst plan time (us):" << worstNs / 1000;
+  qDebug() << "Events over 1 ms:" << overBudget;
+}
+//_________________________________________________________
+//
+// Draw the new pending task: start, spooler change or sleever load
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ManJob ManDispatchBenchmark::makeJob(int men)
+{
+  ManJob job;
+  job.idSession = QString("T%1").arg(m_nextId++);
+  job.x = draw(plantWidth);
+  // early spooler calls wait for the spooler to get full
+  job.releaseIn = draw(4) == 0 ? draw(60000) : 0;
+  int duration = 20000 + draw(100000);
+  for(int m = 0; m < men; m++)
+    job.durations.append(duration);
+  return job;
+}
+//_________________________________________________________
+//
+// Return the next random number in [0, range), splitmix64 steps
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+int ManDispatchBenchmark::draw(int range)
+{
+  m_state += Q_UINT64_C(0x9e3779b97f4a7c15);
+  quint64 z = m_state;
+  z = (z ^ (z >> 30)) * Q_UINT64_C(0xbf58476d1ce4e5b9);
+  z = (z ^ (z >> 27)) * Q_UINT64_C(0x94d049bb133111eb);
+  z = z ^ (z >> 31);
+  return range > 0 ? int(z % quint64(range)) : 0;
+}
@@ -0,0 +1,28 @@
+#ifndef MANBENCH_H
+#define MANBENCH_H
+
+#include <QVector>
+#include "mandispatch.h"
+//_________________________________________________________
+//
+// Class measures the man route planning on a synthetic plant. Every
+// event a man takes one pending task and a new one arrives, then routes
+// are planned again, the way the supervisor does on task changes.
+// Tasks are drawn from the fixed seed, so runs are reproducible
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+class ManDispatchBenchmark
+{
+public:
+  ManDispatchBenchmark();
+
+  void run(int tasks, int men = 3, int events = 1000);
+
+private:
+  ManJob makeJob(int men);
+  int draw(int range);
+
+  quint64 m_state;    // random generator state
+  int m_nextId;       // next task session number
+};
+
+#endif
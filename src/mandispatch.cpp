@@ -0,0 +1,375 @@
+#include "mandispatch.h"
+#include "profiler.h"
+
+const int maxPasses = 8;                        // improvement passes limit of one plan
+const int maxSegment = 16;                      // longest route segment reversed or passed over by a moved task
+const int maxNeighbours = 8;                    // nearest tasks the place is looked for next to
+const qint64 unplanned = Q_INT64_C(0x7fffffffffffffff);   // cost of a task nobody can reach
+//_________________________________________________________
+//
+// Plan routes for the current men and tasks. The previous routes
+// are the starting solution, gone tasks are dropped from them
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void ManDispatcher::plan(const QVector<ManState> &men, const QVector<ManJob> &jobs)
+{
+  PROFILE_SCOPE("ManDispatcher::plan");
+  m_men = men;
+  m_jobs = jobs;
+  m_routes.fill(QVector<int>(), m_men.size());
+  m_times.fill(RouteTimes(), m_men.size());
+  m_owner.fill(-1, m_jobs.size());
+  m_place.fill(0, m_jobs.size());
+
+  QHash<QString, int> jobIndex;
+  for(int i = 0; i < m_jobs.size(); i++)
+    jobIndex.insert(m_jobs[i].idSession, i);
+
+  // order tasks by position, tasks come almost in this order
+  m_byX.clear();
+  for(int i = 0; i < m_jobs.size(); i++)
+  {
+    int pos = m_byX.size();
+    while (pos > 0 && m_jobs[m_byX[pos - 1]].x > m_jobs[i].x)
+      pos--;
+    m_byX.insert(pos, i);
+  }
+  m_rank.fill(0, m_jobs.size());
+  for(int i = 0; i < m_byX.size(); i++)
+    m_rank[m_byX[i]] = i;
+
+  // restore the previous routes
+  QVector<int> planned(m_jobs.size(), 0);
+  for(int m = 0; m < m_men.size(); m++)
+  {
+    if (m_men[m].speed > 0)
+    {
+      foreach(QString id, m_plan.value(m_men[m].idMan))
+      {
+        int job = jobIndex.value(id, -1);
+        if (job < 0 || planned[job]) continue;
+        m_routes[m].append(job);
+        planned[job] = 1;
+      }
+    }
+    updateTimes(m);
+  }
+
+  // insert new tasks at their cheapest places
+  for(int job = 0; job < m_jobs.size(); job++)
+  {
+    if (planned[job]) continue;
+    int man = -1;
+    int pos = 0;
+    if (insertCost(job, man, pos) == unplanned) continue;
+    m_routes[man].insert(pos, job);
+    updateTimes(man);
+  }
+
+  // improve until nothing changes
+  for(int pass = 0; pass < maxPasses; pass++)
+  {
+    bool changed = false;
+    for(int m = 0; m < m_men.size(); m++)
+      changed = improveRoute(m) || changed;
+    changed = relocateJobs() || changed;
+    if (!changed) break;
+  }
+
+  // keep the plan for the next call
+  m_plan.clear();
+  for(int m = 0; m < m_men.size(); m++)
+  {
+    QStringList &ids = m_plan[m_men[m].idMan];
+    foreach(int job, m_routes[m])
+      ids.append(m_jobs[job].idSession);
+  }
+}
+//_________________________________________________________
+//
+// Walking time of the man between positions (ms)
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+qint64 ManDispatcher::walkTime(int man, int fromX, int toX)
+{
+  return 1000 * (qint64)qAbs(toX - fromX) / m_men[man].speed;
+}
+//_________________________________________________________
+//
+// Count task times of the route from now. The cost is the sum of
+// task completion times
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void ManDispatcher::updateTimes(int man)
+{
+  const ManState &state = m_men[man];
+  const QVector<int> &route = m_routes[man];
+  RouteTimes &times = m_times[man];
+  int size = route.size();
+  times.arrive.resize(size);
+  times.finish.resize(size);
+  times.wait.resize(size);
+  times.nextWait.resize(size + 1);
+  times.cost = 0;
+  times.settled = false;
+  if (state.speed <= 0) return;
+
+  qint64 time = state.freeIn;
+  int x = state.x;
+  for(int i = 0; i < size; i++)
+  {
+    const ManJob &job = m_jobs[route[i]];
+    qint64 arrive = time + walkTime(man, x, job.x);
+    qint64 start = qMax<qint64>(arrive, job.releaseIn);
+    time = start + job.durations[man];
+    times.arrive[i] = arrive;
+    times.wait[i] = start - arrive;
+    times.finish[i] = time;
+    times.cost += time;
+    x = job.x;
+    m_owner[route[i]] = man;
+    m_place[route[i]] = i;
+  }
+  times.nextWait[size] = size;
+  for(int i = size - 1; i >= 0; i--)
+    times.nextWait[i] = times.wait[i] > 0 ? i : times.nextWait[i + 1];
+}
+//_________________________________________________________
+//
+// Cost change of the route tail from the position when the man
+// reaches it later by the shift. Tasks started at once move by the
+// whole shift, a task waiting for its release absorbs the shift up
+// to the waiting time, so only waiting tasks are visited
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+qint64 ManDispatcher::shiftCost(int man, int pos, qint64 shift)
+{
+  const RouteTimes &times = m_times[man];
+  int size = m_routes[man].size();
+  qint64 cost = 0;
+  while (pos < size && shift != 0)
+  {
+    int next = times.nextWait[pos];
+    cost += shift * (next - pos);
+    if (next == size) break;
+    shift = shift > 0 ? qMax<qint64>(shift - times.wait[next], 0) : 0;
+    cost += shift;
+    pos = next + 1;
+  }
+  return cost;
+}
+//_________________________________________________________
+//
+// Cost increase of the route when the task is inserted at the position
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+qint64 ManDispatcher::insertDelta(int man, int job, int pos)
+{
+  const QVector<int> &route = m_routes[man];
+  const RouteTimes &times = m_times[man];
+  const ManJob &it = m_jobs[job];
+  qint64 time = pos > 0 ? times.finish[pos - 1] : m_men[man].freeIn;
+  int x = pos > 0 ? m_jobs[route[pos - 1]].x : m_men[man].x;
+
+  time = qMax<qint64>(time + walkTime(man, x, it.x), it.releaseIn) + it.durations[man];
+  if (pos == route.size())
+    return time;
+  return time + shiftCost(man, pos, time + walkTime(man, it.x, m_jobs[route[pos]].x) - times.arrive[pos]);
+}
+//_________________________________________________________
+//
+// Cost change of the route when the segment is reversed
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+qint64 ManDispatcher::reverseDelta(int man, int first, int last)
+{
+  const QVector<int> &route = m_routes[man];
+  const RouteTimes &times = m_times[man];
+  qint64 time = first > 0 ? times.finish[first - 1] : m_men[man].freeIn;
+  int x = first > 0 ? m_jobs[route[first - 1]].x : m_men[man].x;
+
+  qint64 delta = 0;
+  for(int i = last; i >= first; i--)
+  {
+    const ManJob &it = m_jobs[route[i]];
+    time = qMax<qint64>(time + walkTime(man, x, it.x), it.releaseIn) + it.durations[man];
+    delta += time - times.finish[i];
+    x = it.x;
+  }
+  if (last + 1 < route.size())
+    delta += shiftCost(man, last + 1, time + walkTime(man, x, m_jobs[route[last + 1]].x) - times.arrive[last + 1]);
+  return delta;
+}
+//_________________________________________________________
+//
+// Cost decrease of the route when the task at the position is taken out
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+qint64 ManDispatcher::removeSaving(int man, int pos)
+{
+  const QVector<int> &route = m_routes[man];
+  const RouteTimes &times = m_times[man];
+  qint64 time = pos > 0 ? times.finish[pos - 1] : m_men[man].freeIn;
+  int x = pos > 0 ? m_jobs[route[pos - 1]].x : m_men[man].x;
+
+  qint64 saving = times.finish[pos];
+  if (pos + 1 < route.size())
+    saving -= shiftCost(man, pos + 1, time + walkTime(man, x, m_jobs[route[pos + 1]].x) - times.arrive[pos + 1]);
+  return saving;
+}
+//_________________________________________________________
+//
+// Cost change of the route when the task is moved from the position
+// to the position of the route without it. Tasks between both places
+// are counted again, the tail is shifted
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+qint64 ManDispatcher::moveDelta(int man, int from, int to)
+{
+  const QVector<int> &route = m_routes[man];
+  const RouteTimes &times = m_times[man];
+  int first = qMin(from, to);
+  int last = qMax(from, to);
+  qint64 time = first > 0 ? times.finish[first - 1] : m_men[man].freeIn;
+  int x = first > 0 ? m_jobs[route[first - 1]].x : m_men[man].x;
+
+  qint64 delta = 0;
+  for(int i = first; i <= last; i++)
+  {
+    int job;
+    if (to < from)
+      job = i == first ? route[from] : route[i - 1];
+    else
+      job = i == last ? route[from] : route[i + 1];
+    const ManJob &it = m_jobs[job];
+    time = qMax<qint64>(time + walkTime(man, x, it.x), it.releaseIn) + it.durations[man];
+    delta += time - times.finish[i];
+    x = it.x;
+  }
+  if (last + 1 < route.size())
+    delta += shiftCost(man, last + 1, time + walkTime(man, x, m_jobs[route[last + 1]].x) - times.arrive[last + 1]);
+  return delta;
+}
+//_________________________________________________________
+//
+// Find the cheapest place of the task: ends of all routes and places
+// next to the nearest tasks, a far task is not a good neighbour. A
+// planned task is moved, its route is counted without it. Return the
+// cost change of the plan, unplanned if no man is able to walk
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+qint64 ManDispatcher::insertCost(int job, int &bestMan, int &bestPos)
+{
+  int owner = m_owner[job];
+  qint64 saving = owner >= 0 ? removeSaving(owner, m_place[job]) : 0;
+  qint64 best = unplanned;
+  for(int m = 0; m < m_men.size(); m++)
+  {
+    if (m_men[m].speed <= 0) continue;
+    tryPlace(m, job, 0, saving, best, bestMan, bestPos);
+    tryPlace(m, job, m_routes[m].size() - (m == owner ? 1 : 0), saving, best, bestMan, bestPos);
+  }
+
+  int x = m_jobs[job].x;
+  int left = m_rank[job] - 1;
+  int right = m_rank[job] + 1;
+  for(int k = 0; k < maxNeighbours; k++)
+  {
+    int near;
+    if (left < 0 && right >= m_byX.size())
+      break;
+    else if (left < 0)
+      near = m_byX[right++];
+    else if (right >= m_byX.size())
+      near = m_byX[left--];
+    else if (x - m_jobs[m_byX[left]].x <= m_jobs[m_byX[right]].x - x)
+      near = m_byX[left--];
+    else
+      near = m_byX[right++];
+
+    int man = m_owner[near];
+    if (man < 0) continue;
+    int place = m_place[near];
+    if (man == owner && place > m_place[job])
+      place--;
+    tryPlace(man, job, place, saving, best, bestMan, bestPos);
+    tryPlace(man, job, place + 1, saving, best, bestMan, bestPos);
+  }
+  return best;
+}
+//_________________________________________________________
+//
+// Keep the place if the task gets there cheaper than to the best one.
+// The task is moved inside its route by up to maxSegment places
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void ManDispatcher::tryPlace(int man, int job, int pos, qint64 saving, qint64 &best, int &bestMan, int &bestPos)
+{
+  qint64 cost;
+  if (man == m_owner[job])
+  {
+    // far moves inside the route are left to the route order
+    if (qAbs(pos - m_place[job]) > maxSegment) return;
+    cost = moveDelta(man, m_place[job], pos);
+  }
+  else
+    cost = insertDelta(man, job, pos) - saving;
+  if (cost < best)
+  {
+    best = cost;
+    bestMan = man;
+    bestPos = pos;
+  }
+}
+//_________________________________________________________
+//
+// 2-opt: reverse route segments while the route gets cheaper. Long
+// routes are improved by segments up to maxSegment tasks
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool ManDispatcher::improveRoute(int man)
+{
+  QVector<int> &route = m_routes[man];
+  if (route.size() < 2 || m_men[man].speed <= 0 || m_times[man].settled) return false;
+
+  bool changed = false;
+  for(int i = 0; i < route.size() - 1; i++)
+  {
+    for(int j = i + 1; j < route.size() && j - i < maxSegment; j++)
+    {
+      if (reverseDelta(man, i, j) >= 0) continue;
+      for(int lo = i, hi = j; lo < hi; lo++, hi--)
+        qSwap(route[lo], route[hi]);
+      updateTimes(man);
+      changed = true;
+    }
+  }
+  // the route is not checked again until it changes
+  if (!changed)
+    m_times[man].settled = true;
+  return changed;
+}
+//_________________________________________________________
+//
+// Move every task to its cheapest place, the task moves to another
+// route if it gets done cheaper there
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool ManDispatcher::relocateJobs()
+{
+  bool changed = false;
+  for(int m = 0; m < m_men.size(); m++)
+  {
+    int pos = 0;
+    while (pos < m_routes[m].size())
+    {
+      int job = m_routes[m][pos];
+      int man = m;
+      int place = pos;
+      if (insertCost(job, man, place) >= 0)
+      {
+        pos++;
+        continue;
+      }
+
+      m_routes[m].remove(pos);
+      m_routes[man].insert(place, job);
+      updateTimes(m);
+      if (man != m)
+        updateTimes(man);
+      changed = true;
+      // the next task has moved to the place unless the task went before it
+      if (man == m && place <= pos)
+        pos++;
+    }
+  }
+  return changed;
+}
@@ -0,0 +1,78 @@
+#ifndef MANDISPATCH_H
+#define MANDISPATCH_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+// Man-service state for the route planning
+struct ManState
+{
+  QString idMan;          // ManService Id
+  int x;                  // position where the man gets free
+  int speed;              // walking speed, the man is not planned if 0
+  int freeIn;             // time until the man gets free (ms)
+};
+// Pending man-service task
+struct ManJob
+{
+  QString idSession;      // task session Id
+  int x;                  // task object position
+  int releaseIn;          // time until the task may be started (ms)
+  QVector<int> durations; // task duration of every planned man (ms)
+};
+//_________________________________________________________
+//
+// Class plans the routes of men over all pending man-service tasks.
+// The route cost is the sum of task completion times, so both walking
+// and waiting of tasks count, tasks are not started before their
+// release. Routes of the previous plan are kept,
+// new tasks are added by the cheapest insertion and the plan is improved
+// by 2-opt inside routes and by moving single tasks between routes.
+// Times of every route are kept, so a move is evaluated by the shift
+// of the route tail instead of the whole route cost. A task is placed
+// at route ends or next to its nearest tasks only.
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+class ManDispatcher
+{
+public:
+  void clear() {m_plan.clear();}
+  void plan(const QVector<ManState> &men, const QVector<ManJob> &jobs);
+  QStringList route(const QString &idMan) {return m_plan.value(idMan);}
+
+private:
+  // Task times of the route
+  struct RouteTimes
+  {
+    QVector<qint64> arrive;   // time the man reaches the task (ms)
+    QVector<qint64> finish;   // time the task is done (ms)
+    QVector<qint64> wait;     // time the man waits for the task release (ms)
+    QVector<int> nextWait;    // index of the next task with waiting, the route size if none
+    qint64 cost;              // sum of task completion times
+    bool settled;             // true if 2-opt has not improved the route
+  };
+
+  qint64 walkTime(int man, int fromX, int toX);
+  void updateTimes(int man);
+  qint64 shiftCost(int man, int pos, qint64 shift);
+  qint64 insertDelta(int man, int job, int pos);
+  qint64 reverseDelta(int man, int first, int last);
+  qint64 removeSaving(int man, int pos);
+  qint64 moveDelta(int man, int from, int to);
+  qint64 insertCost(int job, int &bestMan, int &bestPos);
+  void tryPlace(int man, int job, int pos, qint64 saving, qint64 &best, int &bestMan, int &bestPos);
+  bool improveRoute(int man);
+  bool relocateJobs();
+
+  QVector<ManState> m_men;              // planned men
+  QVector<ManJob> m_jobs;               // planned tasks
+  QVector<QVector<int> > m_routes;      // task indexes of every man in the visiting order
+  QVector<RouteTimes> m_times;          // task times of every route
+  QVector<int> m_owner;                 // route of every task, -1 if not planned
+  QVector<int> m_place;                 // position of every task in its route
+  QVector<int> m_byX;                   // task indexes ordered by position
+  QVector<int> m_rank;                  // index of every task in m_byX
+  QHash<QString, QStringList> m_plan;   // session ids by man id, the last plan
+};
+
+#endif
@@ -0,0 +1,84 @@
+#include "planner.h"
+//_________________________________________________________
+//
+// Drop all timelines
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void DispatchPlanner::clear()
+{
+  m_timelines.clear();
+}
+//_________________________________________________________
+//
+// Set the new predicted completion of the winder. The entry is moved
+// to its place in the timeline and is not dispatched any more
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void DispatchPlanner::update(const QString &idDoffer, const QString &idWinder, qint64 readyAt)
+{
+  QList<Completion> &timeline = m_timelines[idDoffer];
+  int index = indexOf(timeline, idWinder);
+  if (index >= 0)
+    timeline.removeAt(index);
+
+  // groups are small, the place is found by the linear search
+  Completion item;
+  item.idWinder = idWinder;
+  item.readyAt = readyAt;
+  item.dispatched = false;
+  int i = 0;
+  while (i < timeline.size() && timeline[i].readyAt <= readyAt)
+    i++;
+  timeline.insert(i, item);
+}
+//_________________________________________________________
+//
+// Drop the winder from the timeline
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void DispatchPlanner::remove(const QString &idDoffer, const QString &idWinder)
+{
+  QList<Completion> &timeline = m_timelines[idDoffer];
+  int index = indexOf(timeline, idWinder);
+  if (index >= 0)
+    timeline.removeAt(index);
+}
+//_________________________________________________________
+//
+// Mark the winder completion as served by the doffer or clear the mark
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void DispatchPlanner::setDispatched(const QString &idDoffer, const QString &idWinder, bool dispatched /*= true*/)
+{
+  QList<Completion> &timeline = m_timelines[idDoffer];
+  int index = indexOf(timeline, idWinder);
+  if (index >= 0)
+    timeline[index].dispatched = dispatched;
+}
+//_________________________________________________________
+//
+// Return true if the winder completion is predicted
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool DispatchPlanner::isTracked(const QString &idDoffer, const QString &idWinder)
+{
+  return indexOf(m_timelines.value(idDoffer), idWinder) >= 0;
+}
+//_________________________________________________________
+//
+// Return true if the doffer has been sent to a winder which is
+// not completed yet
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool DispatchPlanner::hasDispatched(const QString &idDoffer)
+{
+  foreach(const Completion &it, m_timelines.value(idDoffer))
+    if (it.dispatched)
+      return true;
+  return false;
+}
+//_________________________________________________________
+//
+// Return the winder entry index, -1 if not found
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+int DispatchPlanner::indexOf(const QList<Completion> &timeline, const QString &idWinder)
+{
+  for(int i = 0; i < timeline.size(); i++)
+    if (timeline[i].idWinder == idWinder)
+      return i;
+  return -1;
+}
@@ -0,0 +1,40 @@
+#ifndef PLANNER_H
+#define PLANNER_H
+
+#include <QString>
+#include <QList>
+#include <QHash>
+// Predicted winder completion
+struct Completion
+{
+  QString idWinder;       // Winder Id
+  qint64 readyAt;         // Predicted time of ready bobbins (ms)
+  bool dispatched;        // true if the doffer has been sent to the winder
+};
+//_________________________________________________________
+//
+// Class keeps the timeline of predicted winder completions for every
+// doffer group, the earliest completion first. The timeline is updated
+// incrementally: a winder entry is replaced when the winder starts
+// winding and dropped when the winder stops winding (bobbins ready,
+// cut edge, failure). The dispatched mark is cleared when the doffer
+// movement task ends.
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+class DispatchPlanner
+{
+public:
+  void clear();
+  void update(const QString &idDoffer, const QString &idWinder, qint64 readyAt);
+  void remove(const QString &idDoffer, const QString &idWinder);
+  void setDispatched(const QString &idDoffer, const QString &idWinder, bool dispatched = true);
+  bool isTracked(const QString &idDoffer, const QString &idWinder);
+  bool hasDispatched(const QString &idDoffer);
+  QList<Completion> timeline(const QString &idDoffer) {return m_timelines.value(idDoffer);}
+
+private:
+  int indexOf(const QList<Completion> &timeline, const QString &idWinder);
+
+  QHash<QString, QList<Completion> > m_timelines;   // completions by doffer id, the earliest first
+};
+
+#endif
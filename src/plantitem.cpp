@@ -0,0 +1,109 @@
+#include "plantitem.h"
+//_________________________________________________________
+//
+// Object constructor. The object is off the canvas
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+PlantItem::PlantItem(QObject *parent /*=0*/) :
+  QObject(parent)
+{
+  m_canvas = dynamic_cast<PlantCanvas *>(parent);
+  m_onCanvas = false;
+}
+//_________________________________________________________
+//
+// Show or hide the object on the parent canvas
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void PlantItem::setOnCanvas(bool onCanvas)
+{
+  if (m_onCanvas == onCanvas) return;
+  m_onCanvas = onCanvas;
+  refresh();
+}
+//_________________________________________________________
+//
+// Draw the simplified object. Objects without their own glyph
+// are drawn in full detail
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void PlantItem::drawGlyph(QPainter &painter)
+{
+  draw(painter);
+}
+//_________________________________________________________
+//
+// Invalidate the object area on the parent canvas. The canvas
+// repaints it with the next frame
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void PlantItem::refresh()
+{
+  refresh(geometry());
+}
+//_________________________________________________________
+//
+// Invalidate the area in layout coordinates, i.e. the object overlay
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void PlantItem::refresh(const QRect &area)
+{
+  if (m_canvas != NULL)
+    m_canvas->invalidate(area);
+}
+//_________________________________________________________
+//
+// Move the object and invalidate both old and new areas
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void PlantItem::moveTo(int x, int y)
+{
+  if (x == this->x() && y == this->y()) return;
+  refresh();
+  move(x, y);
+  refresh();
+}
+//_________________________________________________________
+//
+// Append the compact object state: position and the fields
+// of subclasses which are necessary for drawing
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void PlantItem::saveState(QVector<qint32> &state)
+{
+  state.append(x());
+  state.append(y());
+}
+//_________________________________________________________
+//
+// Return the amount of words appended by saveState
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+int PlantItem::stateSize()
+{
+  return 2;
+}
+//_________________________________________________________
+//
+// Swap drawing fields with the recorded ones which follow the
+// position. The second call restores the live object
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void PlantItem::exchangeState(qint32 *state)
+{
+  Q_UNUSED(state)
+}
+//_________________________________________________________
+//
+// Draw the object in the recorded state and move the state pointer
+// to the next object. The live object is drawn with recorded fields
+// swapped in and restored right after that
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void PlantItem::renderState(QPainter &painter, const QRect &exposed, bool detailed, qint32 *&state)
+{
+  QPoint pt(state[0], state[1]);
+  qint32 *fields = state + 2;
+  state += stateSize();
+  if (!m_onCanvas || !QRect(pt, size()).intersects(exposed)) return;
+
+  exchangeState(fields);
+  painter.save();
+  painter.translate(pt);
+  if (detailed)
+    draw(painter);
+  else
+    drawGlyph(painter);
+  painter.restore();
+  exchangeState(fields);
+}
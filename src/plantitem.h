@@ -0,0 +1,70 @@
+#ifndef PLANTITEM_H
+#define PLANTITEM_H
+
+#include <QObject>
+#include <QtGui>
+//_________________________________________________________
+//
+// Interface of the canvas which collects invalidated areas of
+// plant objects and repaints them on its own frame timer
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+class PlantCanvas
+{
+public:
+  virtual ~PlantCanvas() {}
+  virtual void invalidate(const QRect &rect) = 0;
+};
+//_________________________________________________________
+//
+// Class represents the plant object. It is not a widget, it keeps
+// the geometry and timers only, so the plant runs on the simulation
+// thread. The canvas draws all objects in one pass
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+class PlantItem : public QObject
+{
+  Q_OBJECT
+public:
+  explicit PlantItem(QObject *parent = 0);
+
+  int x() const {return m_geometry.x();}
+  int y() const {return m_geometry.y();}
+  int width() const {return m_geometry.width();}
+  int height() const {return m_geometry.height();}
+  QPoint pos() const {return m_geometry.topLeft();}
+  QSize size() const {return m_geometry.size();}
+  QRect rect() const {return QRect(QPoint(0, 0), m_geometry.size());}
+  QRect geometry() const {return m_geometry;}
+  void move(int x, int y) {m_geometry.moveTo(x, y);}
+  void move(const QPoint &pt) {m_geometry.moveTo(pt);}
+  void resize(int width, int height) {m_geometry.setSize(QSize(width, height));}
+
+  bool isOnCanvas() {return m_onCanvas;}
+  void setOnCanvas(bool onCanvas);
+  void refresh();
+  void refresh(const QRect &area);
+  void moveTo(int x, int y);
+  void renderState(QPainter &painter, const QRect &exposed, bool detailed, qint32 *&state);
+
+  virtual void draw(QPainter &painter) = 0;
+  virtual void drawGlyph(QPainter &painter);
+  virtual void saveState(QVector<qint32> &state);
+  virtual int stateSize();
+
+protected:
+  virtual void exchangeState(qint32 *state);
+
+  // Swap the object field with the recorded state value
+  template<class T> static void exchangeField(T &field, qint32 &value)
+  {
+    qint32 recorded = value;
+    value = (qint32)field;
+    field = (T)recorded;
+  }
+
+private:
+  QRect m_geometry;       // object area in the plant layout
+  PlantCanvas *m_canvas;  // parent canvas, NULL if nobody repaints the object
+  bool m_onCanvas;        // true if the object is drawn by the canvas
+};
+
+#endif
@@ -0,0 +1,254 @@
+#include <QTime>
+#include "plantview.h"
+#include "profiler.h"
+#include "tracer.h"
+
+const double minZoom = 0.1;         // canvas zoom limits
+const double maxZoom = 4.0;
+const double detailZoom = 0.5;      // objects are drawn as simplified glyphs below this zoom
+const qint64 historyInterval = 1000;          // simulation time between recorded plant states (ms)
+const qint64 historyDepth = 9 * 3600 * 1000;  // recorded simulation time, a shift with a spare hour (ms)
+const int historyKeyframe = 60;               // recorded states per keyframe
+//_________________________________________________________
+//
+// Object constructor. Set default values for parameters
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+PlantView::PlantView(QWidget *parent /*=0*/) : QFrame(parent),
+  m_history(historyDepth, historyKeyframe)
+{
+  setFrameStyle(NoFrame | Plain);
+  m_core = NULL;
+  m_plant = NULL;
+  m_wholeWidthPixels = 0;
+  m_zoom = 1.0;
+  m_frameSeq = 0;
+  m_frameTime = 0;
+  m_nextSnapshot = 0;
+  m_replayIndex = -1;
+
+  // supervisor signals are queued from the simulation thread
+  qRegisterMetaType<Logger::FieldNames>("Logger::FieldNames");
+  qRegisterMetaType<Logger::LatencyFields>("Logger::LatencyFields");
+  qRegisterMetaType<QList<KpiValue> >("QList<KpiValue>");
+}
+//_________________________________________________________
+//
+// Object destructor. The simulation is stopped first
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+PlantView::~PlantView()
+{
+  stop();
+}
+//_________________________________________________________
+//
+// Start the new session. Both supervisors are built here from the
+// database, then the running one is moved to the simulation thread
+// with its objects and timers
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void PlantView::start()
+{
+  stop();
+
+  // the canvas plant has the same layout as the running one
+  m_plant = new Supervisor();
+  m_plant->SetWholeWidthPixels(m_wholeWidthPixels);
+  m_plant->layout();
+
+  m_core = new Supervisor();
+  m_core->SetWholeWidthPixels(m_wholeWidthPixels);
+  connect(m_core, SIGNAL(appendLoggerItem(QString,qint64)), this, SIGNAL(appendLoggerItem(QString,qint64)));
+  connect(m_core, SIGNAL(updateLoggerItem(QString,Logger::FieldNames,qint64)), this, SIGNAL(updateLoggerItem(QString,Logger::FieldNames,qint64)));
+  connect(m_core, SIGNAL(updateLatency(QString,Logger::LatencyFields,qint64)), this, SIGNAL(updateLatency(QString,Logger::LatencyFields,qint64)));
+  connect(m_core, SIGNAL(kpiUpdated(QList<KpiValue>)), this, SIGNAL(kpiUpdated(QList<KpiValue>)));
+  connect(m_core, SIGNAL(frameReady()), this, SLOT(takeFrame()));
+  m_core->start();            // init containers and models from database
+  m_core->startWinders();     // start simulation
+  m_core->moveToThread(&m_simThread);
+  m_simThread.start();
+
+  // start the new history
+  m_frameSeq = 0;
+  m_frameTime = 0;
+  m_history.clear();
+  m_nextSnapshot = 0;
+  m_replayIndex = -1;
+  m_replayState.clear();
+  emit historyChanged();
+  setZoom(m_zoom);
+}
+//_________________________________________________________
+//
+// Stop the session. The running supervisor is stopped on its own
+// thread, signals it has queued for the canvas are dropped
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void PlantView::stop()
+{
+  if (m_core != NULL)
+  {
+    QMetaObject::invokeMethod(m_core, "stop", Qt::BlockingQueuedConnection);
+    m_simThread.quit();
+    m_simThread.wait();
+    QCoreApplication::removePostedEvents(this, QEvent::MetaCall);
+    delete m_core;
+    m_core = NULL;
+  }
+  if (m_plant != NULL)
+  {
+    delete m_plant;
+    m_plant = NULL;
+  }
+
+  m_frameSeq = 0;
+  m_history.clear();    // recorded states refer to deleted objects
+  m_replayIndex = -1;
+  m_replayState.clear();
+  emit historyChanged();
+  update();             // clean up the canvas
+}
+//_________________________________________________________
+//
+// Start trace recording on the simulation thread
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void PlantView::startTrace()
+{
+  if (m_core != NULL)
+    QMetaObject::invokeMethod(m_core, "startTrace", Qt::BlockingQueuedConnection);
+  else
+    TraceRecorder::start();
+}
+//_________________________________________________________
+//
+// Stop trace recording on the simulation thread. The recorder
+// may be saved after the call
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void PlantView::stopTrace()
+{
+  if (m_core != NULL)
+    QMetaObject::invokeMethod(m_core, "stopTrace", Qt::BlockingQueuedConnection);
+  else
+    TraceRecorder::stop();
+}
+//_________________________________________________________
+//
+// Take the newest published frame, repaint its invalidated area
+// and record it for the timeline. Dropped frames are not known
+// to the canvas, the whole canvas is repainted after them
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void PlantView::takeFrame()
+{
+  if (m_core == NULL || !m_core->getFrames().take()) return;
+
+  PlantFrame &frame = m_core->getFrames().front();
+  if (m_replayIndex < 0)
+  {
+    if (frame.seq != m_frameSeq + 1)
+      update();
+    else if (!frame.dirty.isEmpty())
+      update(toCanvas(frame.dirty));
+  }
+  m_frameSeq = frame.seq;
+  m_frameTime = frame.time;
+
+  // record the plant state for the timeline
+  if (frame.time >= m_nextSnapshot)
+  {
+    m_history.append(frame.time, frame.state);
+    m_nextSnapshot = frame.time + historyInterval;
+    emit historyChanged();
+  }
+}
+//_________________________________________________________
+//
+// Draw the shown frame or history state in one pass. Only objects
+// intersecting the exposed area are drawn
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void PlantView::paintEvent(QPaintEvent *pe)
+{
+  PROFILE_SCOPE("PlantView::paintEvent");
+  QFrame::paintEvent(pe);
+  if (m_plant == NULL || m_core == NULL) return;
+
+  QPainter painter;
+  // the timeline shows the recorded state instead of the live plant
+  QVector<qint32> &state = m_replayIndex >= 0 ? m_replayState : m_core->getFrames().front().state;
+
+  painter.begin(this);    // open drawing context
+  painter.setClipRect(pe->rect());
+  painter.scale(m_zoom, m_zoom);
+  m_plant->drawState(painter, toLayout(pe->rect()), m_zoom >= detailZoom, state);
+  painter.end();          // close drawing context
+}
+//_________________________________________________________
+//
+// Show the recorded state on the canvas, -1 returns to the live plant
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void PlantView::showHistory(int index)
+{
+  if (index < 0 || !m_history.stateAt(index, m_replayState))
+  {
+    m_replayIndex = -1;
+    m_replayState.clear();
+  }
+  else
+    m_replayIndex = index;
+  update();
+}
+//_________________________________________________________
+//
+// Return the description of the shown state: simulation time and
+// task queue summary
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+QString PlantView::getHistoryCaption()
+{
+  qint64 time = m_replayIndex >= 0 ? m_history.timeAt(m_replayIndex) : m_frameTime;
+  QString caption = QTime(0, 0).addMSecs(time % (24 * 3600 * 1000)).toString("hh:mm:ss");
+  if (m_replayIndex < 0 || m_plant == NULL)
+    return caption + " live";
+
+  // count task states after object states
+  int offset = m_plant->getItemsStateSize();
+  if (offset >= m_replayState.size())
+    return caption;
+  int counts[Supervisor::DONE + 1] = {0};
+  int tasks = m_replayState.at(offset);
+  for(int i = 0; i < tasks && offset + 2 + i * 2 < m_replayState.size(); i++)
+  {
+    int status = m_replayState.at(offset + 2 + i * 2);
+    if (status >= Supervisor::NEW && status <= Supervisor::DONE)
+      counts[status]++;
+  }
+  return caption + QString(", tasks: %1 new, %2 in progress, %3 paused")
+                   .arg(counts[Supervisor::NEW]).arg(counts[Supervisor::PROGRESS]).arg(counts[Supervisor::PAUSED]);
+}
+//_________________________________________________________
+//
+// Set the canvas zoom. The plant layout keeps its pixel geometry,
+// only the widget size and the painting scale are changed
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void PlantView::setZoom(double zoom)
+{
+  if (zoom < minZoom) zoom = minZoom;
+  if (zoom > maxZoom) zoom = maxZoom;
+  m_zoom = zoom;
+  if (m_plant != NULL)
+    resize(ceil(m_plant->getLayoutSize().width() * m_zoom), ceil(m_plant->getLayoutSize().height() * m_zoom));
+  update();
+}
+//_________________________________________________________
+//
+// Convert canvas widget rectangle to the layout coordinates
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+QRect PlantView::toLayout(const QRect &rect)
+{
+  return QRect(floor(rect.x() / m_zoom), floor(rect.y() / m_zoom),
+               ceil(rect.width() / m_zoom) + 1, ceil(rect.height() / m_zoom) + 1);
+}
+//_________________________________________________________
+//
+// Convert layout rectangle to the canvas widget coordinates
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+QRect PlantView::toCanvas(const QRect &rect)
+{
+  return QRect(floor(rect.x() * m_zoom), floor(rect.y() * m_zoom),
+               ceil(rect.width() * m_zoom) + 1, ceil(rect.height() * m_zoom) + 1);
+}
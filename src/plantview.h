@@ -0,0 +1,66 @@
+#ifndef PLANTVIEW_H
+#define PLANTVIEW_H
+
+#include <QFrame>
+#include <QThread>
+#include "supervisor.h"
+#include "history.h"
+//_________________________________________________________
+//
+// Class represents the plant canvas widget. The running supervisor
+// lives on the simulation thread, so stepping, collisions and timers
+// never wait for painting. The canvas takes the newest frame the
+// supervisor publishes and draws it with the objects of its own
+// layout-only supervisor. Frames are recorded for the timeline too
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+class PlantView : public QFrame
+{
+  Q_OBJECT
+public:
+  explicit PlantView(QWidget *parent = 0);
+  virtual ~PlantView();
+
+  void start();
+  void stop();
+  void startTrace();
+  void stopTrace();
+  void SetWholeWidthPixels(int width) {m_wholeWidthPixels = width;}
+  double getZoom() {return m_zoom;}
+  void setZoom(double zoom);
+  qint64 simTime() {return m_frameTime;}
+  StateHistory &getHistory() {return m_history;}
+  bool isReplaying() {return m_replayIndex >= 0;}
+  void showHistory(int index);
+  QString getHistoryCaption();
+
+signals:
+  void appendLoggerItem(QString idObject, qint64 time);
+  void updateLoggerItem(QString idObject, Logger::FieldNames field, qint64 time);
+  void updateLatency(QString taskType, Logger::LatencyFields field, qint64 value);
+  void kpiUpdated(QList<KpiValue> values);
+  void historyChanged();
+
+private slots:
+  void takeFrame();
+
+protected:
+  virtual void paintEvent(QPaintEvent *);
+
+private:
+  QRect toLayout(const QRect &rect);
+  QRect toCanvas(const QRect &rect);
+
+  Supervisor *m_core;               // running supervisor on the simulation thread, NULL if stopped
+  Supervisor *m_plant;              // layout-only supervisor drawing the frames, NULL if stopped
+  QThread m_simThread;              // simulation thread
+  int m_wholeWidthPixels;           // work area width the layout is fitted to
+  double m_zoom;                    // canvas zoom factor
+  qint64 m_frameSeq;                // number of the shown frame, 0 before the first one
+  qint64 m_frameTime;               // simulation time of the shown frame (ms)
+  StateHistory m_history;           // recorded plant states for the timeline
+  qint64 m_nextSnapshot;            // simulation time of the next recorded state (ms)
+  int m_replayIndex;                // shown history state, -1 if the live plant is shown
+  QVector<qint32> m_replayState;    // shown history state
+};
+
+#endif
@@ -0,0 +1,65 @@
+#ifndef PRIOHEAP_H
+#define PRIOHEAP_H
+
+#include <QVector>
+//_________________________________________________________
+//
+// Template class represents the binary min-heap on the array. Items
+// are compared by operator<, the least one is on top. Push and pop
+// are O(log n). Removal is lazy: the owner drops outdated items
+// when they reach the top.
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+template<class T> class PriorityHeap
+{
+public:
+  bool isEmpty() const {return m_items.isEmpty();}
+  int size() const {return m_items.size();}
+  const T &top() const {return m_items.first();}
+  void clear() {m_items.clear();}
+
+  //_________________________________________________________
+  //
+  // Add the item and move it up to its place
+  //- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+  void push(const T &item)
+  {
+    int i = m_items.size();
+    m_items.append(item);
+    while (i > 0)
+    {
+      int parent = (i - 1) >> 1;
+      if (!(m_items[i] < m_items[parent])) break;
+      qSwap(m_items[i], m_items[parent]);
+      i = parent;
+    }
+  }
+  //_________________________________________________________
+  //
+  // Remove the top item, the last one sinks down from the top
+  //- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+  T pop()
+  {
+    T item = m_items.first();
+    m_items[0] = m_items.last();
+    m_items.removeLast();
+    int count = m_items.size();
+    int i = 0;
+    for(;;)
+    {
+      int least = i;
+      int left = (i << 1) + 1;
+      int right = left + 1;
+      if (left < count && m_items[left] < m_items[least]) least = left;
+      if (right < count && m_items[right] < m_items[least]) least = right;
+      if (least == i) break;
+      qSwap(m_items[i], m_items[least]);
+      i = least;
+    }
+    return item;
+  }
+
+private:
+  QVector<T> m_items;   // heap ordered items, the least one first
+};
+
+#endif
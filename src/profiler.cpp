@@ -0,0 +1,220 @@
+#include <QVBoxLayout>
+#include "profiler.h"
+
+const int sampleResolution = 1000;    // default time latency for panel refresh
+//_________________________________________________________
+//
+// Return the counter by name. Create it if necessary
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ProfileCounter *ProfileRegistry::counter(const QString &name)
+{
+  QMutexLocker locker(&lock());
+  foreach(ProfileCounter *it, counters())
+  {
+    if (it->name == name)
+      return it;
+  }
+  ProfileCounter *item = new ProfileCounter();
+  item->name = name;
+  item->calls = 0;
+  counters().append(item);
+  return item;
+}
+//_________________________________________________________
+//
+// Return the list of all registered counters
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+QList<ProfileCounter *> &ProfileRegistry::counters()
+{
+  static QList<ProfileCounter *> items;
+  return items;
+}
+//_________________________________________________________
+//
+// Return the lock of all counters. The owner may lock it again
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+QMutex &ProfileRegistry::lock()
+{
+  static QMutex mutex(QMutex::Recursive);
+  return mutex;
+}
+//_________________________________________________________
+//
+// Convert counters into samples for the interval and reset them
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void ProfileRegistry::sample(qint64 intervalNs, QList<ProfileSample> &samples)
+{
+  QMutexLocker locker(&lock());
+  samples.clear();
+  if (intervalNs <= 0) return;
+  foreach(ProfileCounter *it, counters())
+  {
+    ProfileSample item;
+    item.name = it->name;
+    item.callsPerSec = it->calls * 1000000000.0 / intervalNs;
+    item.meanNs = it->durations.mean();
+    item.p99Ns = it->durations.percentile(0.99);
+    item.frameShare = it->durations.sum() * 100.0 / intervalNs;
+    samples.append(item);
+  }
+  reset();
+}
+//_________________________________________________________
+//
+// Reset all counters
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void ProfileRegistry::reset()
+{
+  QMutexLocker locker(&lock());
+  foreach(ProfileCounter *it, counters())
+  {
+    it->calls = 0;
+    it->durations.reset();
+  }
+}
+//==========================================================
+//_________________________________________________________
+//
+// Object constructor.
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ProfilerTableView::ProfilerTableView(QObject *parent /*=0*/) :
+  QAbstractTableModel(parent)
+{
+
+}
+//_________________________________________________________
+//
+// Object destructor.
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ProfilerTableView::~ProfilerTableView()
+{
+}
+//_________________________________________________________
+
+int ProfilerTableView::rowCount(const QModelIndex &parent) const
+{
+  Q_UNUSED(parent);
+  return m_items.size();
+}
+//_________________________________________________________
+
+int ProfilerTableView::columnCount(const QModelIndex &parent) const
+{
+  Q_UNUSED(parent);
+  return 5;
+}
+//_________________________________________________________
+//
+// Return item for the table view
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+QVariant ProfilerTableView::data(const QModelIndex &index, int role) const
+{
+  if (!index.isValid())
+    return QVariant();
+  if (role == Qt::TextAlignmentRole)
+    return index.column() == 0 ? Qt::AlignLeft : Qt::AlignRight;
+
+  if (role != Qt::DisplayRole)
+    return QVariant();
+
+  const ProfileSample &item = m_items.at(index.row());
+  switch (index.column())
+  {
+    case 0: return item.name;
+    case 1: return QString::number(item.callsPerSec, 'f', 1);
+    case 2: return QString::number(item.meanNs / 1000.0, 'f', 1);
+    case 3: return QString::number(item.p99Ns / 1000.0, 'f', 1);
+    case 4: return QString::number(item.frameShare, 'f', 2);
+    default: return QVariant();
+  };
+}
+//_________________________________________________________
+//
+// Return item header for the table view
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+QVariant ProfilerTableView::headerData(int section, Qt::Orientation orientation, int role) const
+{
+  if (orientation != Qt::Horizontal || role != Qt::DisplayRole)
+    return QVariant();
+  switch (section)
+  {
+    case 0: return "Scope";
+    case 1: return "Calls/sec";
+    case 2: return "Mean(us)";
+    case 3: return "p99(us)";
+    case 4: return "Frame(%)";
+    default: return QVariant();
+  }
+}
+//==========================================================
+//_________________________________________________________
+//
+// Object constructor. Set common styles and resize the control
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ProfilerPanel::ProfilerPanel(QWidget *parent /*=0*/): QDialog(parent)
+{
+  setWindowTitle("Profiler");
+  setMinimumSize(300, 200);
+  resize(500, 325);
+
+  m_table = new QTableView();
+  m_table->setModel(&m_profilerView);
+
+  QVBoxLayout* pvbxLayout = new QVBoxLayout(this);
+  pvbxLayout->addWidget(m_table);
+
+  m_sample_timer = 0;
+  m_table->show();
+}
+//_________________________________________________________
+//
+// Object destructor.
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ProfilerPanel::~ProfilerPanel()
+{
+  if (m_table != NULL) delete m_table;
+}
+//_________________________________________________________
+//
+// Sample counters and refresh table view content
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void ProfilerPanel::refresh()
+{
+  ProfileRegistry::sample(m_interval.nsecsElapsed(), m_profilerView.getItems());
+  m_interval.restart();
+  m_profilerView.layoutChanged();
+}
+//_________________________________________________________
+//
+// Start sampling while the panel is visible
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void ProfilerPanel::showEvent(QShowEvent *se)
+{
+  Q_UNUSED(se)
+  ProfileRegistry::reset();
+  m_interval.start();
+  if (m_sample_timer == 0)
+    m_sample_timer = startTimer(sampleResolution);
+}
+//_________________________________________________________
+//
+// Stop sampling when the panel is hidden
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void ProfilerPanel::hideEvent(QHideEvent *he)
+{
+  Q_UNUSED(he)
+  if (m_sample_timer > 0)
+  {
+    killTimer(m_sample_timer);
+    m_sample_timer = 0;
+  }
+}
+//_________________________________________________________
+//
+// Event handler for timer counters
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void ProfilerPanel::timerEvent(QTimerEvent *te)
+{
+  if (te->timerId() == m_sample_timer)
+    refresh();
+}
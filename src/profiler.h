@@ -0,0 +1,122 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <QDialog>
+#include <QTableView>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QtGui>
+#include "histogram.h"
+
+// Scoped timers are compiled in only if SCIROCCO_PROFILE is defined (debug builds)
+#ifdef SCIROCCO_PROFILE
+#define PROFILE_CONCAT_IMPL(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_IMPL(a, b)
+#define PROFILE_SCOPE(name) \
+  static ProfileCounter *PROFILE_CONCAT(profileCounter, __LINE__) = ProfileRegistry::counter(name); \
+  ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(PROFILE_CONCAT(profileCounter, __LINE__))
+#else
+#define PROFILE_SCOPE(name)
+#endif
+
+// Counter of one instrumented scope
+struct ProfileCounter
+{
+  QString name;               // Scope name
+  qint64 calls;               // Calls amount since the last sample
+  Histogram durations;        // Call durations since the last sample (ns)
+
+  QString getId() {return name;}
+};
+// Sampled counter values for the panel
+struct ProfileSample
+{
+  QString name;               // Scope name
+  double callsPerSec;         // Calls per second
+  qint64 meanNs;              // Mean duration (ns)
+  qint64 p99Ns;               // 99th percentile duration (ns)
+  double frameShare;          // Share of the wall time spent in the scope (%)
+};
+//_________________________________________________________
+//
+// Class keeps all scope counters. Counters are created on the first use
+// and live until the application exits. Scopes of the simulation and
+// window threads update them under the registry lock
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+class ProfileRegistry
+{
+public:
+  static ProfileCounter *counter(const QString &name);
+  static QList<ProfileCounter *> &counters();
+  static void sample(qint64 intervalNs, QList<ProfileSample> &samples);
+  static void reset();
+  static QMutex &lock();
+};
+//_________________________________________________________
+//
+// Class measures the lifetime of the scope and adds it to the counter
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+class ProfileScope
+{
+public:
+  explicit ProfileScope(ProfileCounter *counter) : m_counter(counter) {m_timer.start();}
+  ~ProfileScope()
+  {
+    QMutexLocker locker(&ProfileRegistry::lock());
+    m_counter->calls++;
+    m_counter->durations.add(m_timer.nsecsElapsed());
+  }
+
+private:
+  ProfileCounter *m_counter;  // counter to update
+  QElapsedTimer m_timer;      // scope timer
+};
+//_________________________________________________________
+//
+// Class represents the table view for profile samples
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+class ProfilerTableView : public QAbstractTableModel
+{
+  Q_OBJECT
+public:
+
+  explicit ProfilerTableView(QObject *parent = 0);
+  virtual ~ProfilerTableView();
+
+  int rowCount(const QModelIndex &parent) const Q_DECL_OVERRIDE;
+  int columnCount(const QModelIndex &parent) const Q_DECL_OVERRIDE;
+
+  QVariant data(const QModelIndex &index, int role) const Q_DECL_OVERRIDE;
+  QVariant headerData(int section, Qt::Orientation orientation, int role) const Q_DECL_OVERRIDE;
+
+  QList<ProfileSample> &getItems() {return m_items;}
+
+private:
+  QList<ProfileSample> m_items;
+};
+//_________________________________________________________
+//
+// Class represents the live counters window.
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+class ProfilerPanel : public QDialog
+{
+  Q_OBJECT
+public:
+  explicit ProfilerPanel(QWidget *parent = 0);
+  virtual ~ProfilerPanel();
+
+  void refresh();
+
+protected:
+  virtual void timerEvent(QTimerEvent *);
+  virtual void showEvent(QShowEvent *);
+  virtual void hideEvent(QHideEvent *);
+
+private:
+  QTableView *m_table;
+  ProfilerTableView m_profilerView;
+  QElapsedTimer m_interval;   // wall time since the last sample
+  int m_sample_timer;         // sample timer id
+};
+
+#endif
@@ -6,11 +6,33 @@ HEADERS       = mainwindow.h \
     spooler.h \
     doffer.h \
     anim.h \
+    plantitem.h \
     sleever.h \
     man.h \
     locator.h \
     logger.h \
-    supervisor.h
+    supervisor.h \
+    histogram.h \
+    profiler.h \
+    tracer.h \
+    kpi.h \
+    history.h \
+    syncworker.h \
+    triplebuffer.h \
+    dispatchbench.h \
+    kinematics.h \
+    prioheap.h \
+    planner.h \
+    track.h \
+    mandispatch.h \
+    manbench.h \
+    forecast.h \
+    startplan.h \
+    analyser.h \
+    failure.h \
+    simclock.h \
+    headless.h \
+    plantview.h
 SOURCES       = mainwindow.cpp \
                 main.cpp \
     invdatabase.cpp \ 
@@ -18,11 +40,34 @@ SOURCES       = mainwindow.cpp \
     spooler.cpp \
     doffer.cpp \
     anim.cpp \
+    plantitem.cpp \
     sleever.cpp \
     man.cpp \
     locator.cpp \
     logger.cpp \
-    supervisor.cpp
+    supervisor.cpp \
+    histogram.cpp \
+    profiler.cpp \
+    tracer.cpp \
+    kpi.cpp \
+    history.cpp \
+    syncworker.cpp \
+    dispatchbench.cpp \
+    kinematics.cpp \
+    planner.cpp \
+    track.cpp \
+    mandispatch.cpp \
+    manbench.cpp \
+    forecast.cpp \
+    startplan.cpp \
+    analyser.cpp \
+    failure.cpp \
+    simclock.cpp \
+    headless.cpp \
+    plantview.cpp
+
+# scoped profiling counters are compiled in for debug builds only
+CONFIG(debug, debug|release): DEFINES += SCIROCCO_PROFILE
 
 # install
 #target.path = $$[QT_INSTALL_EXAMPLES]/widgets/mainwindows/menus
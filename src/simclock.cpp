@@ -0,0 +1,111 @@
+#include <QTimerEvent>
+#include "simclock.h"
+
+const int firstTimerId = 0x40000000;  // timer ids are above the event loop ones, an object may run both
+
+bool SimClock::m_running = false;
+qint64 SimClock::m_now = 0;
+qint64 SimClock::m_seq = 0;
+int SimClock::m_nextId = firstTimerId;
+QHash<int, SimClock::Timer> SimClock::m_timers;
+PriorityHeap<SimClock::Event> SimClock::m_events;
+//_________________________________________________________
+//
+// Start the new session at time zero
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void SimClock::start()
+{
+  m_timers.clear();
+  m_events.clear();
+  m_now = 0;
+  m_seq = 0;
+  m_nextId = firstTimerId;
+  m_running = true;
+}
+//_________________________________________________________
+//
+// Stop the session and drop all timers. The time is kept for
+// the final reports
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void SimClock::stop()
+{
+  m_running = false;
+  m_timers.clear();
+  m_events.clear();
+}
+//_________________________________________________________
+//
+// Advance the running clock by the tick (ms)
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void SimClock::advance(qint64 delta)
+{
+  if (delta > 0)
+    advanceTo(m_now + delta);
+}
+//_________________________________________________________
+//
+// Deliver timer events which are due until the time in the due
+// order and leave the clock at the time. Periodic timers are due
+// again before their event is delivered, so the handler may kill
+// or restart them
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void SimClock::advanceTo(qint64 time)
+{
+  while (m_running && !m_events.isEmpty() && m_events.top().due <= time)
+  {
+    Event event = m_events.pop();
+    QHash<int, Timer>::const_iterator it = m_timers.constFind(event.id);
+    if (it == m_timers.constEnd())
+      continue;
+    QObject *target = it->target;
+    m_now = qMax(m_now, event.due);
+    event.due += qMax(it->interval, 1);
+    event.seq = m_seq++;
+    m_events.push(event);
+
+    // the direct call skips the application notify, plant objects
+    // have no event filters
+    QTimerEvent te(event.id);
+    target->event(&te);
+  }
+  if (m_running && time > m_now)
+    m_now = time;
+}
+//_________________________________________________________
+//
+// Return the time of the next due event, -1 if there are no timers
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+qint64 SimClock::nextDue()
+{
+  while (!m_events.isEmpty() && !m_timers.contains(m_events.top().id))
+    m_events.pop();
+  return m_events.isEmpty() ? -1 : m_events.top().due;
+}
+//_________________________________________________________
+//
+// Start the periodic timer of the object, the first event is due
+// after the interval. Return the timer id for timerEvent()
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+int SimClock::startTimer(QObject *target, int interval)
+{
+  Timer timer;
+  timer.target = target;
+  timer.interval = interval;
+  int id = m_nextId++;
+  m_timers.insert(id, timer);
+
+  Event event;
+  event.due = m_now + qMax(interval, 0);
+  event.seq = m_seq++;
+  event.id = id;
+  m_events.push(event);
+  return id;
+}
+//_________________________________________________________
+//
+// Kill the timer, its pending event is dropped
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void SimClock::killTimer(int id)
+{
+  m_timers.remove(id);
+}
@@ -0,0 +1,56 @@
+#ifndef SIMCLOCK_H
+#define SIMCLOCK_H
+
+#include <QObject>
+#include <QHash>
+#include "prioheap.h"
+//_________________________________________________________
+//
+// Class keeps the simulation session clock and the timers of the
+// plant. The clock is not read from the wall clock, the driver
+// advances it and due timer events are delivered in the due time
+// order with the clock set to their due time. The live plant is
+// advanced tick by tick, the headless run jumps from one due event
+// to the next, so both runs give the same results for the seed.
+// Time is the session clock time, i.e. model time divided by the
+// time coefficient, as timer periods are (ms)
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+class SimClock
+{
+public:
+  static void start();
+  static void stop();
+  static bool isRunning() {return m_running;}
+  static qint64 now() {return m_now;}
+  static void advance(qint64 delta);
+  static void advanceTo(qint64 time);
+  static qint64 nextDue();
+
+  static int startTimer(QObject *target, int interval);
+  static void killTimer(int id);
+
+private:
+  // Running timer
+  struct Timer
+  {
+    QObject *target;    // timer event receiver
+    int interval;       // timer period (ms)
+  };
+  // Due timer event
+  struct Event
+  {
+    qint64 due;         // session clock time of the event (ms)
+    qint64 seq;         // scheduling order number, events of the same time keep it
+    int id;             // timer id
+    bool operator<(const Event &other) const {return due < other.due || (due == other.due && seq < other.seq);}
+  };
+
+  static bool m_running;                // true while the session runs
+  static qint64 m_now;                  // session clock time (ms)
+  static qint64 m_seq;                  // next event order number
+  static int m_nextId;                  // next timer id
+  static QHash<int, Timer> m_timers;    // running timers by id
+  static PriorityHeap<Event> m_events;  // due events, events of killed timers are dropped on the top
+};
+
+#endif
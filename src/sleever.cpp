@@ -1,14 +1,18 @@
 #include "supervisor.h"
 #include "winder.h"
 #include "sleever.h"
+#include "profiler.h"
+#include "tracer.h"
+#include "simclock.h"
 
 const int timerResolution = 70;     // default tick latency for timers
+const char *const statusNames[] = {"IDLE", "BUSY", "READY", "EMPTY", "PREPARING", "WAIT"};   // status names for the trace
 
 //_________________________________________________________
 //
 // Object constructor. Set parameters from model, count max brake distance as extraWidth
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-Sleever::Sleever(SleeverModel &model, QWidget *parent /*=0*/) :
+Sleever::Sleever(SleeverModel &model, QObject *parent /*=0*/) :
   Locator(parent)
 {
   // count extra width and drawing control sizes
@@ -22,13 +26,13 @@ Sleever::Sleever(SleeverModel &model, QWidget *parent /*=0*/) :
   m_timePutDown = model.timePutDown;
   m_timePrepare = model.prepare;
   m_id = model.idSleever;
+  m_kind = SLEEVER;
   m_speed = supervisor->toPixels(model.speed);
   m_accel = supervisor->toPixels(model.acceleration);
   setInventory(model.sleeveSlots, model.rings);
 
   // set idle state
   m_status = IDLE;
-  m_anim = NULL;
 
   m_putres_timer = 0;
   m_prepare_timer = 0;
@@ -39,23 +43,19 @@ Sleever::Sleever(SleeverModel &model, QWidget *parent /*=0*/) :
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 Sleever::~Sleever()
 {
-  destroyAnimator();
 }
 //_________________________________________________________
 //
 // Draw the control content according to its state
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-void Sleever::paintEvent(QPaintEvent *pe)
+void Sleever::draw(QPainter &painter)
 {
-  Q_UNUSED(pe)
+  PROFILE_SCOPE("Sleever::draw");
 
   // get sizes and dimentions
-  QPainter painter;
   QRect srcRect = rect();
   QRect rct(srcRect.left(), srcRect.top(), srcRect.width(), srcRect.height());
 
-  // open drawing context
-  painter.begin(this);
   painter.setPen(QPen(Qt::white, 1, Qt::SolidLine));
 
   // draw background according to its state
@@ -85,9 +85,35 @@ void Sleever::paintEvent(QPaintEvent *pe)
                    .arg(m_id)
                    .arg(m_sleeves)
                    .arg(m_rings));
-
-  // close drawing context
-  painter.end();
+}
+//_________________________________________________________
+//
+// Append the compact state: position, status, sleeves and rings onboard
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Sleever::saveState(QVector<qint32> &state)
+{
+  Locator::saveState(state);
+  state.append(m_status);
+  state.append(m_sleeves);
+  state.append(m_rings);
+}
+//_________________________________________________________
+//
+// Return the amount of state words
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+int Sleever::stateSize()
+{
+  return Locator::stateSize() + 3;
+}
+//_________________________________________________________
+//
+// Swap drawing fields with the recorded ones
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Sleever::exchangeState(qint32 *state)
+{
+  exchangeField(m_status, state[0]);
+  exchangeField(m_sleeves, state[1]);
+  exchangeField(m_rings, state[2]);
 }
 //_________________________________________________________
 //
@@ -104,21 +130,21 @@ void Sleever::timerEvent(QTimerEvent* te)
     // count new coordinate for the animation depending on time left value
     m_timeLeft = m_timeLeft <= timerResolution ? 0 : (m_timeLeft - timerResolution);
     if (m_timeReach != 0)
-      delta = (m_timeReach - m_timeLeft) * (y() - m_anim->height() + height() - m_destY) / m_timeReach;
+      delta = (m_timeReach - m_timeLeft) * (y() - m_bobbinsSize.height() + height() - m_destY) / m_timeReach;
     // move animator widget
-    m_anim->move(pos().x(), y() - m_anim->height() + height() - delta);
+    moveAnimator(pos().x(), y() - m_bobbinsSize.height() + height() - delta);
     // if timer is over
     if (m_timeLeft == 0)
     {
-      // kill timer and destroy animator
-      killTimer(te->timerId());
+      // kill timer and stop animation
+      SimClock::killTimer(te->timerId());
       m_putres_timer = 0;
-      destroyAnimator();
+      hideAnimator();
       // update busy counter for the object
       updateLoggerItem(m_id, Logger::TIME_BUSY);
       // change status
       setStatus(m_sleeves > 0 ? PREPARING : EMPTY);
-      update();
+      refresh();
       // notify supervisor
       emit taskCompleted(m_session);
       if (m_status == EMPTY)
@@ -133,10 +159,10 @@ void Sleever::timerEvent(QTimerEvent* te)
   else if (te->timerId() == m_prepare_timer)
   {
     // kill timer and set sleever as idle
-    killTimer(te->timerId());
+    SimClock::killTimer(te->timerId());
     m_prepare_timer = 0;
     setStatus(IDLE);
-    update();
+    refresh();
   }
 }
 //_________________________________________________________
@@ -155,17 +181,17 @@ void Sleever::startMachine(OperFunc operation)
       break;
     case PUTRES:            // put sleeve action
       setStatus(BUSY);
-      update();
+      refresh();
       m_timeLeft = m_timePutDown;
       m_timeReach = m_timeLeft;
-      m_movement_timer = 0;
+      haltMovement();
       m_prepare_timer = 0;
-      m_putres_timer = startTimer(timerResolution);
+      m_putres_timer = SimClock::startTimer(this, timerResolution);
       break;
     case PREPARE:         // preparing action
       m_timeLeft = m_timePrepare;
       m_putres_timer = 0;
-      m_prepare_timer = startTimer(m_timePrepare);
+      m_prepare_timer = SimClock::startTimer(this, m_timePrepare);
       break;
     default:
       break;
@@ -177,7 +203,12 @@ void Sleever::startMachine(OperFunc operation)
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void Sleever::setStatus(Status state)
 {
+  Status prevStatus = m_status;
   m_status = state;
+  TraceRecorder::setStatus(m_id, statusNames[state]);
+  // notify supervisor
+  if (prevStatus != state)
+    emit statusChanged(m_id, prevStatus, state);
 }
 //_________________________________________________________
 //
@@ -193,8 +224,8 @@ void Sleever::putResult(QString idSession, int sleeves, int rings)
   m_rings -= rings;
   // set session
   m_session = idSession;
-  // create animator
-  createAnimator(sleeves == 1 ? Animator::SLEEVE1 : Animator::SLEEVE2);
+  // start animation
+  showAnimator(sleeves == 1 ? Animator::SLEEVE1 : Animator::SLEEVE2, getDestX(), y() - m_bobbinsSize.height() + height());
 
   // update idle counter for the object
   updateLoggerItem(m_id, Logger::TIME_IDLE);
@@ -212,35 +243,6 @@ void Sleever::setInventory(int sleeves, int rings)
 }
 //_________________________________________________________
 //
-// Create animator widget
-//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-void Sleever::createAnimator(Animator::Type type)
-{
-  // if already exists, destroy animator
-  destroyAnimator();
-  // create widget and set its position
-  m_anim = new Animator(type, m_bobbinsSize.width(), m_bobbinsSize.height(), parentWidget());
-  m_anim->move(m_destX, y() - m_anim->height() + height());
-  // show widget
-  m_anim->show();
-}
-//_________________________________________________________
-//
-// Destroy animator widget
-//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-void Sleever::destroyAnimator()
-{
-  // if animation exists
-  if (m_anim != NULL)
-  {
-    // destroy it
-    m_anim->hide();
-    delete m_anim;
-  }
-  m_anim = NULL;
-}
-//_________________________________________________________
-//
 // Public action method for reaching
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void Sleever::reachObject(QString idSession, int x, int y, bool doEmit /* = true*/)
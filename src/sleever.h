@@ -1,7 +1,6 @@
 #ifndef SLEEVER_H
 #define SLEEVER_H
 
-#include <QFrame>
 #include <QtGui>
 #include "anim.h"
 #include "locator.h"
@@ -31,8 +30,11 @@ public:
     PUTRES,           // put sleeve
     PREPARE           // prepare the new one
   };
-  explicit Sleever(SleeverModel &model, QWidget *parent = 0);
+  explicit Sleever(SleeverModel &model, QObject *parent = 0);
   virtual ~Sleever();
+  virtual void draw(QPainter &painter);
+  virtual void saveState(QVector<qint32> &state);
+  virtual int stateSize();
 
   Status getStatus() {return m_status;}
   int getSleeves() {return m_sleeves;}
@@ -45,6 +47,7 @@ public:
   virtual void reachObject(QString idSession, int x, int y, bool doEmit = true);
 
 signals:
+  void statusChanged(QString idObject, int prevStatus, int status);
   void taskCompleted(QString);
   void emptySleever(QString idSleever);
 
@@ -52,12 +55,10 @@ public slots:
 
 protected:
   virtual void timerEvent(QTimerEvent *);
-  virtual void paintEvent(QPaintEvent *);
+  virtual void exchangeState(qint32 *state);
 
 private:
   void startMachine(OperFunc operation);
-  void createAnimator(Animator::Type);
-  void destroyAnimator();
 
   Status m_status;              // current sleever status
   int m_timePutDown;            // time setting for putting sleeve process
@@ -65,8 +66,6 @@ private:
   int m_sleeves;                // amount of sleeves onboard
   int m_rings;                  // amount of rings onboard
 
-  Animator *m_anim;             // animator reference
-
   int m_putres_timer;           // timer id for putting sleeve process
   int m_prepare_timer;          // timer id for prepare sleeve process
 };
@@ -1,31 +1,33 @@
 #include "supervisor.h"
 #include "spooler.h"
+#include "profiler.h"
 
 const int controlTitle = 20;    // spooler caption height
+const QColor spoolColor(175, 177, 184);   // installed bobbin color
+const QColor backColor(95, 178, 150);     // spool front color
+const int cellsPerWord = 16;              // cells packed into one state word
 //_________________________________________________________
 //
-// Object constructor. Set parameters from model, common styles and sizes
+// Object constructor. Set parameters and sizes from model
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-Spooler::Spooler(SpoolerModel &model, QWidget *parent /*=0*/) :
-  QFrame(parent)
+Spooler::Spooler(SpoolerModel &model, QObject *parent /*=0*/) :
+  PlantItem(parent)
 {
-  setLineWidth(1);
-  setFrameStyle(NoFrame | Plain);
-  setSizePolicy(QSizePolicy::Fixed, QSizePolicy::Fixed);
-
   // init params from database model
   m_id = model.idSpooler;
   m_rows = model.rows;
   m_columns = model.columns;
   m_isDoubleSided = model.isDoubleSided;
 
-  // convert cell width and resize the widget
+  // convert cell width and resize the control
   Supervisor *supervisor = (Supervisor *)parent;
   cellWidth = supervisor->toPixels(model.cellWidth);
   resize(cellWidth * m_columns, cellWidth * m_rows + controlTitle);
 
   // set spooler in progress
   m_status = PROGRESS;
+  m_layerValid = false;
+  m_recipeNames = NULL;
   createItems();
 }
 //_________________________________________________________
@@ -38,23 +40,123 @@ int Spooler::getCellWidth()
 }
 //_________________________________________________________
 //
-// Draw the control content according to its state
+// Draw the control content. The content is cached in the layer
+// pixmap, it is rendered completely after status or side changes
+// and cell by cell after reservations and putdowns
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Spooler::draw(QPainter &painter)
+{
+  PROFILE_SCOPE("Spooler::draw");
+
+  if (!m_layerValid || m_layer.size() != size())
+    renderLayer();
+  else if (!m_changedCells.isEmpty())
+    renderCells();
+  painter.drawPixmap(0, 0, m_layer);
+}
+//_________________________________________________________
+//
+// Draw the simplified control: fill bar of the active side
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Spooler::drawGlyph(QPainter &painter)
+{
+  QRect rct = rect();
+  painter.fillRect(rct, QBrush(Qt::gray, Qt::SolidPattern));
+  if (m_status == BUSY) return;
+
+  // count installed bobbins
+  int filled = 0;
+  for(int i = 0; i < m_items[m_activeSide].size(); i++)
+    filled += m_items[m_activeSide][i].count(CELLBUSY);
+
+  // the bar grows from the bottom
+  int cells = m_rows * m_columns;
+  int barHeight = cells > 0 ? rct.height() * filled / cells : 0;
+  painter.fillRect(QRect(rct.left(), rct.bottom() - barHeight + 1, rct.width(), barHeight), QBrush(backColor, Qt::SolidPattern));
+}
+//_________________________________________________________
+//
+// Append the compact state: position, status, active side, recipe
+// number and cells of both sides packed by 2 bits
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Spooler::saveState(QVector<qint32> &state)
+{
+  PlantItem::saveState(state);
+  state.append(m_status);
+  state.append(m_activeSide);
+  state.append(m_recipeNames != NULL ? m_recipeNames->indexOf(m_recipe) : -1);
+
+  int start = state.size();
+  state.resize(start + (2 * m_rows * m_columns + cellsPerWord - 1) / cellsPerWord);
+  for(int i = start; i < state.size(); i++)
+    state[i] = 0;
+
+  int cell = 0;
+  for(int side = 0; side < 2; side++)
+    for(int i = 0; i < m_rows; i++)
+      for(int j = 0; j < m_columns; j++, cell++)
+        state[start + cell / cellsPerWord] |= m_items[side][i][j] << (2 * (cell % cellsPerWord));
+}
+//_________________________________________________________
+//
+// Return the amount of state words
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+int Spooler::stateSize()
+{
+  return PlantItem::stateSize() + 3 + (2 * m_rows * m_columns + cellsPerWord - 1) / cellsPerWord;
+}
+//_________________________________________________________
+//
+// Swap drawing fields and cells with the recorded ones. The layer
+// is rendered again for both recorded and live state
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Spooler::exchangeState(qint32 *state)
+{
+  exchangeField(m_status, state[0]);
+  exchangeField(m_activeSide, state[1]);
+
+  // the recipe is recorded by its number in the plant recipe list
+  int recipe = state[2];
+  state[2] = m_recipeNames != NULL ? m_recipeNames->indexOf(m_recipe) : -1;
+  if (m_recipeNames != NULL && recipe >= 0 && recipe < m_recipeNames->size())
+    m_recipe = m_recipeNames->at(recipe);
+  else
+    m_recipe.clear();
+
+  qint32 *cells = state + 3;
+  int words = (2 * m_rows * m_columns + cellsPerWord - 1) / cellsPerWord;
+  QVector<qint32> live(words, 0);
+  int cell = 0;
+  for(int side = 0; side < 2; side++)
+    for(int i = 0; i < m_rows; i++)
+      for(int j = 0; j < m_columns; j++, cell++)
+      {
+        int shift = 2 * (cell % cellsPerWord);
+        live[cell / cellsPerWord] |= m_items[side][i][j] << shift;
+        m_items[side][i][j] = (CellStatus)((cells[cell / cellsPerWord] >> shift) & 3);
+      }
+  for(int i = 0; i < words; i++)
+    cells[i] = live[i];
+
+  m_layerValid = false;
+}
+//_________________________________________________________
+//
+// Render the whole layer according to the state
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-void Spooler::paintEvent(QPaintEvent *pe)
+void Spooler::renderLayer()
 {
-  Q_UNUSED(pe)
+  PROFILE_SCOPE("Spooler::renderLayer");
 
   QPainter painter;
   QRect rct = rect();
   QRect spoolRct = rect();
 
-  QColor spoolColor(175, 177, 184);
-  QColor backColor(95, 178, 150);
-
   // calculate spool rectangle
   spoolRct.setTop(rct.top() + controlTitle);
-  // open drawing context
-  painter.begin(this);
+
+  m_layer = QPixmap(size());
+  painter.begin(&m_layer);    // open drawing context
 
   // fill background
   painter.fillRect(rct, QBrush(Qt::gray, Qt::SolidPattern));
@@ -62,13 +164,12 @@ void Spooler::paintEvent(QPaintEvent *pe)
 
   // draw caption
   painter.setPen(QPen(Qt::white, 1, Qt::SolidLine));
+  QString caption = m_id;
   if (m_isDoubleSided)
-    painter.drawText(rct.left() + 5, 15, QString("%1: side %2").arg(m_id).arg(m_activeSide + 1));
-  else
-    painter.drawText(rct.left() + 5, 15, QString("%1").arg(m_id));
-
-  int ht = cellWidth;
-  QSize cellSize(ht, ht);
+    caption += QString(": side %1").arg(m_activeSide + 1);
+  if (!m_recipe.isEmpty())
+    caption += QString(" [%1]").arg(m_recipe);
+  painter.drawText(rct.left() + 5, 15, caption);
 
   // draw front and cells according to their state
   switch(m_status)
@@ -78,30 +179,8 @@ void Spooler::paintEvent(QPaintEvent *pe)
       for(int i = 0; i < m_items[m_activeSide].size(); i++)
       {
         for(int j = 0; j < m_items[m_activeSide][i].size(); j++)
-        {
-          QPoint cellPoint(j * ht, i * ht + controlTitle);
-          CellStatus status = m_items[m_activeSide][i][j];
-          QRect cellRect(cellPoint, cellSize);
-
-          switch(status)
-          {
-            case CELLBUSY:
-              painter.setBrush(QBrush(spoolColor, Qt::SolidPattern));
-              painter.drawEllipse(QPoint(cellPoint.x() + (cellSize.width() >> 1), cellPoint.y() + (cellSize.height() >> 1)), ht / 3, ht / 3);
-              painter.setBrush(QBrush(backColor, Qt::SolidPattern));
-              painter.drawEllipse(QPoint(cellPoint.x() + (cellSize.width() >> 1), cellPoint.y() + (cellSize.height() >> 1)), 3, 3);
-              break;
-            case RESERVED:
-              painter.drawText(cellRect, Qt::AlignHCenter | Qt::AlignCenter, "R");
-              break;
-
-            case FREE:
-            default:
-              break;
-          }
-        }
+          drawCell(painter, i, j);
       }
-
       break;
     case BUSY:
       painter.fillRect(spoolRct, QBrush(Qt::black, Qt::Dense5Pattern));
@@ -113,7 +192,79 @@ void Spooler::paintEvent(QPaintEvent *pe)
 
   }
 
-  painter.end();
+  painter.end();              // close drawing context
+  m_layerValid = true;
+  m_changedCells.clear();
+}
+//_________________________________________________________
+//
+// Render changed cells only. Cells are hidden in busy state
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Spooler::renderCells()
+{
+  QPainter painter;
+  int ht = cellWidth;
+
+  if (m_status != BUSY)
+  {
+    painter.begin(&m_layer);    // open drawing context
+    painter.setPen(QPen(Qt::white, 1, Qt::SolidLine));
+    foreach(const QPoint &cell, m_changedCells)
+    {
+      // clean up the cell and draw its new state
+      painter.fillRect(QRect(cell.y() * ht, cell.x() * ht + controlTitle, ht, ht), QBrush(backColor, Qt::SolidPattern));
+      drawCell(painter, cell.x(), cell.y());
+    }
+    painter.end();              // close drawing context
+  }
+  m_changedCells.clear();
+}
+//_________________________________________________________
+//
+// Draw the cell of the active side at row and column position
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Spooler::drawCell(QPainter &painter, int row, int column)
+{
+  int ht = cellWidth;
+  QSize cellSize(ht, ht);
+  QPoint cellPoint(column * ht, row * ht + controlTitle);
+  CellStatus status = m_items[m_activeSide][row][column];
+  QRect cellRect(cellPoint, cellSize);
+
+  switch(status)
+  {
+    case CELLBUSY:
+      painter.setBrush(QBrush(spoolColor, Qt::SolidPattern));
+      painter.drawEllipse(QPoint(cellPoint.x() + (cellSize.width() >> 1), cellPoint.y() + (cellSize.height() >> 1)), ht / 3, ht / 3);
+      painter.setBrush(QBrush(backColor, Qt::SolidPattern));
+      painter.drawEllipse(QPoint(cellPoint.x() + (cellSize.width() >> 1), cellPoint.y() + (cellSize.height() >> 1)), 3, 3);
+      break;
+    case RESERVED:
+      painter.drawText(cellRect, Qt::AlignHCenter | Qt::AlignCenter, "R");
+      break;
+
+    case FREE:
+    default:
+      break;
+  }
+}
+//_________________________________________________________
+//
+// Mark the cell to render it with the next frame
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Spooler::cellChanged(int row, int column)
+{
+  m_changedCells.append(QPoint(row, column));
+  refresh();
+}
+//_________________________________________________________
+//
+// Mark the whole layer to render it with the next frame
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Spooler::layerChanged()
+{
+  m_layerValid = false;
+  refresh();
 }
 //_________________________________________________________
 //
@@ -121,6 +272,8 @@ void Spooler::paintEvent(QPaintEvent *pe)
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void Spooler::setStatus(Status state)
 {
+  if (m_status != state)
+    layerChanged();
   m_status = state;
 }
 //_________________________________________________________
@@ -134,9 +287,13 @@ void Spooler::replace()
   // otherwise reinit spooler
 
   if (isAbleToRotate())
+  {
     m_activeSide++;
+    resetCells();
+  }
   else
     createItems();
+  layerChanged();
 }
 //_________________________________________________________
 //
@@ -155,6 +312,7 @@ void Spooler::createItems()
     m_items[0].append(row);
     m_items[1].append(row);
   }
+  resetCells();
 }
 //_________________________________________________________
 //
@@ -165,29 +323,47 @@ void Spooler::clearItems()
   m_items[0].clear();
   m_items[1].clear();
   m_activeSide = 0;
+  resetCells();
 }
 //_________________________________________________________
 //
-// Reserve the cell method. Cell will be returned as (x, y) row-column positions
+// Make all cells of the active side free and release the recipe.
+// Cells are taken from the stack top in the row-column order
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-bool Spooler::reserve(int &x, int &y)
+void Spooler::resetCells()
 {
-  // for each cell check if it's free and if so mark it as reserved
-  for(int i = 0; i < m_items[m_activeSide].size(); i++)
+  m_freeCells.clear();
+  if (!m_items[m_activeSide].isEmpty())
+    for(int cell = m_rows * m_columns - 1; cell >= 0; cell--)
+      m_freeCells.append(cell);
+  m_busyCells = 0;
+  m_recipe.clear();
+}
+//_________________________________________________________
+//
+// Reserve the cell method. Cell will be returned as (x, y) row-column positions.
+// The side is dedicated to the recipe of its first reservation, the cell
+// is refused if the side is full or dedicated to another recipe
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool Spooler::reserve(const QString &idRecipe, int &x, int &y)
+{
+  if (m_freeCells.isEmpty()) return false;
+  if (!m_recipe.isEmpty() && m_recipe != idRecipe) return false;
+
+  // take the next free cell and mark it as reserved
+  int cell = m_freeCells.last();
+  m_freeCells.removeLast();
+  x = cell / m_columns;
+  y = cell % m_columns;
+  m_items[m_activeSide][x][y] = RESERVED;
+  cellChanged(x, y);
+
+  if (m_recipe != idRecipe)
   {
-    for(int j = 0; j < m_items[m_activeSide][i].size(); j++)
-    {
-      if (m_items[m_activeSide][i][j] == FREE)
-      {
-        x = i;
-        y = j;
-        m_items[m_activeSide][i][j] = RESERVED;
-        update();
-        return true;
-      }
-    }
+    m_recipe = idRecipe;
+    layerChanged();
   }
-  return false;
+  return true;
 }
 //_________________________________________________________
 //
@@ -198,7 +374,14 @@ bool Spooler::cancelReserve(int x, int y)
   if (m_items[m_activeSide][x][y] == RESERVED)
   {
     m_items[m_activeSide][x][y] = FREE;
-    update();
+    m_freeCells.append(x * m_columns + y);
+    cellChanged(x, y);
+    // release the recipe if the side is empty again
+    if (m_freeCells.size() == m_rows * m_columns && !m_recipe.isEmpty())
+    {
+      m_recipe.clear();
+      layerChanged();
+    }
     return true;
   }
   return false;
@@ -210,8 +393,14 @@ bool Spooler::cancelReserve(int x, int y)
 void Spooler::putdown(int x, int y)
 {
   if (x >= m_rows || y >= m_columns) return;
-  m_items[m_activeSide][x][y] = CELLBUSY;
-  update();
+  CellStatus &status = m_items[m_activeSide][x][y];
+  // the cell is normally reserved, a free one leaves the stack
+  if (status == FREE)
+    m_freeCells.remove(m_freeCells.indexOf(x * m_columns + y));
+  if (status != CELLBUSY)
+    m_busyCells++;
+  status = CELLBUSY;
+  cellChanged(x, y);
   // notify supervisor if spooler active side is filled up
   if (isFilledUp())
     emit filledUp(m_id);
@@ -222,18 +411,7 @@ void Spooler::putdown(int x, int y)
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 bool Spooler::isFilledUp()
 {
-  for(int i = 0; i < m_items[m_activeSide].size(); i++)
-  {
-    for(int j = 0; j < m_items[m_activeSide][i].size(); j++)
-    {
-        if (m_items[m_activeSide][i][j] == FREE ||
-            m_items[m_activeSide][i][j] == RESERVED)
-        {
-          return false;
-        }
-    }
-  }
-  return true;
+  return m_busyCells == m_rows * m_columns;
 }
 //_________________________________________________________
 //
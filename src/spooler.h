@@ -1,14 +1,14 @@
 #ifndef SPOOLER_H
 #define SPOOLER_H
 
-#include <QFrame>
 #include <QtGui>
+#include "plantitem.h"
 #include "invdatabase.h"
 //_________________________________________________________
 //
 // Class represents spooler widget.
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-class Spooler : public QFrame
+class Spooler : public PlantItem
 {
   Q_OBJECT
 public:
@@ -27,15 +27,22 @@ public:
     RESERVED                  // cell is empty but has been reserved
   };
 
-  explicit Spooler(SpoolerModel &model, QWidget *parent = 0);
+  explicit Spooler(SpoolerModel &model, QObject *parent = 0);
+  virtual void draw(QPainter &painter);
+  virtual void drawGlyph(QPainter &painter);
+  virtual void saveState(QVector<qint32> &state);
+  virtual int stateSize();
 
   QString getId() {return m_id;}
+  QString getRecipe() {return m_recipe;}
   Status getStatus() {return m_status;}
+  int getFreeCells() {return m_freeCells.size();}
   void setStatus(Status state);
+  void setRecipeNames(const QStringList *names) {m_recipeNames = names;}
 
   int getCellWidth();
   void replace();
-  bool reserve(int &x, int &y);
+  bool reserve(const QString &idRecipe, int &x, int &y);
   bool cancelReserve(int x, int y);
   void putdown(int x, int y);
   bool isFilledUp();
@@ -47,11 +54,17 @@ signals:
 public slots:
 
 protected:
-  virtual void paintEvent(QPaintEvent *);
+  virtual void exchangeState(qint32 *state);
 
 private:
   void createItems();
   void clearItems();
+  void resetCells();
+  void renderLayer();
+  void renderCells();
+  void drawCell(QPainter &painter, int row, int column);
+  void cellChanged(int row, int column);
+  void layerChanged();
 
   Status m_status;                              // current spooler status
   int m_rows;                                   // rows amount
@@ -63,6 +76,14 @@ private:
   QString m_id;                                 // object id
   QVector< QVector<CellStatus> > m_items[2];    // array for spooler sides
   int m_activeSide;                             // active side index
+  QVector<int> m_freeCells;                     // free cells (row * columns + column) of the active side, the next one is on top
+  int m_busyCells;                              // installed bobbins on the active side
+  QString m_recipe;                             // recipe the active side is dedicated to, empty if not dedicated
+  const QStringList *m_recipeNames;             // recipe ids of the plant, the state keeps the recipe number
+
+  QPixmap m_layer;                              // cached spooler content
+  bool m_layerValid;                            // false if the whole layer should be rendered
+  QList<QPoint> m_changedCells;                 // cells (row, column) to render into the layer
 };
 
 #endif
@@ -0,0 +1,49 @@
+#include "startplan.h"
+//_________________________________________________________
+//
+// Count the start spacing and predict queue depths
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void StartPlanner::plan(const StartGroup &group)
+{
+  int spacing = group.service;
+  if (group.winders > 0 && (qint64)group.winders * group.service > group.cycle)
+    spacing = group.cycle / group.winders;
+  m_spacing = qMax(spacing, group.manStep);
+  m_peakBefore = peakQueue(group, group.manStep);
+  m_peakAfter = peakQueue(group, m_spacing);
+}
+//_________________________________________________________
+//
+// Predict the peak amount of winders waiting for the doffer or being
+// served, when winders are started with the spacing. Completions of
+// two cycles are served in the completion order
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+int StartPlanner::peakQueue(const StartGroup &group, int spacing)
+{
+  // the group is small, completions are sorted by the linear insertion
+  QVector<qint64> arrivals;
+  for(int round = 1; round <= 2; round++)
+    for(int i = 0; i < group.winders; i++)
+    {
+      qint64 at = (qint64)i * spacing + (qint64)round * group.cycle;
+      int pos = arrivals.size();
+      while (pos > 0 && arrivals[pos - 1] > at)
+        pos--;
+      arrivals.insert(pos, at);
+    }
+
+  QVector<qint64> finish;
+  int peak = 0;
+  for(int k = 0; k < arrivals.size(); k++)
+  {
+    qint64 begin = k > 0 ? qMax(arrivals[k], finish[k - 1]) : arrivals[k];
+    finish.append(begin + group.service);
+    // winders arrived and not served yet
+    int depth = 0;
+    for(int j = 0; j <= k; j++)
+      if (finish[j] > arrivals[k])
+        depth++;
+    peak = qMax(peak, depth);
+  }
+  return peak;
+}
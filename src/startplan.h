@@ -0,0 +1,52 @@
+#ifndef STARTPLAN_H
+#define STARTPLAN_H
+
+#include <QVector>
+#include <QString>
+// Doffer group parameters for the winder start plan
+struct StartGroup
+{
+  int winders;            // winders amount to start
+  int cycle;              // shortest winding cycle of the group winders (ms)
+  int service;            // doffer time per winder including carrier and sleever reloads (ms)
+  int manStep;            // time the man needs to start the next winder (ms)
+};
+// Winder start plan of the doffer group for run reports
+struct StartPlanReport
+{
+  QString idDoffer;       // doffer Id of the group
+  int winders;            // winders amount started
+  int spacing;            // start offset between the group winders (ms)
+  int peakBefore;         // predicted peak doffer queue depth without the plan
+  int peakAfter;          // predicted peak doffer queue depth with the plan
+
+  QString getId() {return idDoffer;}
+};
+//_________________________________________________________
+//
+// Class plans winder start offsets of one doffer group, so their
+// completions are spread over the winding cycle. Completions are
+// spaced by the doffer service time if the doffer has time left in
+// the cycle, otherwise evenly over the cycle. Winders can not be
+// started faster than the man step. Peak doffer queue depths of
+// the first completions are predicted for the plan and for the
+// start of all winders one by one.
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+class StartPlanner
+{
+public:
+  void plan(const StartGroup &group);
+  qint64 offset(int index) const {return (qint64)index * m_spacing;}
+  int spacing() const {return m_spacing;}
+  int peakBefore() const {return m_peakBefore;}
+  int peakAfter() const {return m_peakAfter;}
+
+private:
+  int peakQueue(const StartGroup &group, int spacing);
+
+  int m_spacing;          // start offset between the group winders (ms)
+  int m_peakBefore;       // predicted peak queue depth without the plan
+  int m_peakAfter;        // predicted peak queue depth with the plan
+};
+
+#endif
@@ -1,24 +1,54 @@
-#include <QUuid>
+#include <QTime>
+#include <QDateTime>
 #include <QDebug>
+#include <QApplication>
+#include <qdrawutil.h>
 #include "supervisor.h"
+#include "profiler.h"
+#include "tracer.h"
+#include "simclock.h"
 
 const int timerResolution = 100;    // default time latency for scan task timer
 const int dbSyncResolution = 1000;  // default time latency for db update action
+const int frameResolution = 40;     // canvas frame period, 25 frames per second
+const int clockResolution = 10;     // wall time between simulation clock ticks
+const int maxClockStep = 100;       // longest wall time advanced by one clock tick, stalls beyond it are not caught up (ms)
 const int margin = 80; // buffer zone in mm for the doffer & sleever
+const int lowestPrio = 0x7fffffff;  // priority of winders without priority rows
+const int startedPrio = 0;          // priority of paused tasks which have been started
+const int planLead = 3000;          // simulation time the doffer should wait at the winder before it is ready (ms)
+const int changeLead = 5000;        // simulation time the man should wait at the carrier before it is full (ms)
+const int failureRetry = 10000;     // simulation time the breakdown of the busy object is put off (ms)
+const int maxFailureDelay = 3600000;  // longest failure timer period, later events are waited for in steps (ms)
+
+// task names for the trace recorder
+const char *const taskStatusNames[] = {"NEW", "PROGRESS", "PAUSED", "CANCELLED", "DONE"};
+const char *const taskTypeNames[] = {"START_WINDER", "ROTATE_SPOOLER", "CHANGE_SPOOLER", "LOAD_SLEEVER", "DELIVER_BOBBINS",
+                               "DELIVER_SLEEVE", "MOVE_SLEEVER", "MOVE_DOFFER_SLEEVER", "HANDLE_COLLISION", "CUTEDGE_WINDER"};
 //_________________________________________________________
 //
 // Object constructor. Set default values for parameters
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-Supervisor::Supervisor(QWidget *parent /*=0*/): QFrame(parent)
+Supervisor::Supervisor(QObject *parent /*=0*/): QObject(parent)
 {
-  setFrameStyle(NoFrame | Plain);
   // init timers ids
   m_task_timer = 0;
   m_db_timer = 0;
+  m_frame_timer = 0;
+  m_clock_timer = 0;
+  m_externalClock = false;
   m_wholeWidthPixels = 0;
+  m_timeCoefficientOverride = 0;
+  m_frameSeq = 0;
+  m_taskSeq = 0;
+  m_sessionSeq = 0;
+  m_menChanged = false;
+  m_failure_timer = 0;
+  m_failureSeed = 0;
 
   m_aspectRatio = 0.0;
   m_margin = 5;
+  m_config.timeCoefficient = 1;
 }
 //_________________________________________________________
 //
@@ -44,23 +74,33 @@ void Supervisor::seed()
 
   QSqlDatabase db = InventoryDatabase::open();
   InventoryDatabase::getConfigView(db, m_config);
+  if (m_timeCoefficientOverride > 0)
+    m_config.timeCoefficient = m_timeCoefficientOverride;
   InventoryDatabase::getWindersView(db, m_windersModel, m_config.timeCoefficient);
+  InventoryDatabase::getWinderRecipes(db, m_windersModel);
+  InventoryDatabase::getWinderPriorities(db, m_windersModel);
   InventoryDatabase::getDoffersView(db, m_doffersModel, m_config.timeCoefficient);
   InventoryDatabase::getSleeversView(db, m_sleeversModel, m_config.timeCoefficient);
   InventoryDatabase::getSpoolersView(db, m_spoolersModel);
   InventoryDatabase::getMenView(db, m_menModel, m_config.timeCoefficient);
+  InventoryDatabase::getFailuresView(db, m_failuresModel, m_config.timeCoefficient);
   InventoryDatabase::close(db);
 }
 //_________________________________________________________
 //
-// Update doffers and sleevers data
+// Publish doffers and sleevers data. The database is updated
+// by the writer thread, so slow queries never delay the plant
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void Supervisor::sync()
 {
+  PROFILE_SCOPE("Supervisor::sync");
   DofferSyncModel dsm;
   SleeverSyncModel ssm;
-  QList<DofferSyncModel> doffers;
-  QList<SleeverSyncModel> sleevers;
+  SyncSnapshot &snapshot = m_syncWorker.backBuffer();
+  QList<DofferSyncModel> &doffers = snapshot.doffers;
+  QList<SleeverSyncModel> &sleevers = snapshot.sleevers;
+  doffers.clear();
+  sleevers.clear();
 
   // create doffer update models list
   foreach (Doffer *doffer, m_doffers)
@@ -70,7 +110,7 @@ void Supervisor::sync()
     // find a progress task for current doffer
     foreach (ts, m_tasks)
     {
-      if (ts->status == PROGRESS &&
+      if (ts->status == PROGRESS && ts->idTrip.isEmpty() &&
           ts->idAssignee == doffer->getId() &&
           (ts->type == DELIVER_BOBBINS || ts->type == MOVE_DOFFER_SLEEVER))
       {
@@ -136,14 +176,8 @@ void Supervisor::sync()
     sleevers.append(ssm);
   }
 
-  QSqlDatabase db = InventoryDatabase::open();              // open database
-  db.transaction();                                         // start transaction
-  if (InventoryDatabase::updateDoffers(db, doffers) &&      // update models
-      InventoryDatabase::updateSleevers(db, sleevers))
-    db.commit();                                            // commit if success
-  else
-    db.rollback();                                          // rollback if failed
-  InventoryDatabase::close(db);                             // close database
+  // hand the snapshot over to the writer thread
+  m_syncWorker.publish();
 }
 
 //_________________________________________________________
@@ -174,11 +208,7 @@ void Supervisor::initContainers(int xPos, int yPos)
       if (counter > 0)
       {
         // settle new service zone after the winder's group
-        QFrame *szone = new QFrame(this);
-        szone->hide();
-        szone->move(x, y);
-        szone->setFrameStyle(QFrame::Box | QFrame::Sunken);
-        m_services.append(szone);
+        m_services.append(QRect(x, y, serviceZoneWidth, 0));
         x += serviceZoneWidth;
       }
       // move to the new group
@@ -191,8 +221,12 @@ void Supervisor::initContainers(int xPos, int yPos)
 
     // create and place winder widget
     Winder *winder = new Winder(*it, m_config.timeCoefficient, this);
-    winder->hide();
     winder->move(x, y);
+    if (!it->idRecipe.isEmpty() && !m_recipeNames.contains(it->idRecipe))
+      m_recipeNames.append(it->idRecipe);
+    m_winderIndex.insert(winder->getId(), m_winders.size());
+    m_doffPrio.append(it->prioDoff > 0 ? it->prioDoff : lowestPrio);
+    m_sleeverPrio.append(it->prioSleever > 0 ? it->prioSleever : lowestPrio);
     m_winders.append(winder);
     x += winder->width() + space;
     // create signal-slot communication with supervisor
@@ -200,17 +234,15 @@ void Supervisor::initContainers(int xPos, int yPos)
     connect(winder, SIGNAL(bobbinsCutNeeded(QString)), this, SLOT(bobbinsCutNeeded(QString)));
     connect(winder, SIGNAL(winderFailed(QString)), this, SLOT(winderFailed(QString)));
     connect(winder, SIGNAL(winderAlert(QString)), this, SLOT(winderAlert(QString)));
+    connect(winder, SIGNAL(windingStarted(QString)), this, SLOT(winderStarted(QString)));
+    connect(winder, SIGNAL(statusChanged(QString,int,int)), this, SLOT(winderStatusChanged(QString,int,int)));
 
     counter++;
   }
   if (counter > 0)
   {
     // settle the last service zone
-    QFrame *szone = new QFrame(this);
-    szone->hide();
-    szone->move(x, y);
-    szone->setFrameStyle(QFrame::Box | QFrame::Sunken);
-    m_services.append(szone);
+    m_services.append(QRect(x, y, serviceZoneWidth, 0));
     x += serviceZoneWidth;
   }
 
@@ -229,9 +261,7 @@ void Supervisor::initContainers(int xPos, int yPos)
       break;
     // Create doffer and place it to the service zone
     Doffer *doffer = new Doffer(*it, this);
-    QFrame *serv = m_services.at(i);
-    doffer->hide();
-    doffer->move(serv->x(), y);
+    doffer->move(m_services.at(i).x(), y);
     dofferHeight = doffer->getControlHeight();
     m_doffers.append(doffer);
 
@@ -240,9 +270,11 @@ void Supervisor::initContainers(int xPos, int yPos)
     connect(doffer, SIGNAL(bobAboard(QString)), this, SLOT(bobbinsAboard(QString)));
     connect(doffer, SIGNAL(bobPlaced(QString)), this, SLOT(bobbinPlaced(QString)));
     connect(doffer, SIGNAL(taskCompleted(QString)), this, SLOT(taskCompleted(QString)));
-    connect(doffer, SIGNAL(movement(QString,QPoint,int)), this, SLOT(dofferMoved(QString,QPoint,int)));
+    doffer->setObserver(this);
+    doffer->setKinematics(&m_kinematics);
+    connect(doffer, SIGNAL(statusChanged(QString,int,int)), this, SLOT(dofferStatusChanged(QString,int,int)));
     //create doffer log item
-    appendLoggerItem(doffer->getId());
+    appendLoggerItem(doffer->getId(), simTime());
     connect(doffer, SIGNAL(updateLoggerItem(QString,Logger::FieldNames)), this, SLOT(updateLogger(QString,Logger::FieldNames)));
 
     i++;
@@ -260,18 +292,18 @@ void Supervisor::initContainers(int xPos, int yPos)
       break;
     // Create sleever and place it to the service zone
     Sleever *sleever = new Sleever(*it, this);
-    QFrame *serv = m_services.at(i);
-    sleever->hide();
-    sleever->move(serv->x(), y);
+    sleever->move(m_services.at(i).x(), y);
     m_sleevers.append(sleever);
 
     // create signal-slot communication with supervisor
     connect(sleever, SIGNAL(goalReached(QString)), this, SLOT(sleeverArrived(QString)));
     connect(sleever, SIGNAL(taskCompleted(QString)), this, SLOT(taskCompleted(QString)));
     connect(sleever, SIGNAL(emptySleever(QString)), this, SLOT(sleeverEmpty(QString)));
-    connect(sleever, SIGNAL(movement(QString,QPoint,int)), this, SLOT(sleeverMoved(QString,QPoint,int)));
+    sleever->setObserver(this);
+    sleever->setKinematics(&m_kinematics);
+    connect(sleever, SIGNAL(statusChanged(QString,int,int)), this, SLOT(sleeverStatusChanged(QString,int,int)));
     //create sleever log item
-    appendLoggerItem(sleever->getId());
+    appendLoggerItem(sleever->getId(), simTime());
     connect(sleever, SIGNAL(updateLoggerItem(QString,Logger::FieldNames)), this, SLOT(updateLogger(QString,Logger::FieldNames)));
 
     i++;
@@ -298,13 +330,13 @@ void Supervisor::initContainers(int xPos, int yPos)
         if (i - 1 >= m_services.size())
           break;
         // get the x-Pos of the service zone
-        QFrame *serv = m_services.at(i - 1);
-        x = serv->x() + (serviceZoneWidth << 1);
+        const QRect &serv = m_services.at(i - 1);
+        x = serv.x() + (serviceZoneWidth << 1);
         // if group exists
         if (section.size() > 0)
         {
           // count the offset and move spoolers in the middle of winder group
-          int offset = (serv->x() - section[0]->x() - spWidth) / 2;
+          int offset = (serv.x() - section[0]->x() - spWidth) / 2;
           foreach (Spooler *sp, section)
           {
             QPoint pt = sp->pos();
@@ -319,9 +351,10 @@ void Supervisor::initContainers(int xPos, int yPos)
     }
 
     // add spooler to container
-    spooler->hide();
+    spooler->setRecipeNames(&m_recipeNames);
     spooler->move(x, y);
     m_spoolers.append(spooler);
+    m_dofferSpoolers[it->idDoffer].append(spooler);
     section.append(spooler);
     // create signal-slot communication with supervisor
     connect(spooler, SIGNAL(filledUp(QString)), this, SLOT(spoolerFilled(QString)));
@@ -333,11 +366,11 @@ void Supervisor::initContainers(int xPos, int yPos)
   if (i > 0)
   {
     // get the last service zone
-    QFrame *serv = m_services.at(i - 1);
+    const QRect &serv = m_services.at(i - 1);
     if (section.size() > 0)
     {
       // count the offset and move spoolers in the middle of winder group
-      int offset = (serv->x() - section[0]->x() - spWidth) / 2;
+      int offset = (serv.x() - section[0]->x() - spWidth) / 2;
       foreach (Spooler *sp, section)
       {
         QPoint pt = sp->pos();
@@ -358,8 +391,7 @@ void Supervisor::initContainers(int xPos, int yPos)
     connect(man, SIGNAL(goalReached(QString)), this, SLOT(manReached(QString)));
     connect(man, SIGNAL(taskCompleted(QString)), this, SLOT(taskCompleted(QString)));
 
-    //add widget to container
-    man->hide();
+    //add object to container
     man->move(x, y);
     m_men.append(man);
 
@@ -367,47 +399,83 @@ void Supervisor::initContainers(int xPos, int yPos)
     x += man->width() + space;
   }
 
-  // calculate supervisor widget size
+  // calculate the plant layout size
   y += getMaxHeight<ManService>(m_men) + space;
-  resize(width, y);
+  m_layoutSize = QSize(width, y);
 }
 //_________________________________________________________
 //
-// Public method of starting supervisor activity by seeding models and creating containers
+// Public method of building the plant layout by seeding models and creating containers.
+// The plant is not started, the canvas draws published frames with its objects
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-void Supervisor::start()
+void Supervisor::layout()
 {
   int space = 10;
 
   seed();                             // Seeding models
   countAspectRatio(space);            // Calculate aspect ratio for mm -> pxl convertions
   m_margin = toPixels(margin);
-  initContainers(space, space * 2);   // Create child widget containers
+  initContainers(space, space * 2);   // Create child containers
 
-  // show winders
+  // service zones keep the geometry only, they span the layout height
+  for(int i = 0; i < m_services.size(); i++)
+    m_services[i].setHeight(m_layoutSize.height() - space * 2);
+  // put all objects on the canvas
   foreach(Winder *it, m_winders)
-    it->show();
-  // show service zones
-  foreach(QFrame *it, m_services)
-  {
-    it->resize(toPixels(m_config.serviceZoneWidth), height() - space * 2);
-    it->show();
-  }
-  // show doffers
+    it->setOnCanvas(true);
   foreach(Doffer *it, m_doffers)
-    it->show();
-  // show sleevers
+    it->setOnCanvas(true);
   foreach(Sleever *it, m_sleevers)
-    it->show();
-  // show spoolers
+    it->setOnCanvas(true);
   foreach(Spooler *it, m_spoolers)
-    it->show();
-  // show man-services
+    it->setOnCanvas(true);
+  foreach(ManService *it, m_men)
+    it->setOnCanvas(true);
+}
+//_________________________________________________________
+//
+// Public method of starting supervisor activity on the new layout. Qt timers
+// are moved together with the supervisor if it is moved to the simulation thread
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Supervisor::start()
+{
+  SimClock::start();                  // Start simulation clock before objects are created
+  m_sessionSeq = 0;                   // Task session ids of the run follow the creation order
+  layout();                           // Seed models and create containers
+
+  // register trace processes
+  TraceRecorder::setTimeCoefficient(m_config.timeCoefficient);
+  foreach(Winder *it, m_winders)
+    TraceRecorder::registerObject(it->getId(), "Winder");
+  foreach(Doffer *it, m_doffers)
+    TraceRecorder::registerObject(it->getId(), "Doffer");
+  foreach(Sleever *it, m_sleevers)
+    TraceRecorder::registerObject(it->getId(), "Sleever");
   foreach(ManService *it, m_men)
-    it->show();
+    TraceRecorder::registerObject(it->getId(), "Man");
+
+  // reset KPI windows
+  m_kpi.reset(simTime(), m_winders.size(), m_doffers.size(), m_sleevers.size());
+
+  // the sleever track has the passing lane along the service zones
+  m_track.clear();
+  foreach(const QRect &it, m_services)
+    m_track.appendZone(it.x(), it.x() + it.width());
+  // the first frame repaints the whole canvas
+  invalidate(QRect(QPoint(0, 0), m_layoutSize));
+  m_frameSeq = 0;
 
-  m_task_timer = startTimer(timerResolution);     // start supervisor task timer
+  // the headless owner advances the clock and renders by itself
+  if (!m_externalClock)
+  {
+    m_wallClock.start();
+    m_clock_timer = startTimer(clockResolution);  // start simulation clock ticks
+    m_frame_timer = startTimer(frameResolution);  // start canvas frame timer
+  }
+  m_task_timer = SimClock::startTimer(this, timerResolution);   // start supervisor task timer
   m_db_timer = startTimer(dbSyncResolution);      // start database update timer
+  m_syncWorker.start();                           // start database writer thread
+  startFailures();                                // schedule first breakdowns
 }
 //_________________________________________________________
 //
@@ -416,9 +484,15 @@ void Supervisor::start()
 void Supervisor::stop()
 {
   // killing all timers
+  if (m_clock_timer > 0)
+  {
+    killTimer(m_clock_timer);
+    m_clock_timer = 0;
+  }
+  SimClock::stop();     // plant object timers are dropped with the clock
   if (m_task_timer > 0)
   {
-    killTimer(m_task_timer);
+    SimClock::killTimer(m_task_timer);
     m_task_timer = 0;
   }
   if (m_db_timer > 0)
@@ -426,17 +500,38 @@ void Supervisor::stop()
     killTimer(m_db_timer);
     m_db_timer = 0;
   }
+  m_syncWorker.stop();  // the last snapshot is written before the thread ends
+  if (m_failure_timer > 0)
+  {
+    SimClock::killTimer(m_failure_timer);
+    m_failure_timer = 0;
+  }
+  m_failures.clear();
+  if (m_frame_timer > 0)
+  {
+    killTimer(m_frame_timer);
+    m_frame_timer = 0;
+  }
+  m_kinematics.clear(); // stop the track movement of all locators
+
+  // Close opened trace slices of the session
+  if (TraceRecorder::isRecording())
+    TraceRecorder::flush();
 
   // Clean up task queue
   foreach(TaskSession *it, m_tasks)
     if (it != NULL) delete it;
   m_tasks.clear();
+  m_doffingTasks.clear();
+  m_sleevingTasks.clear();
+  m_planner.clear();
+  m_track.clear();
+  m_manDispatcher.clear();
+  m_menChanged = false;
 
   // Clean up containers
   foreach(Winder *it, m_winders)
     if (it != NULL) delete it;
-  foreach(QFrame *it, m_services)
-    if (it != NULL) delete it;
   foreach(Doffer *it, m_doffers)
     if (it != NULL) delete it;
   foreach(Sleever *it, m_sleevers)
@@ -447,11 +542,21 @@ void Supervisor::stop()
     if (it != NULL) delete it;
 
   m_winders.clear();
+  m_winderIndex.clear();
+  m_doffPrio.clear();
+  m_sleeverPrio.clear();
   m_services.clear();
+  m_recipeNames.clear();
   m_doffers.clear();
   m_sleevers.clear();
   m_spoolers.clear();
+  m_dofferSpoolers.clear();
+  m_recipeCarriers.clear();
+  m_spareCarriers.clear();
+  m_spoolerFillAt.clear();
+  m_startPlans.clear();
   m_men.clear();
+  m_dirtyRect = QRect();
 
   modelClear();         //Clean up models
 }
@@ -472,12 +577,15 @@ void Supervisor::modelClear()
     if (it != NULL) delete it;
   foreach(ManServiceModel *it, m_menModel)
     if (it != NULL) delete it;
+  foreach(FailureModel *it, m_failuresModel)
+    if (it != NULL) delete it;
 
   m_windersModel.clear();
   m_doffersModel.clear();
   m_sleeversModel.clear();
   m_spoolersModel.clear();
   m_menModel.clear();
+  m_failuresModel.clear();
 }
 //_________________________________________________________
 //
@@ -558,6 +666,23 @@ ManService *Supervisor::getNearestMan(int xPos)
 }
 //_________________________________________________________
 //
+// Return the walking time of the nearest man-service to xPos, -1 if
+// no man is able to walk
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+int Supervisor::getManWalkTime(int xPos)
+{
+  int walk = -1;
+  foreach(ManService *it, m_men)
+  {
+    if (it->getSpeed() <= 0) continue;
+    int curWalk = 1000 * abs(it->x() - xPos) / it->getSpeed();
+    if (curWalk < walk || walk == -1)
+      walk = curWalk;
+  }
+  return walk;
+}
+//_________________________________________________________
+//
 // Query a man-service depending on strategy
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 ManService *Supervisor::getManByStrategy(int xPos/* = 0*/, ManStrategy ms/* = NEAREST_OR_LEASTBUSY*/)
@@ -594,6 +719,11 @@ bool Supervisor::startWinders()
   ManService *man = getManByStrategy(0, FREE_OR_LEASTBUSY);
   if (man == NULL) return false;
 
+  // completions of every doffer group are spread by start offsets
+  QHash<QString, qint64> offsets;
+  planWinderStarts(offsets);
+  qint64 now = SimClock::now();
+
   // Create task for each winder
   foreach (Winder *it, m_winders)
   {
@@ -602,13 +732,12 @@ bool Supervisor::startWinders()
         it->getStatus() == Winder::FAIL)
     {
       TaskSession *task = new TaskSession;
-      task->idSession = QUuid::createUuid().toString();
-      task->status = NEW;
+      task->idSession = newSessionId();
       task->type = START_WINDER;
       task->idAssignee = man->getId();
       task->idObject = it->getId();
       task->places = 0;
-      m_tasks.append(task);
+      appendTask(task, now + offsets.value(it->getId(), 0));
     }
   }
 
@@ -616,6 +745,97 @@ bool Supervisor::startWinders()
 }
 //_________________________________________________________
 //
+// Plan start offsets of winders to start in every doffer group. The
+// doffer service time of a winder counts the trip between the winder
+// and carriers, taking and putting bobbins, and shares of carrier
+// changes and sleever reloads
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Supervisor::planWinderStarts(QHash<QString, qint64> &offsets)
+{
+  ManServiceModel *manModel = m_menModel.isEmpty() ? NULL : m_menModel.first();
+  m_startPlans.clear();
+  foreach(Doffer *doffer, m_doffers)
+  {
+    DofferModel *dofferModel = getItemById<DofferModel>(doffer->getId(), m_doffersModel);
+    if (dofferModel == NULL) continue;
+
+    // winders to start in the doffing priority order
+    QList<Winder *> winders;
+    int cycle = 0;
+    int bobbins = 0;
+    int width = 0;
+    QString idSleever;
+    foreach(Winder *it, m_winders)
+    {
+      if (it->getStatus() != Winder::EMPTY && it->getStatus() != Winder::FAIL) continue;
+      WinderModel *model = getItemById<WinderModel>(it->getId(), m_windersModel);
+      if (model == NULL || model->idDoffer != doffer->getId()) continue;
+
+      int prio = m_doffPrio[m_winderIndex.value(it->getId())];
+      int pos = winders.size();
+      while (pos > 0 && m_doffPrio[m_winderIndex.value(winders[pos - 1]->getId())] > prio)
+        pos--;
+      winders.insert(pos, it);
+
+      if (cycle == 0 || model->timeWind + model->timeExchange < cycle)
+        cycle = model->timeWind + model->timeExchange;
+      bobbins = qMax(bobbins, model->isHalfMode ? 1 : 2);
+      width = qMax(width, model->width);
+      idSleever = model->idSleever;
+    }
+    if (winders.isEmpty()) continue;
+
+    // doffer trip between the group carriers and the winders with bobbins handling
+    int spoolerX = doffer->x();
+    const QList<Spooler *> &carriers = m_dofferSpoolers[doffer->getId()];
+    if (!carriers.isEmpty())
+    {
+      qint64 sumSpoolerX = 0;
+      foreach(Spooler *sp, carriers)
+        sumSpoolerX += sp->x() + sp->width() / 2;
+      spoolerX = sumSpoolerX / carriers.size();
+    }
+    qint64 trips = 0;
+    foreach(Winder *it, winders)
+      trips += doffer->getTravelTime(spoolerX, it->x());
+    int service = 2 * trips / winders.size() +
+                  dofferModel->timeGetIn + bobbins * dofferModel->timePutDown;
+    // shares of carrier changes and sleever reloads
+    int cells = 0;
+    foreach(SpoolerModel *it, m_spoolersModel)
+      if (it->idDoffer == doffer->getId())
+        cells += it->rows * it->columns;
+    SleeverModel *sleeverModel = getItemById<SleeverModel>(idSleever, m_sleeversModel);
+    if (manModel != NULL && cells > 0)
+      service += manModel->timeChangeSpooler * bobbins / cells;
+    if (manModel != NULL && sleeverModel != NULL && sleeverModel->sleeveSlots > 0)
+      service += manModel->timeLoadSleever * bobbins / sleeverModel->sleeveSlots;
+
+    StartGroup group;
+    group.winders = winders.size();
+    group.cycle = cycle;
+    group.service = service;
+    group.manStep = 0;
+    if (manModel != NULL)
+      group.manStep = manModel->timeStartWinder +
+                      (manModel->speed > 0 ? 1000 * (width + m_config.spaceBetweenWinders) / manModel->speed : 0);
+
+    StartPlanner planner;
+    planner.plan(group);
+    for(int i = 0; i < winders.size(); i++)
+      offsets.insert(winders[i]->getId(), planner.offset(i));
+
+    StartPlanReport report;
+    report.idDoffer = doffer->getId();
+    report.winders = group.winders;
+    report.spacing = planner.spacing();
+    report.peakBefore = planner.peakBefore();
+    report.peakAfter = planner.peakAfter();
+    m_startPlans.append(report);
+  }
+}
+//_________________________________________________________
+//
 // Create task for sleever loading
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 bool Supervisor::createLoadSleeverTask(Sleever *sleever)
@@ -627,13 +847,12 @@ bool Supervisor::createLoadSleeverTask(Sleever *sleever)
 
   // Add new task session
   TaskSession *task = new TaskSession;
-  task->idSession = QUuid::createUuid().toString();
-  task->status = NEW;
+  task->idSession = newSessionId();
   task->type = LOAD_SLEEVER;
   task->idAssignee = man->getId();
   task->idObject = sleever->getId();
   task->places = 0;
-  m_tasks.append(task);
+  appendTask(task);
   return true;
 }
 //_________________________________________________________
@@ -645,19 +864,54 @@ void Supervisor::spoolerFilled(QString idSpooler)
   //check spooler
   Spooler *dest = getItemById<Spooler>(idSpooler, m_spoolers);
   if (dest == NULL) return;
+
+  // the man called in advance may wait at the spooler already
+  TaskSession *ts = getSpoolerTask(idSpooler);
+  if (ts != NULL)
+  {
+    ManService *man = getItemById<ManService>(ts->idAssignee, m_men);
+    if (ts->status == PROGRESS && man != NULL && man->getSession() == ts->idSession &&
+        man->getStatus() == ManService::READY && !man->isMoving())
+      manReached(ts->idSession);
+    return;
+  }
+  requestSpoolerChange(dest, false);
+}
+//_________________________________________________________
+//
+// Create task for spooler rotate or change. The early task is created
+// before the spooler is full, the man waits at the spooler then
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool Supervisor::requestSpoolerChange(Spooler *spooler, bool early)
+{
   // query man-service
-  ManService *man = getManByStrategy(dest->x());
-  if (man == NULL) return;
+  ManService *man = getManByStrategy(spooler->x());
+  if (man == NULL) return false;
 
   // Create new task
   TaskSession *task = new TaskSession;
-  task->idSession = QUuid::createUuid().toString();
-  task->status = NEW;
-  task->type = dest->isAbleToRotate() ? ROTATE_SPOOLER : CHANGE_SPOOLER;
+  task->idSession = newSessionId();
+  task->type = spooler->isAbleToRotate() ? ROTATE_SPOOLER : CHANGE_SPOOLER;
   task->idAssignee = man->getId();
-  task->idObject = idSpooler;
+  task->idObject = spooler->getId();
   task->places = 0;
-  m_tasks.append(task);
+  task->early = early;
+  appendTask(task);
+  return true;
+}
+//_________________________________________________________
+//
+// Return the active rotate or change task of the spooler
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Supervisor::TaskSession *Supervisor::getSpoolerTask(QString idSpooler)
+{
+  foreach(TaskSession *ts, m_tasks)
+  {
+    if ((ts->type == ROTATE_SPOOLER || ts->type == CHANGE_SPOOLER) &&
+        ts->idObject == idSpooler && ts->status != DONE && ts->status != CANCELLED)
+      return ts;
+  }
+  return NULL;
 }
 //_________________________________________________________
 //
@@ -676,13 +930,12 @@ void Supervisor::callSleever(QString idWinder)
 
   // create new task
   TaskSession *task = new TaskSession;
-  task->idSession = QUuid::createUuid().toString();
-  task->status = NEW;
+  task->idSession = newSessionId();
   task->type = DELIVER_SLEEVE;
   task->idAssignee = it->idSleever;
   task->idObject = idWinder;
   task->places = it->isHalfMode ? 1 : 2;
-  m_tasks.append(task);
+  appendTask(task);
 }
 //_________________________________________________________
 //
@@ -701,13 +954,12 @@ void Supervisor::bobbinsReady(QString idWinder)
 
   //create new task
   TaskSession *task = new TaskSession;
-  task->idSession = QUuid::createUuid().toString();
-  task->status = NEW;
+  task->idSession = newSessionId();
   task->type = DELIVER_BOBBINS;
   task->idAssignee = it->idDoffer;
   task->idObject = idWinder;
   task->places = it->isHalfMode ? 1 : 2;
-  m_tasks.append(task);
+  appendTask(task);
 }
 //_________________________________________________________
 //
@@ -724,13 +976,12 @@ void Supervisor::bobbinsCutNeeded(QString idWinder)
   if (man == NULL) return;
   // Create new task
   TaskSession *task = new TaskSession;
-  task->idSession = QUuid::createUuid().toString();
-  task->status = NEW;
+  task->idSession = newSessionId();
   task->type = CUTEDGE_WINDER;
   task->idAssignee = man->getId();
   task->idObject = idWinder;
   task->places = 0;
-  m_tasks.append(task);
+  appendTask(task);
 }
 //_________________________________________________________
 //
@@ -740,22 +991,23 @@ void Supervisor::sleeverEmpty(QString idSleever)
 {
   //Create new task
   TaskSession *task = new TaskSession;
-  task->idSession = QUuid::createUuid().toString();
-  task->status = NEW;
+  task->idSession = newSessionId();
   task->type = MOVE_SLEEVER;
   task->idAssignee = idSleever;
   task->places = 0;
-  m_tasks.append(task);
+  appendTask(task);
 }
 //_________________________________________________________
 //
-// Slot activates moving doffer and sleever task creation
+// Slot activates moving doffer and sleever task creation. Winders
+// with predicted completion are served by the planner instead
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void Supervisor::winderAlert(QString idWinder)
 {
   // Check winder
   WinderModel *winderModel = getItemById<WinderModel>(idWinder, m_windersModel);
   if (winderModel == NULL) return;
+  if (m_planner.isTracked(winderModel->idDoffer, idWinder)) return;
   // Check doffer
   Doffer *doffer = getItemById<Doffer>(winderModel->idDoffer, m_doffers);
   if (doffer == NULL) return;
@@ -763,111 +1015,958 @@ void Supervisor::winderAlert(QString idWinder)
   if (doffer->getStatus() != Doffer::IDLE)
     return;
 
-  // Create new task
+  dispatchDoffer(winderModel->idDoffer, idWinder);
+}
+//_________________________________________________________
+//
+// Slot predicts the winder completion when the winder starts winding
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Supervisor::winderStarted(QString idWinder)
+{
+  WinderModel *winderModel = getItemById<WinderModel>(idWinder, m_windersModel);
+  Winder *winder = getItemById<Winder>(idWinder, m_winders);
+  if (winderModel == NULL || winder == NULL) return;
+  m_planner.update(winderModel->idDoffer, idWinder, SimClock::now() + winder->getTimeToReady());
+}
+//_________________________________________________________
+//
+// Send every idle doffer with its sleever to the winder of its group
+// which should be left first, so both arrive just before the bobbins
+// are ready. The doffer takes the next completion of the timeline
+// as soon as it is idle again, thus pickups are chained
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Supervisor::planDepartures()
+{
+  PROFILE_SCOPE("Supervisor::planDepartures");
+  qint64 now = SimClock::now();
+  int lead = planLead / (m_config.timeCoefficient > 0 ? m_config.timeCoefficient : 1);
+
+  foreach(Doffer *doffer, m_doffers)
+  {
+    // the doffer should be idle and not sent yet
+    if (doffer->getStatus() != Doffer::IDLE || doffer->isMoving())
+      continue;
+    if (m_planner.hasDispatched(doffer->getId()))
+      continue;
+
+    // find the completion with the earliest departure
+    QString idTarget;
+    qint64 departAt = 0;
+    foreach(const Completion &it, m_planner.timeline(doffer->getId()))
+    {
+      Winder *winder = getItemById<Winder>(it.idWinder, m_winders);
+      WinderModel *winderModel = getItemById<WinderModel>(it.idWinder, m_windersModel);
+      if (winder == NULL || winderModel == NULL) continue;
+      // bobbins of the cut edge mode are taken by the man, winders
+      // waiting for the sleeve or a man are not completing
+      if (winder->getCutEdgeMode() || winder->getStatus() != Winder::LOADED) continue;
+
+      // both doffer and sleever should reach the winder
+      int travel = doffer->getTravelTime(winder->getBobbinsRect().left());
+      Sleever *sleever = getItemById<Sleever>(winderModel->idSleever, m_sleevers);
+      if (sleever != NULL)
+        travel = qMax(travel, sleever->getTravelTime(winder->getBobbinsRect().left()));
+      if (idTarget.isEmpty() || it.readyAt - travel < departAt)
+      {
+        idTarget = it.idWinder;
+        departAt = it.readyAt - travel;
+      }
+    }
+
+    if (!idTarget.isEmpty() && now + lead >= departAt)
+      dispatchDoffer(doffer->getId(), idTarget);
+  }
+}
+//_________________________________________________________
+//
+// Create the task to move the doffer and sleever to the winder
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Supervisor::dispatchDoffer(QString idDoffer, QString idWinder)
+{
   TaskSession *task = new TaskSession;
-  task->idSession = QUuid::createUuid().toString();
-  task->status = NEW;
+  task->idSession = newSessionId();
   task->type = MOVE_DOFFER_SLEEVER;
-  task->idAssignee = winderModel->idDoffer;
+  task->idAssignee = idDoffer;
   task->idObject = idWinder;
   task->places = 0;
-  m_tasks.append(task);
+  appendTask(task);
+  m_planner.setDispatched(idDoffer, idWinder);
+}
+//_________________________________________________________
+//
+// Forecast filling of spoolers from the waiting and predicted bobbins
+// of every doffer group. The man is called to the spooler which gets
+// full before a man could walk there, the early call is dropped if the
+// spooler is not predicted to get full any more. Empty spoolers are
+// kept for the recipe which is predicted to take them first
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Supervisor::forecastCarriers()
+{
+  PROFILE_SCOPE("Supervisor::forecastCarriers");
+  qint64 now = SimClock::now();
+  int lead = changeLead / (m_config.timeCoefficient > 0 ? m_config.timeCoefficient : 1);
+  m_spareCarriers.clear();
+  m_spoolerFillAt.clear();
+
+  foreach(Doffer *doffer, m_doffers)
+  {
+    QList<Spooler *> group = m_dofferSpoolers.value(doffer->getId());
+    if (group.isEmpty()) continue;
+
+    // bobbins waiting for the doffer come first
+    QList<Arrival> arrivals;
+    foreach(TaskSession *ts, m_tasks)
+    {
+      if (ts->type != DELIVER_BOBBINS || ts->idAssignee != doffer->getId()) continue;
+      if (ts->status != NEW && ts->status != PAUSED) continue;
+      Winder *winder = getItemById<Winder>(ts->idObject, m_winders);
+      if (winder == NULL) continue;
+      Arrival arrival;
+      arrival.readyAt = now;
+      arrival.idRecipe = winder->getRecipe();
+      arrival.bobbins = ts->places;
+      arrivals.append(arrival);
+    }
+    // then bobbins of winding winders in the completion order
+    foreach(const Completion &it, m_planner.timeline(doffer->getId()))
+    {
+      Winder *winder = getItemById<Winder>(it.idWinder, m_winders);
+      WinderModel *winderModel = getItemById<WinderModel>(it.idWinder, m_windersModel);
+      if (winder == NULL || winderModel == NULL || winder->getStatus() != Winder::LOADED) continue;
+      Arrival arrival;
+      arrival.readyAt = qMax(it.readyAt, now);
+      arrival.idRecipe = winder->getRecipe();
+      arrival.bobbins = winderModel->isHalfMode ? 1 : 2;
+      arrivals.append(arrival);
+    }
+
+    QVector<CarrierState> carriers;
+    foreach(Spooler *it, group)
+    {
+      CarrierState carrier;
+      carrier.idSpooler = it->getId();
+      carrier.idRecipe = it->getRecipe();
+      carrier.freeCells = it->getFreeCells();
+      carriers.append(carrier);
+    }
+    FillForecaster forecaster;
+    forecaster.forecast(carriers, arrivals);
+
+    for(int i = 0; i < group.size(); i++)
+    {
+      Spooler *spooler = group[i];
+      if (spooler->getRecipe().isEmpty() && !forecaster.keptFor(i).isEmpty())
+        m_spareCarriers.insert(spooler->getId(), forecaster.keptFor(i));
+      if (spooler->isFilledUp()) continue;
+
+      qint64 fillAt = forecaster.fillAt(i);
+      if (fillAt >= 0)
+        m_spoolerFillAt.insert(spooler->getId(), fillAt);
+      TaskSession *ts = getSpoolerTask(spooler->getId());
+      if (ts == NULL)
+      {
+        int walk = getManWalkTime(spooler->x());
+        if (fillAt >= 0 && walk >= 0 && fillAt - now <= lead + walk)
+          requestSpoolerChange(spooler, true);
+      }
+      else if (ts->early && fillAt < 0)
+      {
+        // the early call is not needed any more
+        ManService *man = getItemById<ManService>(ts->idAssignee, m_men);
+        if (man != NULL && man->getSession() == ts->idSession)
+          man->stopMoving(false);
+        cancelTask(ts);
+      }
+    }
+  }
+}
+//_________________________________________________________
+//
+// Create handle collision task
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Supervisor::handleCollision(Doffer *doffer, Sleever *sleever, bool isDofferPriority, bool waitDoffer, bool waitSleever)
+{
+  if (doffer == NULL || sleever == NULL) return;
+
+  TaskSession *task = new TaskSession;
+  task->idSession = newSessionId();
+  task->type = HANDLE_COLLISION;
+  task->idAssignee = doffer->getId();
+  task->idObject = sleever->getId();
+  task->places = isDofferPriority;
+  task->waitDoffer = waitDoffer;
+  task->waitSleever = waitSleever;
+  appendTask(task);
+}
+//_________________________________________________________
+//
+// Schedule first breakdowns of objects having failure rates. Events
+// run on the session clock, the seed reproduces the drawn times only
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Supervisor::startFailures()
+{
+  m_failures.clear();
+  m_failures.setSeed(m_failureSeed != 0 ? m_failureSeed : quint64(QDateTime::currentMSecsSinceEpoch()));
+  if (m_failuresModel.isEmpty()) return;
+
+  qint64 now = SimClock::now();
+  foreach(FailureModel *it, m_failuresModel)
+  {
+    if (getItemById<Winder>(it->idObject, m_winders) != NULL ||
+        getItemById<Doffer>(it->idObject, m_doffers) != NULL ||
+        getItemById<Sleever>(it->idObject, m_sleevers) != NULL ||
+        getItemById<ManService>(it->idObject, m_men) != NULL)
+      m_failures.append(it->idObject, it->mtbf, it->mttr, now);
+  }
+  armFailureTimer();
+}
+//_________________________________________________________
+//
+// Restart the failure timer for the next scheduled event
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Supervisor::armFailureTimer()
+{
+  if (m_failure_timer > 0)
+  {
+    SimClock::killTimer(m_failure_timer);
+    m_failure_timer = 0;
+  }
+  qint64 dueAt = m_failures.nextDue();
+  if (dueAt < 0) return;
+  m_failure_timer = SimClock::startTimer(this, int(qBound<qint64>(0, dueAt - SimClock::now(), maxFailureDelay)));
+}
+//_________________________________________________________
+//
+// Handle all due breakdowns and repairs. Busy objects put their
+// breakdowns off until they are idle
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Supervisor::processFailures()
+{
+  PROFILE_SCOPE("Supervisor::processFailures");
+  qint64 now = SimClock::now();
+  int retry = failureRetry / (m_config.timeCoefficient > 0 ? m_config.timeCoefficient : 1);
+  FailureEvent event;
+  while (m_failures.takeDue(now, event))
+  {
+    QString idObject = m_failures.getId(event.slot);
+    if (event.repair)
+    {
+      m_failures.repair(event);
+      repairObject(idObject);
+    }
+    else if (breakObject(idObject))
+      m_failures.breakDown(event);
+    else
+      m_failures.postpone(event, now - event.dueAt + retry);
+  }
+  armFailureTimer();
+}
+//_________________________________________________________
+//
+// Break the object down. The winder fails while it is winding only,
+// its finished bobbins are never lost. Doffers, sleevers and men break
+// down when they are idle only. Return false if the object is busy or
+// the winder does not wind
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool Supervisor::breakObject(const QString &idObject)
+{
+  Winder *winder = getItemById<Winder>(idObject, m_winders);
+  if (winder != NULL)
+  {
+    if (!winder->isWinding())
+      return false;
+    winder->breakDown();
+  }
+  Doffer *doffer = getItemById<Doffer>(idObject, m_doffers);
+  if (doffer != NULL && (doffer->getStatus() != Doffer::IDLE || doffer->isMoving()))
+    return false;
+  Sleever *sleever = getItemById<Sleever>(idObject, m_sleevers);
+  if (sleever != NULL && (sleever->getStatus() != Sleever::IDLE || sleever->isMoving()))
+    return false;
+  ManService *man = getItemById<ManService>(idObject, m_men);
+  if (man != NULL)
+  {
+    if (man->getStatus() != ManService::IDLE || man->isMoving())
+      return false;
+    // pending tasks of the man go to the others
+    m_menChanged = true;
+  }
+  TraceRecorder::setStatus(idObject, "DOWN");
+  return true;
+}
+//_________________________________________________________
+//
+// Put the repaired object back into service. The failed winder is
+// started by a man, paused doffer and sleever tasks are resumed by
+// the task scan
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Supervisor::repairObject(const QString &idObject)
+{
+  Winder *winder = getItemById<Winder>(idObject, m_winders);
+  if (winder != NULL)
+  {
+    winder->setStatus(winder->getStatus());
+    bool starting = false;
+    foreach(TaskSession *ts, m_tasks)
+      if (ts->type == START_WINDER && ts->idObject == idObject && ts->status != DONE && ts->status != CANCELLED)
+        starting = true;
+    ManService *man = getManByStrategy(winder->x());
+    if (winder->getStatus() == Winder::FAIL && !starting && man != NULL)
+    {
+      TaskSession *task = new TaskSession;
+      task->idSession = newSessionId();
+      task->type = START_WINDER;
+      task->idAssignee = man->getId();
+      task->idObject = idObject;
+      task->places = 0;
+      appendTask(task);
+    }
+  }
+  Doffer *doffer = getItemById<Doffer>(idObject, m_doffers);
+  if (doffer != NULL)
+    doffer->setStatus(doffer->getStatus());
+  Sleever *sleever = getItemById<Sleever>(idObject, m_sleevers);
+  if (sleever != NULL)
+    sleever->setStatus(sleever->getStatus());
+  ManService *man = getItemById<ManService>(idObject, m_men);
+  if (man != NULL)
+    man->setStatus(man->getStatus());
+  // held man tasks of the object are planned again
+  m_menChanged = true;
+}
+//_________________________________________________________
+//
+// Slot activates removing of failed winder doffering or sleever tasks
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Supervisor::winderFailed(QString idWinder)
+{
+  // the winder will not complete, drop it from the plan
+  WinderModel *winderModel = getItemById<WinderModel>(idWinder, m_windersModel);
+  if (winderModel != NULL)
+    m_planner.remove(winderModel->idDoffer, idWinder);
+
+  // Cancel all new doffer & sleever tasks with this winder
+  foreach (TaskSession *ts, m_tasks) {
+    if (ts->idObject == idWinder && ts->status == NEW &&
+       (ts->type == DELIVER_BOBBINS || ts->type == DELIVER_SLEEVE))
+      cancelTask(ts);
+  }
+}
+//_________________________________________________________
+//
+// Cancel task session
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Supervisor::cancelTask(TaskSession *ts)
+{
+  if (ts == NULL) return;
+  //qDebug() << "<====== Cancelled " << ts->type << ts->idAssignee << ts->idObject << ts->idSession;
+
+  switch(ts->type)
+  {
+    case START_WINDER:
+    case ROTATE_SPOOLER:
+    case CHANGE_SPOOLER:
+    case LOAD_SLEEVER:
+    case CUTEDGE_WINDER:
+      {
+        // For man service cancelling leads to idle status
+        // Check man-service
+        ManService *it = getItemById<ManService>(ts->idAssignee, m_men);
+        // Set status as idle
+        if (it != NULL)
+          it->setStatus(ManService::IDLE);
+        break;
+      }
+    case DELIVER_BOBBINS:
+      {
+        // cancel possible spooler reserve
+        cancelSpoolerReservation(ts->reserve);
+        for(int i = 0; i < ts->pickups.size(); i++)
+          cancelSpoolerReservation(ts->pickups[i].reserve);
+        ts->pickups.clear();
+        // merged tasks of winders not collected yet are doffed again
+        foreach(TaskSession *it, m_tasks)
+        {
+          if (it->idTrip != ts->idSession || it->status != PROGRESS) continue;
+          it->idTrip.clear();
+          Winder *winder = getItemById<Winder>(it->idObject, m_winders);
+          setTaskStatus(it, winder != NULL && winder->getStatus() == Winder::READY ? PAUSED : CANCELLED);
+        }
+        // check doffer
+        Doffer *it = getItemById<Doffer>(ts->idAssignee, m_doffers);
+        if (it != NULL)
+        {
+          // Set doffer status as idle
+          it->setStatus(Doffer::IDLE);
+          // Reset amount of bobbins
+          it->resetAmount();
+        }
+        // Start linked objects
+        activateLinkedObjects(ts, false);
+        break;
+      }
+    case DELIVER_SLEEVE:
+      {
+        // Check sleever
+        Sleever *it = getItemById<Sleever>(ts->idAssignee, m_sleevers);
+        // Set status to idle
+        if (it != NULL)
+          it->setStatus(Sleever::IDLE);
+        // Start linked objects
+        activateLinkedObjects(ts, true);
+        break;
+      }
+    case MOVE_SLEEVER:
+    case MOVE_DOFFER_SLEEVER:
+    case HANDLE_COLLISION:
+      break;
+
+    default:
+      break;
+  }
+  // set task session status
+  setTaskStatus(ts, CANCELLED);
+}
+//_________________________________________________________
+//
+// Append new task session to the queue
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Supervisor::appendTask(TaskSession *ts, qint64 startAfter /*= 0*/)
+{
+  ts->status = NEW;
+  ts->startAfter = startAfter;
+  ts->timeCreated = simTime();
+  ts->timeStarted = -1;
+  ts->timePaused = 0;
+  ts->pauseTotal = 0;
+  ts->pickupPlaces = ts->places;
+  ts->seq = m_taskSeq++;
+  ts->queued = false;
+  ts->prio = getTaskPrio(ts);
+  m_tasks.append(ts);
+  queueTask(ts);
+  if (isManTaskQueued(ts))
+    m_kpi.changeLevel(KpiEngine::MAN_QUEUE, ts->timeCreated, 1);
+  if (isManTask(ts))
+    m_menChanged = true;
+  traceTask(ts);
+}
+//_________________________________________________________
+//
+// Set task session status. All task status changes should
+// go through this method to keep latency and trace consistent
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Supervisor::setTaskStatus(TaskSession *ts, TaskStatus status)
+{
+  TaskStatus prevStatus = ts->status;
+  bool wasQueued = isManTaskQueued(ts);
+  ts->status = status;
+  if (prevStatus != status)
+  {
+    countTaskLatency(ts, prevStatus);
+    // update man-service queue depth
+    bool isQueued = isManTaskQueued(ts);
+    if (wasQueued != isQueued)
+      m_kpi.changeLevel(KpiEngine::MAN_QUEUE, simTime(), isQueued ? 1 : -1);
+    // men get free or busy, their routes are planned again
+    if (isManTask(ts))
+      m_menChanged = true;
+    // the doffer may be sent again when its movement ends
+    if (ts->type == MOVE_DOFFER_SLEEVER && (status == DONE || status == CANCELLED))
+      m_planner.setDispatched(ts->idAssignee, ts->idObject, false);
+  }
+  queueTask(ts);
+  traceTask(ts);
+}
+//_________________________________________________________
+//
+// Return true if the man-service task is waiting for the man
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool Supervisor::isManTaskQueued(TaskSession *ts)
+{
+  if (ts->status != NEW && ts->status != PAUSED) return false;
+  return isManTask(ts);
+}
+//_________________________________________________________
+//
+// Return true if the task is done by a man-service
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool Supervisor::isManTask(TaskSession *ts)
+{
+  switch(ts->type)
+  {
+    case START_WINDER:
+    case ROTATE_SPOOLER:
+    case CHANGE_SPOOLER:
+    case LOAD_SLEEVER:
+    case CUTEDGE_WINDER:
+      return true;
+    default:
+      return false;
+  }
+}
+//_________________________________________________________
+//
+// Return the man-service operation of the task
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ManService::OperFunc Supervisor::getManOperation(TaskSession *ts)
+{
+  switch(ts->type)
+  {
+    case START_WINDER:
+      return ManService::START_WINDER;
+    case ROTATE_SPOOLER:
+      return ManService::ROTATE_SPOOLER;
+    case CHANGE_SPOOLER:
+      return ManService::CHANGE_SPOOLER;
+    case LOAD_SLEEVER:
+      return ManService::LOAD_SLEEVER;
+    case CUTEDGE_WINDER:
+      return ManService::CUT_EDGE;
+    default:
+      return ManService::REACH;
+  }
+}
+//_________________________________________________________
+//
+// Return the object the man-service has to reach for the task
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+PlantItem *Supervisor::getManTaskObject(TaskSession *ts)
+{
+  switch(ts->type)
+  {
+    case START_WINDER:
+    case CUTEDGE_WINDER:
+      // get winder from object id
+      return getItemById<Winder>(ts->idObject, m_winders);
+    case ROTATE_SPOOLER:
+    case CHANGE_SPOOLER:
+      // get spooler from object id
+      return getItemById<Spooler>(ts->idObject, m_spoolers);
+    case LOAD_SLEEVER:
+      // get sleever from object id
+      return getItemById<Sleever>(ts->idObject, m_sleevers);
+    default:
+      return NULL;
+  }
+}
+//_________________________________________________________
+//
+// Plan routes of all men over the pending man tasks and reassign
+// the tasks. Busy men join their routes where the current task ends
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Supervisor::dispatchMen()
+{
+  PROFILE_SCOPE("Supervisor::dispatchMen");
+  m_menChanged = false;
+
+  QVector<ManState> men;
+  foreach(ManService *man, m_men)
+  {
+    ManState state;
+    state.idMan = man->getId();
+    state.x = man->x();
+    // broken men get no route
+    state.speed = m_failures.isDown(man->getId()) ? 0 : man->getSpeed();
+    state.freeIn = man->getTimeToFree();
+    if (man->isMoving())
+    {
+      // the man is walking to the object of the current task
+      state.x = man->getDestX();
+      TaskSession *ts = getItemById<TaskSession>(man->getSession(), m_tasks);
+      if (ts != NULL)
+        state.freeIn += man->getOperationTime(getManOperation(ts));
+    }
+    else if (man->getStatus() == ManService::READY)
+    {
+      // the man called early waits at the spooler until it is full
+      TaskSession *ts = getItemById<TaskSession>(man->getSession(), m_tasks);
+      if (ts != NULL && (ts->type == ROTATE_SPOOLER || ts->type == CHANGE_SPOOLER) && ts->early)
+      {
+        qint64 now = SimClock::now();
+        state.freeIn = int(qMax<qint64>(m_spoolerFillAt.value(ts->idObject, now) - now, 0)) +
+                       man->getOperationTime(getManOperation(ts));
+      }
+    }
+    men.append(state);
+  }
+
+  QVector<ManJob> jobs;
+  foreach(TaskSession *ts, m_tasks)
+  {
+    if (!isManTaskQueued(ts)) continue;
+    PlantItem *obj = getManTaskObject(ts);
+    if (obj == NULL || m_failures.isDown(ts->idObject)) continue;
+    ManJob job;
+    job.idSession = ts->idSession;
+    job.x = obj->x();
+    job.releaseIn = qMax<qint64>(ts->startAfter - SimClock::now(), 0);
+    foreach(ManService *man, m_men)
+      job.durations.append(man->getOperationTime(getManOperation(ts)));
+    jobs.append(job);
+  }
+
+  m_manDispatcher.plan(men, jobs);
+
+  // reassign tasks to the route owners
+  foreach(ManService *man, m_men)
+  {
+    foreach(QString id, m_manDispatcher.route(man->getId()))
+    {
+      TaskSession *ts = getItemById<TaskSession>(id, m_tasks);
+      if (ts != NULL)
+        ts->idAssignee = man->getId();
+    }
+  }
+}
+//_________________________________________________________
+//
+// Start the first pending task of every idle man route. Tasks out of
+// routes, which have objects no longer present, are started to cancel
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Supervisor::serveManTasks()
+{
+  foreach(TaskSession *ts, m_tasks)
+  {
+    if (isManTaskQueued(ts) && getManTaskObject(ts) == NULL)
+      startMachine(ts);
+  }
+
+  qint64 now = SimClock::now();
+  foreach(ManService *man, m_men)
+  {
+    if (man->getStatus() != ManService::IDLE || m_failures.isDown(man->getId())) continue;
+    foreach(QString id, m_manDispatcher.route(man->getId()))
+    {
+      TaskSession *ts = getItemById<TaskSession>(id, m_tasks);
+      if (ts != NULL && isManTaskQueued(ts) && ts->idAssignee == man->getId())
+      {
+        // the man leaves in time to reach the object at the task start
+        PlantItem *obj = getManTaskObject(ts);
+        int walk = (obj != NULL && man->getSpeed() > 0) ? 1000 * abs(obj->x() - man->x()) / man->getSpeed() : 0;
+        if (now + walk >= ts->startAfter)
+          startMachine(ts);
+        break;
+      }
+    }
+  }
+}
+//_________________________________________________________
+//
+// Return the heap of pending tasks of the doffer or sleever, NULL
+// for the tasks started in the queue order
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+PriorityHeap<Supervisor::TaskEntry> *Supervisor::getTaskHeap(TaskSession *ts)
+{
+  switch(ts->type)
+  {
+    case DELIVER_BOBBINS:
+    case MOVE_DOFFER_SLEEVER:
+      return &m_doffingTasks[ts->idAssignee];
+    case DELIVER_SLEEVE:
+    case MOVE_SLEEVER:
+      return &m_sleevingTasks[ts->idAssignee];
+    default:
+      return NULL;
+  }
+}
+//_________________________________________________________
+//
+// Return the task priority from the dense winder priority arrays
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+int Supervisor::getTaskPrio(TaskSession *ts)
+{
+  int index = m_winderIndex.value(ts->idObject, -1);
+  if (index < 0) return lowestPrio;
+  bool doffing = ts->type == DELIVER_BOBBINS || ts->type == MOVE_DOFFER_SLEEVER;
+  return doffing ? m_doffPrio[index] : m_sleeverPrio[index];
+}
+//_________________________________________________________
+//
+// Push the new or paused doffer or sleever task into its heap
+// unless it is already there. Started tasks are resumed first
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Supervisor::queueTask(TaskSession *ts)
+{
+  PriorityHeap<TaskEntry> *heap = getTaskHeap(ts);
+  if (heap == NULL || ts->queued) return;
+  if (ts->status != NEW && ts->status != PAUSED) return;
+
+  TaskEntry entry;
+  entry.prio = ts->timeStarted >= 0 ? startedPrio : ts->prio;
+  entry.seq = ts->seq;
+  entry.ts = ts;
+  heap->push(entry);
+  ts->queued = true;
+}
+//_________________________________________________________
+//
+// Try to start the most important pending task of every doffer or
+// sleever. Entries of tasks which are not pending any more are
+// dropped. The task which can not start is queued back and the scan
+// of the heap stops, its assignee is busy for the tasks below too
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Supervisor::serveTasks(QHash<QString, PriorityHeap<TaskEntry> > &heaps)
+{
+  // started tasks may queue new ones, heaps are looked up by the key
+  foreach(QString idAssignee, heaps.keys())
+  {
+    for(;;)
+    {
+      PriorityHeap<TaskEntry> &heap = heaps[idAssignee];
+      if (heap.isEmpty()) break;
+      TaskSession *ts = heap.pop().ts;
+      ts->queued = false;
+      if (ts->status != NEW && ts->status != PAUSED)
+        continue;
+      startMachine(ts);
+      queueTask(ts);
+      if (ts->queued) break;
+    }
+  }
+}
+//_________________________________________________________
+//
+// Count task latency on the status transition: queue wait
+// (NEW -> PROGRESS), pause time and end-to-end duration
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Supervisor::countTaskLatency(TaskSession *ts, TaskStatus prevStatus)
+{
+  qint64 now = simTime();
+  // pauses before the start are counted as queue wait
+  if (prevStatus == PAUSED && ts->timeStarted >= 0)
+    ts->pauseTotal += now - ts->timePaused;
+
+  switch(ts->status)
+  {
+    case PROGRESS:
+      if (ts->timeStarted < 0)
+      {
+        ts->timeStarted = now;
+        emit updateLatency(taskTypeNames[ts->type], Logger::QUEUE_WAIT, now - ts->timeCreated);
+      }
+      break;
+    case PAUSED:
+      ts->timePaused = now;
+      break;
+    case DONE:
+      emit updateLatency(taskTypeNames[ts->type], Logger::PAUSE_TIME, ts->pauseTotal);
+      emit updateLatency(taskTypeNames[ts->type], Logger::DURATION, now - ts->timeCreated);
+      break;
+    default:
+      break;
+  }
+}
+//_________________________________________________________
+//
+// Record the task session state if trace is recording
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Supervisor::traceTask(TaskSession *ts)
+{
+  if (!TraceRecorder::isRecording()) return;
+
+  QJsonObject args;
+  if (ts->status == DONE || ts->status == CANCELLED)
+  {
+    // close the task session slice
+    args["result"] = taskStatusNames[ts->status];
+    TraceRecorder::setTaskState(ts->idSession, ts->idAssignee, taskTypeNames[ts->type], QString(), args);
+    return;
+  }
+  args["object"] = ts->idObject;
+  args["places"] = ts->places;
+  // collision linking belongs to the group of its doffer
+  args["group"] = ts->type == HANDLE_COLLISION ? ts->idAssignee : getObjectGroup(ts->idObject);
+  TraceRecorder::setTaskState(ts->idSession, ts->idAssignee, taskTypeNames[ts->type], taskStatusNames[ts->status], args);
+}
+//_________________________________________________________
+//
+// Return the doffer group Id of the plant object, empty for men
+// and unknown objects. The sleever group is the one of its winders
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+QString Supervisor::getObjectGroup(const QString &idObject)
+{
+  WinderModel *winder = getItemById<WinderModel>(idObject, m_windersModel);
+  if (winder != NULL) return winder->idDoffer;
+  SpoolerModel *spooler = getItemById<SpoolerModel>(idObject, m_spoolersModel);
+  if (spooler != NULL) return spooler->idDoffer;
+  if (getItemById<DofferModel>(idObject, m_doffersModel) != NULL) return idObject;
+  foreach(WinderModel *it, m_windersModel)
+    if (it->idSleever == idObject) return it->idDoffer;
+  return QString();
+}
+//_________________________________________________________
+//
+// Return the new task session id. Ids are numbered in the creation
+// order, so runs with the same seed reproduce them
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+QString Supervisor::newSessionId()
+{
+  return QString("T%1").arg(++m_sessionSeq);
+}
+//_________________________________________________________
+//
+// Return simulation time since the session start (ms)
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+qint64 Supervisor::simTime()
+{
+  return SimClock::now() * (m_config.timeCoefficient > 0 ? m_config.timeCoefficient : 1);
 }
 //_________________________________________________________
 //
-// Create handle collision task
+// Start trace recording. Current object states and task
+// sessions are recorded first
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-void Supervisor::handleCollision(Doffer *doffer, Sleever *sleever, bool isDofferPriority, bool waitDoffer, bool waitSleever)
+void Supervisor::startTrace()
 {
-  if (doffer == NULL || sleever == NULL) return;
-
-  TaskSession *task = new TaskSession;
-  task->idSession = QUuid::createUuid().toString();
-  task->status = NEW;
-  task->type = HANDLE_COLLISION;
-  task->idAssignee = doffer->getId();
-  task->idObject = sleever->getId();
-  task->places = isDofferPriority;
-  task->waitDoffer = waitDoffer;
-  task->waitSleever = waitSleever;
-  m_tasks.append(task);
+  TraceRecorder::start();
+  foreach(Winder *it, m_winders)
+    it->setStatus(it->getStatus());
+  foreach(Doffer *it, m_doffers)
+    it->setStatus(it->getStatus());
+  foreach(Sleever *it, m_sleevers)
+    it->setStatus(it->getStatus());
+  foreach(ManService *it, m_men)
+    it->setStatus(it->getStatus());
+  foreach(TaskSession *ts, m_tasks)
+    traceTask(ts);
 }
 //_________________________________________________________
 //
-// Slot activates removing of failed winder doffering or sleever tasks
+// Stop trace recording, the recorder is saved by the caller
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-void Supervisor::winderFailed(QString idWinder)
+void Supervisor::stopTrace()
 {
-  // Cancel all new doffer & sleever tasks with this winder
-  foreach (TaskSession *ts, m_tasks) {
-    if (ts->idObject == idWinder && ts->status == NEW &&
-       (ts->type == DELIVER_BOBBINS || ts->type == DELIVER_SLEEVE))
-      cancelTask(ts);
+  TraceRecorder::stop();
+}
+//_________________________________________________________
+//
+// Render the whole plant layout into the image without window.
+// The layout is scaled to the image size
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Supervisor::renderTo(QImage &image)
+{
+  PROFILE_SCOPE("Supervisor::renderTo");
+  if (m_layoutSize.isEmpty() || image.isNull()) return;
+
+  QPainter painter;
+  QRect layout(QPoint(0, 0), m_layoutSize);
+  captureState(m_snapshot);
+
+  image.fill(QApplication::palette().color(QPalette::Window));
+  painter.begin(&image);  // open drawing context
+  painter.scale((double)image.width() / m_layoutSize.width(), (double)image.height() / m_layoutSize.height());
+  drawState(painter, layout, true, m_snapshot);
+  painter.end();          // close drawing context
+}
+//_________________________________________________________
+//
+// Draw plant objects in the state which intersect the exposed area
+// given in layout coordinates. The state is captured by this or the
+// running plant of the same layout. Objects are drawn with the state
+// swapped in, so the live plant is never read while it is drawn
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Supervisor::drawState(QPainter &painter, const QRect &exposed, bool detailed, QVector<qint32> &state)
+{
+  PROFILE_SCOPE("Supervisor::drawState");
+
+  // draw service zones, all of them have the same cached artwork
+  foreach(const QRect &it, m_services)
+  {
+    if (it.intersects(exposed))
+      painter.drawPixmap(it.topLeft(), getServiceZonePixmap(it.size()));
+  }
+  int offset = getItemsStateSize();
+  if (state.size() <= offset) return;
+
+  // draw plant objects in the former widget stacking order
+  qint32 *words = state.data();
+  drawItemStates<Winder>(painter, m_winders, exposed, detailed, words);
+  drawItemStates<Doffer>(painter, m_doffers, exposed, detailed, words);
+  drawItemStates<Sleever>(painter, m_sleevers, exposed, detailed, words);
+  drawItemStates<Spooler>(painter, m_spoolers, exposed, detailed, words);
+  drawItemStates<ManService>(painter, m_men, exposed, detailed, words);
+  if (!detailed) return;
+
+  // draw doffer and sleever animations over everything, they follow the task queue
+  offset += 1 + 2 * state.at(offset);
+  if (offset >= state.size()) return;
+  Animator anim;
+  int count = state.at(offset++);
+  for(int i = 0; i < count && offset + Animator::stateSize() <= state.size(); i++, offset += Animator::stateSize())
+  {
+    anim.restoreState(words + offset);
+    anim.render(painter, exposed);
   }
 }
 //_________________________________________________________
 //
-// Cancel task session
-// - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-void Supervisor::cancelTask(TaskSession *ts)
+// Collect the compact plant state: objects in the drawing order
+// followed by the task queue (amount, then type and status pairs)
+// and running animations (amount, then their states)
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Supervisor::captureState(QVector<qint32> &state)
 {
-  if (ts == NULL) return;
-  //qDebug() << "<====== Cancelled " << ts->type << ts->idAssignee << ts->idObject << ts->idSession;
+  PROFILE_SCOPE("Supervisor::captureState");
 
-  switch(ts->type)
+  state.resize(0);
+  saveItemStates<Winder>(m_winders, state);
+  saveItemStates<Doffer>(m_doffers, state);
+  saveItemStates<Sleever>(m_sleevers, state);
+  saveItemStates<Spooler>(m_spoolers, state);
+  saveItemStates<ManService>(m_men, state);
+
+  state.append(m_tasks.size());
+  foreach(TaskSession *ts, m_tasks)
   {
-    case START_WINDER:
-    case ROTATE_SPOOLER:
-    case CHANGE_SPOOLER:
-    case LOAD_SLEEVER:
-    case CUTEDGE_WINDER:
-      {
-        // For man service cancelling leads to idle status
-        // Check man-service
-        ManService *it = getItemById<ManService>(ts->idAssignee, m_men);
-        // Set status as idle
-        if (it != NULL)
-          it->setStatus(ManService::IDLE);
-        break;
-      }
-    case DELIVER_BOBBINS:
-      {
-        // cancel possible spooler reserve
-        cancelSpoolerReservation(ts->reserve);
-        // check doffer
-        Doffer *it = getItemById<Doffer>(ts->idAssignee, m_doffers);
-        if (it != NULL)
-        {
-          // Set doffer status as idle
-          it->setStatus(Doffer::IDLE);
-          // Reset amount of bobbins
-          it->resetAmount();
-        }
-        // Start linked objects
-        activateLinkedObjects(ts, false);
-        break;
-      }
-    case DELIVER_SLEEVE:
-      {
-        // Check sleever
-        Sleever *it = getItemById<Sleever>(ts->idAssignee, m_sleevers);
-        // Set status to idle
-        if (it != NULL)
-          it->setStatus(Sleever::IDLE);
-        // Start linked objects
-        activateLinkedObjects(ts, true);
-        break;
-      }
-    case MOVE_SLEEVER:
-    case MOVE_DOFFER_SLEEVER:
-    case HANDLE_COLLISION:
-      break;
+    state.append(ts->type);
+    state.append(ts->status);
+  }
 
-    default:
-      break;
+  int animations = state.size();
+  state.append(0);
+  foreach(Doffer *it, m_doffers)
+  {
+    if (!it->getAnimator().isActive()) continue;
+    it->getAnimator().saveState(state);
+    state[animations]++;
   }
-  // set task session status
-  ts->status = CANCELLED;
+  foreach(Sleever *it, m_sleevers)
+  {
+    if (!it->getAnimator().isActive()) continue;
+    it->getAnimator().saveState(state);
+    state[animations]++;
+  }
+}
+//_________________________________________________________
+//
+// Return the amount of object state words, the task queue follows them
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+int Supervisor::getItemsStateSize()
+{
+  return getStateSize<Winder>(m_winders) + getStateSize<Doffer>(m_doffers) + getStateSize<Sleever>(m_sleevers) +
+         getStateSize<Spooler>(m_spoolers) + getStateSize<ManService>(m_men);
+}
+//_________________________________________________________
+//
+// Return the cached service zone frame of the size
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+QPixmap Supervisor::getServiceZonePixmap(const QSize &size)
+{
+  QString key = QString("szone/%1x%2").arg(size.width()).arg(size.height());
+  QPixmap pixmap;
+  if (QPixmapCache::find(key, &pixmap))
+    return pixmap;
+
+  QPainter painter;
+  pixmap = QPixmap(size);
+  pixmap.fill(Qt::transparent);
+  painter.begin(&pixmap);   // open drawing context
+  qDrawShadeRect(&painter, QRect(QPoint(0, 0), size), QApplication::palette(), true, 1, 0);
+  painter.end();            // close drawing context
+
+  QPixmapCache::insert(key, pixmap);
+  return pixmap;
 }
 //_________________________________________________________
 //
@@ -875,13 +1974,20 @@ void Supervisor::cancelTask(TaskSession *ts)
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void Supervisor::timerEvent(QTimerEvent* te)
 {
+  PROFILE_SCOPE("Supervisor::timerEvent");
+  // simulation clock tick. The clock follows the wall clock while
+  // the event loop keeps up, a longer stall is advanced by one step.
+  // Due simulation timers are delivered within the tick
+  if (te->timerId() == m_clock_timer)
+    SimClock::advance(qMin<qint64>(m_wallClock.restart(), maxClockStep));
   // supervisor task management timer
   if (te->timerId() == m_task_timer)
   {
-    // delete cancelled and done tasks from queue
+    // delete cancelled and done tasks from queue. Tasks left in
+    // the heaps are deleted after they are popped
     for(QList<TaskSession *>::iterator it = m_tasks.begin(); it != m_tasks.end();)
     {
-      if ((*it)->status == DONE || (*it)->status == CANCELLED)
+      if (((*it)->status == DONE || (*it)->status == CANCELLED) && !(*it)->queued)
       {
         //qDebug() << "Delete " << (*it)->idSession << (*it)->status;
         delete (*it);
@@ -890,26 +1996,68 @@ void Supervisor::timerEvent(QTimerEvent* te)
       else
         ++it;
     }
-    // try to start every new or paused task
+    // send idle doffers to the winders which complete next
+    planDepartures();
+    // call men to carriers which are going to be full
+    forecastCarriers();
+    // try to start every new or paused collision task
     foreach (TaskSession *ts, m_tasks)
     {
-      if (ts->status == NEW || ts->status == PAUSED)
+      if ((ts->status == NEW || ts->status == PAUSED) && getTaskHeap(ts) == NULL && !isManTask(ts))
         startMachine(ts);
     }
-  }
+    // man tasks are reassigned after changes and started in the route order
+    if (m_menChanged)
+      dispatchMen();
+    serveManTasks();
+    // doffer & sleever tasks are started in the winder priority order
+    serveTasks(m_doffingTasks);
+    serveTasks(m_sleevingTasks);
+  }
+  // breakdown and repair events
+  if (te->timerId() == m_failure_timer)
+    processFailures();
   // database update timer
   if (te->timerId() == m_db_timer)
   {
     // update doffer & sleever models
     sync();
+    // notify about new KPI values, they are sent by value to the window thread
+    QList<KpiValue> values;
+    getKpiValues(values);
+    emit kpiUpdated(values);
+  }
+  // canvas frame timer. Objects only invalidate their areas while
+  // the simulation runs, the frame carries the plant state and the
+  // invalidated area to the canvas, which never reads the live plant
+  if (te->timerId() == m_frame_timer)
+  {
+    // winding progress is counted from the clock while the state is captured
+    PlantFrame &frame = m_frames.back();
+    captureState(frame.state);
+    frame.seq = ++m_frameSeq;
+    frame.time = simTime();
+    frame.dirty = m_dirtyRect;
+    m_frames.publish();
+    m_dirtyRect = QRect();
+    emit frameReady();
   }
 }
 //_________________________________________________________
 //
+// Collect the invalidated area to repaint it with the next frame
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Supervisor::invalidate(const QRect &rect)
+{
+  m_dirtyRect = m_dirtyRect.united(rect);
+}
+//_________________________________________________________
+//
 // Private task starter
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void Supervisor::startMachine(TaskSession *ts)
 {
+  PROFILE_SCOPE("Supervisor::startMachine");
   switch(ts->type)
   {
     case START_WINDER:
@@ -940,6 +2088,7 @@ void Supervisor::startMachine(TaskSession *ts)
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void Supervisor::runManServiceTask(TaskSession *ts)
 {
+  PROFILE_SCOPE("Supervisor::runManServiceTask");
   // cancel task if man-service is wrong
   ManService *man = getItemById<ManService>(ts->idAssignee, m_men);
   if (man == NULL)
@@ -957,33 +2106,14 @@ void Supervisor::runManServiceTask(TaskSession *ts)
     else
     {*/
       // assigned man is not available yet
-      ts->status = PAUSED;
+      setTaskStatus(ts, PAUSED);
       return;
     //}
   }
   // set to progress
-  ts->status = PROGRESS;
+  setTaskStatus(ts, PROGRESS);
 
-  QFrame *obj = NULL;
-  switch(ts->type)
-  {
-    case START_WINDER:
-    case CUTEDGE_WINDER:
-      // get winder from object id
-      obj = getItemById<Winder>(ts->idObject, m_winders);
-      break;
-    case ROTATE_SPOOLER:
-    case CHANGE_SPOOLER:
-      // get spooler from object id
-      obj = getItemById<Spooler>(ts->idObject, m_spoolers);
-      break;
-    case LOAD_SLEEVER:
-      // get sleever from object id
-      obj = getItemById<Sleever>(ts->idObject, m_sleevers);
-      break;
-    default:
-      break;
-  }
+  PlantItem *obj = getManTaskObject(ts);
   // if object is wrong cancel task
   if (obj == NULL)
   {
@@ -993,23 +2123,41 @@ void Supervisor::runManServiceTask(TaskSession *ts)
 
   //set man-service status to ready
   man->setStatus(ManService::READY);
-  man->update();
+  man->refresh();
   // call reaching object method
   man->reachObject(ts->idSession, obj->x(), obj->y());
 }
 //_________________________________________________________
 //
-// Create spooler reservation
+// Create spooler reservation for the package recipe. The carrier which
+// took the last package of the recipe is tried first, other spoolers
+// of the doffer are scanned only when it is full or released
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-bool Supervisor::tryReserveSpooler(QString idSpooler, SpoolerReservation &spres)
+bool Supervisor::tryReserveCarrier(QString idDoffer, QString idRecipe, SpoolerReservation &spres)
 {
-  // check spooler
-  Spooler *spooler = getItemById<Spooler>(idSpooler, m_spoolers);
-  if (spooler == NULL) return false;
+  QString key = idDoffer + "/" + idRecipe;
+  Spooler *carrier = m_recipeCarriers.value(key, NULL);
+  if (carrier != NULL && carrier->getRecipe() == idRecipe &&
+      carrier->reserve(idRecipe, spres.row, spres.column))
+  {
+    spres.idSpooler = carrier->getId();
+    return true;
+  }
 
-  // init spooler reservation structure
-  spres.idSpooler = spooler->getId();
-  return spooler->reserve(spres.row, spres.column);
+  // find the next spooler accepting the recipe, empty spoolers
+  // kept for other recipes by the forecast are skipped
+  foreach(Spooler *it, m_dofferSpoolers.value(idDoffer))
+  {
+    QString keptFor = m_spareCarriers.value(it->getId());
+    if (!keptFor.isEmpty() && keptFor != idRecipe) continue;
+    if (it != carrier && it->reserve(idRecipe, spres.row, spres.column))
+    {
+      m_recipeCarriers.insert(key, it);
+      spres.idSpooler = it->getId();
+      return true;
+    }
+  }
+  return false;
 }
 //_________________________________________________________
 //
@@ -1029,10 +2177,84 @@ void Supervisor::cancelSpoolerReservation(QVector<SpoolerReservation> &resarray)
 }
 //_________________________________________________________
 //
+// Merge pending doffing tasks of other ready winders into the trip
+// up to the doffer capacity. Winders are taken from the nearest one.
+// Cells of every winder are reserved completely or not at all. The
+// merged tasks are linked to the trip session which collects their
+// bobbins, each one is done when its bobbins are aboard
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Supervisor::collectPickups(TaskSession *ts, Doffer *doffer)
+{
+  Winder *first = getItemById<Winder>(ts->idObject, m_winders);
+  if (first == NULL) return;
+  int amount = ts->places;
+
+  // pending doffing tasks of the doffer with ready bobbins, the nearest first
+  QList<TaskSession *> candidates;
+  foreach(TaskSession *it, m_tasks)
+  {
+    if (it == ts || it->type != DELIVER_BOBBINS || it->idAssignee != ts->idAssignee) continue;
+    if (it->status != NEW && it->status != PAUSED) continue;
+    if (it->places == 0 || amount + it->places > doffer->getCapacity()) continue;
+    Winder *winder = getItemById<Winder>(it->idObject, m_winders);
+    if (winder == NULL || winder->getStatus() != Winder::READY) continue;
+
+    int distance = qAbs(winder->x() - first->x());
+    int i = 0;
+    while (i < candidates.size() &&
+           qAbs(getItemById<Winder>(candidates[i]->idObject, m_winders)->x() - first->x()) <= distance)
+      i++;
+    candidates.insert(i, it);
+  }
+
+  foreach(TaskSession *it, candidates)
+  {
+    if (amount + it->places > doffer->getCapacity()) continue;
+    Winder *winder = getItemById<Winder>(it->idObject, m_winders);
+
+    // reserve all cells of the winder bobbins
+    Pickup pickup;
+    pickup.idWinder = it->idObject;
+    pickup.places = it->places;
+    for(int counter = it->places; counter > 0; counter--)
+    {
+      SpoolerReservation spres;
+      if (!tryReserveCarrier(ts->idAssignee, winder->getRecipe(), spres))
+        break;
+      pickup.reserve.append(spres);
+    }
+    if (pickup.reserve.size() < pickup.places)
+    {
+      cancelSpoolerReservation(pickup.reserve);
+      continue;
+    }
+
+    // the trip session takes over the task
+    ts->pickups.append(pickup);
+    amount += it->places;
+    it->idTrip = ts->idSession;
+    setTaskStatus(it, PROGRESS);
+  }
+}
+//_________________________________________________________
+//
+// Return the merged task of the winder collected by the trip, NULL
+// for the winder of the trip session itself
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Supervisor::TaskSession *Supervisor::getPickupTask(TaskSession *trip, const QString &idWinder)
+{
+  foreach(TaskSession *it, m_tasks)
+    if (it->idTrip == trip->idSession && it->idObject == idWinder && it->status == PROGRESS)
+      return it;
+  return NULL;
+}
+//_________________________________________________________
+//
 // Private task starter for doffer
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void Supervisor::runDofferingTask(TaskSession *ts)
 {
+  PROFILE_SCOPE("Supervisor::runDofferingTask");
   // check if doffer & winder correct. If not cancel task
   Doffer *doffer = getItemById<Doffer>(ts->idAssignee, m_doffers);
   Winder *winder = getItemById<Winder>(ts->idObject, m_winders);
@@ -1045,11 +2267,11 @@ void Supervisor::runDofferingTask(TaskSession *ts)
   //qDebug() << "Doffer task ====================";
   //qDebug() << ts->type << ts->idAssignee << ts->idObject << ts->status << ts->idSession ;
 
-  // if doffer is linked pause task
-  if (testObjectId(doffer->getId()))
+  // if doffer is linked or broken pause task
+  if (testObjectId(doffer->getId()) || m_failures.isDown(doffer->getId()))
   {
     //qDebug() << doffer->getId() << "has been linked -- pausing" << ts->type << ts->idSession;
-    ts->status = PAUSED;
+    setTaskStatus(ts, PAUSED);
     return;
   }
 
@@ -1060,7 +2282,7 @@ void Supervisor::runDofferingTask(TaskSession *ts)
       // jump to doffer arrived routine if doffer waits for winder ready
       if (doffer->getStatus() == Doffer::WAITWINDER && !doffer->isMoving())
       {
-        ts->status = PROGRESS;
+        setTaskStatus(ts, PROGRESS);
         dofferArrived(ts->idSession);
         return;
       }
@@ -1072,13 +2294,13 @@ void Supervisor::runDofferingTask(TaskSession *ts)
       }
 
       // set task to progress
-      ts->status = PROGRESS;
+      setTaskStatus(ts, PROGRESS);
       //qDebug() << "MOVE_DOFFER_SLEEVER " << winder->getId() << ts->idSession;
       // reach the winder
       moveDofferAndSleever(ts->idSession, winder->getId(), winder->getBobbinsRect().topLeft(), false);
       // set doffer status to winder waiting
       doffer->setStatus(Doffer::WAITWINDER);
-      doffer->update();
+      doffer->refresh();
       break;
     }
     case DELIVER_BOBBINS:   // reach the winder, take bobbins and deliver them to spooler
@@ -1086,15 +2308,23 @@ void Supervisor::runDofferingTask(TaskSession *ts)
       // if doffer is waiting for sleever jump to doffer arrived routine
       if (doffer->getStatus() == Doffer::WAIT)
       {
-        ts->status = PROGRESS;
+        setTaskStatus(ts, PROGRESS);
         doffer->setStatus(doffer->getAmount() > 0 ? Doffer::DELIVER : Doffer::READY);
         dofferArrived(ts->idSession);
         return;
       }
+      // the batched trip goes on to the winder of the next pickup
+      if (doffer->getStatus() == Doffer::READY && ts->timeStarted >= 0 && !doffer->isMoving())
+      {
+        setTaskStatus(ts, PROGRESS);
+        if (!moveDofferAndSleever(ts->idSession, winder->getId(), winder->getBobbinsRect().topLeft(), true, false))
+          setTaskStatus(ts, PAUSED);
+        return;
+      }
       // pause task if doffer is not idle
       if (doffer->getStatus() != Doffer::IDLE)
       {
-        ts->status = PAUSED;
+        setTaskStatus(ts, PAUSED);
         return;
       }
       // stop doffer if doffer is moving
@@ -1102,36 +2332,33 @@ void Supervisor::runDofferingTask(TaskSession *ts)
       if (doffer->isMoving())
       {
         doffer->stopMoving(false);
-        ts->status = PAUSED;
+        setTaskStatus(ts, PAUSED);
         return;
       }
 
-      // reserve spooler positions depending on bobbins amount
+      // reserve spooler positions of the winder recipe depending on bobbins amount
       int counter = ts->places;
       ts->reserve.clear();
-      foreach(SpoolerModel *spl, m_spoolersModel)
+      for(; counter > 0; counter--)
       {
         SpoolerReservation spres;
-        if (spl->idDoffer == ts->idAssignee)
-          for(; counter > 0; counter--)
-          {
-            if (!tryReserveSpooler(spl->idSpooler, spres))
-              break;
-            ts->reserve.append(spres);
-          }
-        if (counter == 0) break;
+        if (!tryReserveCarrier(ts->idAssignee, winder->getRecipe(), spres))
+          break;
+        ts->reserve.append(spres);
       }
 
       // pause task if reservation failed
       if (counter > 0)
       {
         cancelSpoolerReservation(ts->reserve);
-        ts->status = PAUSED;
+        setTaskStatus(ts, PAUSED);
         return;
       }
+      // take bobbins of other ready winders in the same trip
+      collectPickups(ts, doffer);
 
       // set task to progress
-      ts->status = PROGRESS;
+      setTaskStatus(ts, PROGRESS);
       // set doffer state to ready
       doffer->setStatus(Doffer::READY);
       // set bobbins size for animation
@@ -1139,7 +2366,7 @@ void Supervisor::runDofferingTask(TaskSession *ts)
       //qDebug() << "DELIVER_BOBBINS to " << winder->getId() << ts->idSession;
       // reach the winder
       moveDofferAndSleever(ts->idSession, winder->getId(), winder->getBobbinsRect().topLeft(), true);
-      doffer->update();
+      doffer->refresh();
       break;
     }
     default:
@@ -1150,28 +2377,29 @@ void Supervisor::runDofferingTask(TaskSession *ts)
 //
 // Move doffer and sleever to the winder position
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-void Supervisor::moveDofferAndSleever(QString idDofferSession, QString idWinder, QPoint dest, bool allowReadyDoffer)
+bool Supervisor::moveDofferAndSleever(QString idDofferSession, QString idWinder, QPoint dest, bool allowReadyDoffer, bool withSleever /*= true*/)
 {
   // find session
   TaskSession *ts = getItemById<TaskSession>(idDofferSession, m_tasks);
   // find winder model
   WinderModel *it = getItemById<WinderModel>(idWinder, m_windersModel);
-  if (it == NULL) return;
+  if (it == NULL) return false;
 
   // find winder, doffer, sleever
   Winder *winder = getItemById<Winder>(idWinder, m_winders);
   Doffer *doffer = getItemById<Doffer>(it->idDoffer, m_doffers);
   Sleever *sleever = getItemById<Sleever>(it->idSleever, m_sleevers);
-  if (winder == NULL || doffer == NULL || sleever == NULL) return;
+  if (winder == NULL || doffer == NULL || sleever == NULL) return false;
 
   // consider if moving is possible
   bool moveDoffer = ((allowReadyDoffer && doffer->getStatus() == Doffer::READY) ||
                      (doffer->getStatus() == Doffer::IDLE)) &&
-                     !doffer->isMoving() && !testObjectId(doffer->getId());
-  bool moveSleever = (sleever->getStatus() == Sleever::IDLE ||
+                     !doffer->isMoving() && !testObjectId(doffer->getId()) && !m_failures.isDown(doffer->getId());
+  bool moveSleever = withSleever &&
+                     (sleever->getStatus() == Sleever::IDLE ||
                       sleever->getStatus() == Sleever::PREPARING) &&
-                    !sleever->isMoving() && !testObjectId(sleever->getId());
-  if (!moveDoffer && !moveSleever) return;
+                    !sleever->isMoving() && !testObjectId(sleever->getId()) && !m_failures.isDown(sleever->getId());
+  if (!moveDoffer && !moveSleever) return false;
 
   // calculate new sleever position
   int sleeverX = countNewSleeverX(ts, doffer, sleever, dest.x());
@@ -1180,6 +2408,7 @@ void Supervisor::moveDofferAndSleever(QString idDofferSession, QString idWinder,
     doffer->reachObject(idDofferSession, dest.x(), dest.y());
   if (moveDoffer && moveSleever)
     sleever->reachObject("", sleeverX, sleever->y(), false);
+  return moveDoffer;
 }
 //_________________________________________________________
 //
@@ -1199,16 +2428,12 @@ int Supervisor::countNewSleeverX(TaskSession *ts, Doffer *doffer, Sleever *sleev
     xOffset = ts->reserve[0].column * spooler->getCellWidth();
   }
   else  //otherwise get the first spooler position
-    foreach(SpoolerModel *spl, m_spoolersModel)
-    {
-      if (spl->idDoffer == doffer->getId())
-      {
-        // if spooler not found take the sleever position
-        spooler = getItemById<Spooler>(spl->idSpooler, m_spoolers);
-        if (spooler == NULL) return sleever->x();
-        break;
-      }
-    }
+  {
+    // if spooler not found take the sleever position
+    QList<Spooler *> group = m_dofferSpoolers.value(doffer->getId());
+    if (group.isEmpty()) return sleever->x();
+    spooler = group.first();
+  }
   // update the offset
   xOffset+=spooler->x();
 
@@ -1221,6 +2446,7 @@ int Supervisor::countNewSleeverX(TaskSession *ts, Doffer *doffer, Sleever *sleev
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void Supervisor::runSleeverTask(TaskSession *ts)
 {
+  PROFILE_SCOPE("Supervisor::runSleeverTask");
   // qDebug() << "Sleever task ====================";
   // qDebug() << ts->type << ts->idAssignee << ts->idObject << ts->status << ts->idSession ;
 
@@ -1231,11 +2457,11 @@ void Supervisor::runSleeverTask(TaskSession *ts)
     cancelTask(ts);
     return;
   }
-  // if sleever is linked pause task
-  if (testObjectId(sleever->getId()))
+  // if sleever is linked or broken pause task
+  if (testObjectId(sleever->getId()) || m_failures.isDown(sleever->getId()))
   {
     //qDebug() << sleever->getId() << "has been linked -- pausing";
-    ts->status = PAUSED;
+    setTaskStatus(ts, PAUSED);
     return;
   }
 
@@ -1253,7 +2479,7 @@ void Supervisor::runSleeverTask(TaskSession *ts)
         // check if sleever is not idle and not wait for doffer. If so, pause task
         if (sleever->getStatus() != Sleever::IDLE && sleever->getStatus() != Sleever::WAIT)
         {
-          ts->status = PAUSED;
+          setTaskStatus(ts, PAUSED);
           return;
         }
         // if sleever is moving then stop it
@@ -1261,15 +2487,15 @@ void Supervisor::runSleeverTask(TaskSession *ts)
         if (sleever->isMoving())
         {
           sleever->stopMoving(false);
-          ts->status = PAUSED;
+          setTaskStatus(ts, PAUSED);
           return;
         }
 
         // set task to progress
-        ts->status = PROGRESS;
+        setTaskStatus(ts, PROGRESS);
         // set sleever state to ready
         sleever->setStatus(Sleever::READY);
-        sleever->update();
+        sleever->refresh();
         // set bobbins size for animation
         sleever->setBobbinsSize(winder->getBobbinsRect().size());
         // reach the winder
@@ -1290,21 +2516,21 @@ void Supervisor::runSleeverTask(TaskSession *ts)
         if (sleever->isMoving())
         {
           sleever->stopMoving(false);
-          ts->status = PAUSED;
+          setTaskStatus(ts, PAUSED);
           return;
         }
 
         //get the nearest service zone
-        int nearestService = m_services.last()->x();
+        int nearestService = m_services.last().x();
         // calculate delta for each service zone to find minimum
-        foreach(QFrame *it, m_services)
+        foreach(const QRect &it, m_services)
         {
-          int delta = it->x() - sleever->x();
-          if ((delta >= 0 && it->x() < nearestService))
-            nearestService = it->x();
+          int delta = it.x() - sleever->x();
+          if ((delta >= 0 && it.x() < nearestService))
+            nearestService = it.x();
         }
         // set task to progress
-        ts->status = PROGRESS;
+        setTaskStatus(ts, PROGRESS);
         //qDebug() << "MOVE_SLEEVER to service zone" << ts->idSession;
         // send sleever to service zone
         sleever->reachObject(ts->idSession, nearestService, 0);
@@ -1331,6 +2557,13 @@ void Supervisor::manReached(QString idSession)
     cancelTask(ts);
     return;
   }
+  // the man called in advance waits until the spooler is full
+  if (ts->type == ROTATE_SPOOLER || ts->type == CHANGE_SPOOLER)
+  {
+    Spooler *spooler = getItemById<Spooler>(ts->idObject, m_spoolers);
+    if (spooler != NULL && !spooler->isFilledUp())
+      return;
+  }
   // Man has been reached the object. Run the object action
   switch(ts->type)
   {
@@ -1363,7 +2596,7 @@ void Supervisor::manReached(QString idSession)
       if (spooler != NULL)
       {
         spooler->setStatus(Spooler::BUSY);
-        spooler->update();
+        spooler->refresh();
       }
       break;
     }
@@ -1407,7 +2640,7 @@ void Supervisor::taskCompleted(QString idSession)
           winder->setStatus(Winder::READY);
           // switch off the cut edge mode
           winder->setCutEdgeMode(false);
-          winder->update();
+          winder->refresh();
           // check if the whole winder group is ready to call the doffer
           setGroupBobbinsReady(winder->getId());
         }
@@ -1424,7 +2657,7 @@ void Supervisor::taskCompleted(QString idSession)
           spooler->replace();
           // change status
           spooler->setStatus(Spooler::PROGRESS);
-          spooler->update();
+          spooler->refresh();
           // re-order spoolers thus the empty one become the last
           moveSpoolerToTail(spooler->getId());
         }
@@ -1440,7 +2673,7 @@ void Supervisor::taskCompleted(QString idSession)
         item->setInventory(it->sleeveSlots, it->rings);
         // change status
         item->setStatus(Sleever::IDLE);
-        item->update();
+        item->refresh();
         break;
       }
     case DELIVER_BOBBINS:   // doffer has finished delivering
@@ -1450,7 +2683,10 @@ void Supervisor::taskCompleted(QString idSession)
           // run spooler putdown action for existing reservation
           Spooler *spooler = getItemById<Spooler>(ts->reserve[0].idSpooler, m_spoolers);
           if (spooler != NULL)
+          {
             spooler->putdown(ts->reserve[0].row, ts->reserve[0].column);
+            m_kpi.count(KpiEngine::BOBBINS_PLACED, simTime());
+          }
         }
         // activate linked objects
         activateLinkedObjects(ts, false);
@@ -1485,7 +2721,7 @@ void Supervisor::taskCompleted(QString idSession)
     default:
       break;
   }
-  ts->status = DONE;
+  setTaskStatus(ts, DONE);
 }
 //_________________________________________________________
 //
@@ -1546,6 +2782,9 @@ void Supervisor::dofferArrived(QString idSession)
       newX = dofferRect.right() + (m_margin << 1);
       askMove = true;
     }
+    // the sleever may stay beside the doffer on the passing lane
+    if (askMove && canSleeverPass(doffer))
+      askMove = false;
 
     if (askMove)
     {
@@ -1568,7 +2807,7 @@ void Supervisor::dofferArrived(QString idSession)
       }
 
       // pause task
-      ts->status = PAUSED;
+      setTaskStatus(ts, PAUSED);
       doffer->setStatus(Doffer::WAIT);
       return;
     }
@@ -1578,7 +2817,7 @@ void Supervisor::dofferArrived(QString idSession)
          sleever->getStatus() == Sleever::PREPARING) )
     {
       // sleever goes to doffer, need to wait for it
-      ts->status = PAUSED;
+      setTaskStatus(ts, PAUSED);
       doffer->setStatus(Doffer::WAIT);
       return;
     }
@@ -1595,9 +2834,9 @@ void Supervisor::dofferArrived(QString idSession)
     }
     // update winder status
     winder->setStatus(Winder::EMPTY);
-    winder->update();
+    winder->refresh();
     // start getting bobbins subtask
-    doffer->getResult(idSession, ts->places);
+    doffer->getResult(idSession, ts->pickupPlaces);
   }
   else if (doffer->getStatus() == Doffer::DELIVER)  // doffer reached the spooler and ready to put bobbins
   {
@@ -1632,7 +2871,7 @@ void Supervisor::dofferArrived(QString idSession)
     // wait for winder if it's not ready
     if (winder->getStatus() != Winder::READY)
     {
-      ts->status = PAUSED;
+      setTaskStatus(ts, PAUSED);
       return;
     }
     // complete task
@@ -1665,9 +2904,43 @@ void Supervisor::bobbinsAboard(QString idSession)
     return;
   }
 
+  // count doffed bobbins, the merged task of the winder is done
+  m_kpi.count(KpiEngine::BOBBINS_DOFFED, simTime(), ts->pickupPlaces);
+  TaskSession *merged = getPickupTask(ts, ts->idObject);
+  if (merged != NULL)
+    setTaskStatus(merged, DONE);
+
   // create sleever task
   callSleever(ts->idObject);
 
+  // reach the next winder of the batched trip
+  while (!ts->pickups.isEmpty())
+  {
+    Pickup next = ts->pickups.first();
+    ts->pickups.remove(0);
+    Winder *winder = getItemById<Winder>(next.idWinder, m_winders);
+    if (winder == NULL || winder->getStatus() != Winder::READY)
+    {
+      // the winder has failed meanwhile, skip it
+      cancelSpoolerReservation(next.reserve);
+      merged = getPickupTask(ts, next.idWinder);
+      if (merged != NULL)
+        setTaskStatus(merged, CANCELLED);
+      continue;
+    }
+    ts->idObject = next.idWinder;
+    ts->pickupPlaces = next.places;
+    ts->places += next.places;
+    ts->reserve += next.reserve;
+    doffer->setStatus(Doffer::READY);
+    doffer->setBobbinsSize(winder->getBobbinsRect().size());
+    // the sleever stays for the sleeve just called, the task is
+    // resumed by the scan if the doffer can not go now
+    if (!moveDofferAndSleever(ts->idSession, next.idWinder, winder->getBobbinsRect().topLeft(), true, false))
+      setTaskStatus(ts, PAUSED);
+    return;
+  }
+
   // start reaching subtask
   doffer->reachObject(ts->idSession, spooler->x() + ts->reserve[0].column * spooler->getCellWidth(), spooler->y());
 }
@@ -1699,6 +2972,7 @@ void Supervisor::bobbinPlaced(QString idSession)
   }
   // run spooler action and set cell status
   spooler->putdown(ts->reserve[0].row, ts->reserve[0].column);
+  m_kpi.count(KpiEngine::BOBBINS_PLACED, simTime());
 
   // reach this or another destination spooler
   ts->places--;
@@ -1785,9 +3059,9 @@ void Supervisor::sleeverArrived(QString idSession)
         }
 
         //pause task
-        ts->status = PAUSED;
+        setTaskStatus(ts, PAUSED);
         sleever->setStatus(Sleever::WAIT);
-        sleever->update();
+        sleever->refresh();
         return;
       }
     }
@@ -1885,6 +3159,7 @@ void Supervisor::activateLinkedObjects(TaskSession *ts, bool isDofferLinked)
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void Supervisor::runHandleCollisionTask(TaskSession *ts)
 {
+  PROFILE_SCOPE("Supervisor::runHandleCollisionTask");
   //qDebug() << "HANDLE_COLLISION" << ts->type << ts->idAssignee << ts->idObject << ts->status << ts->idSession ;
 
   // cancel task if doffer or sleever are wrong
@@ -1897,16 +3172,17 @@ void Supervisor::runHandleCollisionTask(TaskSession *ts)
     return;
   }
 
-  // pause task if doffer or sleever are moving
-  if (doffer->isMoving() || sleever->isMoving())
+  // pause task if doffer or sleever are moving or broken
+  if (doffer->isMoving() || sleever->isMoving() ||
+      m_failures.isDown(doffer->getId()) || m_failures.isDown(sleever->getId()))
   {
     //qDebug() << "Wait for " << doffer->getId() << doffer->isMoving() << sleever->getId() << sleever->isMoving() << "Pausing" << ts->idSession;
-    ts->status = PAUSED;
+    setTaskStatus(ts, PAUSED);
     return;
   }
 
   // link secondary object to the primary one
-  ts->status = PROGRESS;
+  setTaskStatus(ts, PROGRESS);
   bool dofferPriority = ts->places;  // using places to store the doffer priority
   if (dofferPriority)
   {
@@ -1941,7 +3217,13 @@ void Supervisor::runHandleCollisionTask(TaskSession *ts)
   {
     // get sleever task session
     TaskSession *sts = getItemById<TaskSession>(sleever->getSession(), m_tasks);
-    if (sts != NULL)
+    if (sts != NULL && !ts->waitDoffer && canSleeverPass(doffer))
+    {
+      // the doffer stands in the passing zone, the sleever goes on without linking
+      if (ts->waitSleever)
+        sleever->reachObject(sleever->getSession(), sts->destPoint.x(), sts->destPoint.y());
+    }
+    else if (sts != NULL)
     {
       //qDebug() << "Linking " << doffer->getId() << "to" << sleever->getId();
       // link doffer to sleever
@@ -2019,9 +3301,18 @@ void Supervisor::setLocatorRectanges(Locator *priObject, Locator *secObject,
 }
 //_________________________________________________________
 //
+// Return true if sleevers may pass the doffer on the passing lane
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool Supervisor::canSleeverPass(Doffer *doffer)
+{
+  return m_track.canPass(doffer->x(), doffer->x() + doffer->width(), doffer->isMoving());
+}
+//_________________________________________________________
+//
 // Handles collision between doffer and sleever. If collision detected
 // both objects stop. After that the object with less priority links to another one.
-// Linked objects moves together until the host task session completed or cancelled
+// Linked objects moves together until the host task session completed or cancelled.
+// The sleever passes the doffer standing in a passing zone without stopping
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void Supervisor::processCollision(Doffer *doffer, Sleever *sleever, bool isDofferLead, int delta)
 {
@@ -2036,6 +3327,10 @@ void Supervisor::processCollision(Doffer *doffer, Sleever *sleever, bool isDoffe
   setLocatorRectanges(priObject, secObject, primaryRect, secondaryRect);
   if ((primaryRect.left() < secondaryRect.right() && primaryRect.right() > secondaryRect.left()))
   {
+    // sleever takes the passing lane
+    if (canSleeverPass(doffer))
+      return;
+
     // collision detected. Compairing priorities
     int dofferPrio = doffer->getStatus() == Doffer::BUSY ? 0 : (doffer->getStatus() == Doffer::DELIVER ? 2 : 3);
     int sleeverPrio = sleever->getStatus() == Sleever::BUSY ? 0 : (sleever->getStatus() == Sleever::READY ? 1 : 4);
@@ -2072,14 +3367,32 @@ void Supervisor::processCollision(Doffer *doffer, Sleever *sleever, bool isDoffe
 }
 //_________________________________________________________
 //
-// Slot activated after doffer has been moved. Here supervisor tests possible collisions
+// Movement handler of doffers and sleevers, it is called directly
+// by the locator on every movement step
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Supervisor::locatorMoved(Locator *locator, int delta)
+{
+  switch(locator->getKind())
+  {
+    case Locator::DOFFER:
+      dofferMoved(static_cast<Doffer *>(locator), delta);
+      break;
+    case Locator::SLEEVER:
+      sleeverMoved(static_cast<Sleever *>(locator), delta);
+      break;
+    default:
+      break;
+  }
+}
+//_________________________________________________________
+//
+// Called after doffer has been moved. Here supervisor tests possible collisions
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-void Supervisor::dofferMoved(QString idDoffer, QPoint newPos, int delta)
+void Supervisor::dofferMoved(Doffer *doffer, int delta)
 {
-  Q_UNUSED(newPos)
-  // check doffer and moving distance
-  Doffer *doffer = getItemById(idDoffer, m_doffers);
-  if (doffer == NULL || delta == 0) return;
+  PROFILE_SCOPE("Supervisor::dofferMoved");
+  // check moving distance
+  if (delta == 0) return;
   // check task session
   TaskSession *ts = getItemById<TaskSession>(doffer->getSession(), m_tasks);
   if (ts == NULL) return;
@@ -2096,7 +3409,7 @@ void Supervisor::dofferMoved(QString idDoffer, QPoint newPos, int delta)
     // if sleever already linked move it
     if (testObjectId(ts, sleever->getId()))
     {
-      sleever->move(sleever->x() + delta, sleever->y());
+      sleever->moveTo(sleever->x() + delta, sleever->y());
       continue;
     }
 
@@ -2113,14 +3426,13 @@ void Supervisor::dofferMoved(QString idDoffer, QPoint newPos, int delta)
 }
 //_________________________________________________________
 //
-// Slot activated after sleever has been moved. Here supervisor tests possible collisions
+// Called after sleever has been moved. Here supervisor tests possible collisions
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-void Supervisor::sleeverMoved(QString idSleever, QPoint newPos, int delta)
+void Supervisor::sleeverMoved(Sleever *sleever, int delta)
 {
-  Q_UNUSED(newPos)
-  // check doffer and moving distance
-  Sleever *sleever = getItemById(idSleever, m_sleevers);
-  if (sleever == NULL || delta == 0) return;
+  PROFILE_SCOPE("Supervisor::sleeverMoved");
+  // check moving distance
+  if (delta == 0) return;
   // check task session
   TaskSession *ts = getItemById<TaskSession>(sleever->getSession(), m_tasks);
   if (ts == NULL) return;
@@ -2138,7 +3450,7 @@ void Supervisor::sleeverMoved(QString idSleever, QPoint newPos, int delta)
     //if doffer already linked move it with sleever
     if (testObjectId(ts, doffer->getId()))
     {
-      doffer->move(doffer->x() + delta, doffer->y());
+      doffer->moveTo(doffer->x() + delta, doffer->y());
       continue;
     }
 
@@ -2198,6 +3510,14 @@ void Supervisor::moveSpoolerToTail(QString idSpooler)
   // set the last one to the idSpooler model pointer
   if (item != m_spoolersModel.end())
     *item = model;
+
+  // keep the reservation order of spooler objects and forget the replaced carrier
+  Spooler *spooler = getItemById<Spooler>(idSpooler, m_spoolers);
+  QList<Spooler *> &group = m_dofferSpoolers[model->idDoffer];
+  if (spooler == NULL || !group.removeOne(spooler)) return;
+  group.append(spooler);
+  foreach(const QString &key, m_recipeCarriers.keys(spooler))
+    m_recipeCarriers.remove(key);
 }
 //_________________________________________________________
 //
@@ -2229,6 +3549,17 @@ void Supervisor::SetWholeWidthPixels(int width)
 }
 //_________________________________________________________
 //
+// Override the database time coefficient for the next start,
+// 0 restores the database value
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Supervisor::setTimeCoefficient(int timeCoefficient)
+{
+  // should not be changed if supervisor is working
+  if (m_task_timer != 0) return;
+  m_timeCoefficientOverride = timeCoefficient > 0 ? timeCoefficient : 0;
+}
+//_________________________________________________________
+//
 // Calculate the aspect ratio
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void Supervisor::countAspectRatio(int space)
@@ -2312,9 +3643,77 @@ void Supervisor::setGroupBobbinsReady(QString idWinder)
 }
 //_________________________________________________________
 //
-// Update logger item field
+// Update logger item field at the current simulation time
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void Supervisor::updateLogger(QString idObject, Logger::FieldNames field)
 {
-  updateLoggerItem(idObject, field);
+  updateLoggerItem(idObject, field, simTime());
+}
+//_________________________________________________________
+//
+// Slot counts winders waiting for the doffer. The predicted completion
+// is dropped when the winder stops winding, the next one is predicted
+// when the winding starts again
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Supervisor::winderStatusChanged(QString idWinder, int prevStatus, int status)
+{
+  if (prevStatus == Winder::LOADED)
+  {
+    WinderModel *winderModel = getItemById<WinderModel>(idWinder, m_windersModel);
+    if (winderModel != NULL)
+      m_planner.remove(winderModel->idDoffer, idWinder);
+  }
+  int delta = (status == Winder::READY) - (prevStatus == Winder::READY);
+  if (delta != 0)
+    m_kpi.changeLevel(KpiEngine::WINDER_WAIT, simTime(), delta);
+}
+//_________________________________________________________
+//
+// Slot counts busy doffers
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Supervisor::dofferStatusChanged(QString idDoffer, int prevStatus, int status)
+{
+  Q_UNUSED(idDoffer)
+  int delta = (status != Doffer::IDLE) - (prevStatus != Doffer::IDLE);
+  if (delta != 0)
+    m_kpi.changeLevel(KpiEngine::DOFFER_BUSY, simTime(), delta);
+}
+//_________________________________________________________
+//
+// Slot counts busy sleevers
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Supervisor::sleeverStatusChanged(QString idSleever, int prevStatus, int status)
+{
+  Q_UNUSED(idSleever)
+  int delta = (status != Sleever::IDLE) - (prevStatus != Sleever::IDLE);
+  if (delta != 0)
+    m_kpi.changeLevel(KpiEngine::SLEEVER_BUSY, simTime(), delta);
+}
+//_________________________________________________________
+//
+// Return KPI values for all windows at the current time. Peak doffer
+// queues predicted by the last start plan are the same in all windows
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Supervisor::getKpiValues(QList<KpiValue> &list)
+{
+  m_kpi.values(simTime(), list);
+  if (m_startPlans.isEmpty()) return;
+
+  int peakBefore = 0;
+  int peakAfter = 0;
+  foreach(const StartPlanReport &it, m_startPlans)
+  {
+    peakBefore = qMax(peakBefore, it.peakBefore);
+    peakAfter = qMax(peakAfter, it.peakAfter);
+  }
+  KpiValue kpi;
+  kpi.name = "Start peak doffer queue unplanned";
+  kpi.unit = "tasks";
+  for(int w = 0; w < KpiEngine::WINDOW_COUNT; w++)
+    kpi.value[w] = peakBefore;
+  list.append(kpi);
+  kpi.name = "Start peak doffer queue planned";
+  for(int w = 0; w < KpiEngine::WINDOW_COUNT; w++)
+    kpi.value[w] = peakAfter;
+  list.append(kpi);
 }
@@ -1,7 +1,9 @@
 #ifndef SUPERVISOR_H
 #define SUPERVISOR_H
 
-#include <QMdiArea>
+#include <QObject>
+#include <QElapsedTimer>
+#include <QHash>
 
 #include "logger.h"
 #include "invdatabase.h"
@@ -10,14 +12,34 @@
 #include "sleever.h"
 #include "spooler.h"
 #include "man.h"
+#include "kpi.h"
+#include "syncworker.h"
+#include "triplebuffer.h"
+#include "prioheap.h"
+#include "planner.h"
+#include "track.h"
+#include "mandispatch.h"
+#include "forecast.h"
+#include "startplan.h"
+#include "failure.h"
+
+// Plant frame published for the canvas
+struct PlantFrame
+{
+  qint64 seq;               // frame number of the session, the first one is 1
+  qint64 time;              // simulation time of the frame (ms)
+  QRect dirty;              // layout area changed since the previous frame
+  QVector<qint32> state;    // plant state, see Supervisor::captureState
+};
 //_________________________________________________________
 //
-// Class represents supervisor widget. It manages task queue which contains task session records.
+// Class represents supervisor. It manages task queue which contains task session records.
 // Every record refers to necessary objects and contain specific information. Also supervisor manages
-// database models and their connections with child widgets objects. Communication is done with help of
-// signals and slots.
+// database models and their connections with child objects. Communication is done with help of
+// signals and slots. The running supervisor lives on the simulation thread and publishes the plant
+// state frame by frame, the canvas draws frames with the objects of the layout-only supervisor.
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-class Supervisor : public QFrame
+class Supervisor : public QObject, public PlantCanvas, public LocatorObserver
 {
   Q_OBJECT
 public:
@@ -58,33 +80,78 @@ public:
     int row;
     int column;
   };
+  // Further winder of the batched doffing trip
+  struct Pickup
+  {
+    QString idWinder;
+    int places;
+    QVector<SpoolerReservation> reserve;  // Cells for the winder bobbins
+  };
   struct TaskSession
   {
-    QString idSession;                    // Task session guid
+    QString idSession;                    // Task session id, unique in the run
     TaskStatus status;                    // Status
     TaskType type;                        // Type
     QString idAssignee;                   // Assignee id (i.e. Doffer Id)
     QString idObject;                     // Object id (i.e. Winder Id)
     int places;                           // Objects amount to deliver or set
     QVector<SpoolerReservation> reserve;  // Array of spooler reservations
+    int pickupPlaces;                     // Objects amount to take from the current object
+    QVector<Pickup> pickups;              // Further winders to collect in the same doffer trip
+    QString idTrip;                       // Doffer trip session collecting the bobbins of the merged task
     QVector<QString> linkedObjects;       // Array of linked objects which will move together with AssignedId object
     QPoint destPoint;                     // Destination point of linked object
     bool waitDoffer;                      // true if necessary to wait until doffer stop
     bool waitSleever;                     // true if necessary to wait until sleever stop
+    qint64 timeCreated;                   // Simulation time of the task creation (ms)
+    qint64 timeStarted;                   // Simulation time of the first progress, -1 if not started (ms)
+    qint64 timePaused;                    // Simulation time of the last pause (ms)
+    qint64 pauseTotal;                    // Paused time after the task start (ms)
+    int prio;                             // Winder priority of doffer & sleever tasks, the lower the earlier
+    qint64 seq;                           // Creation order number
+    bool queued;                          // true if the task is in the doffing or sleeving heap
+    qint64 startAfter;                    // Session clock time before which the man task is not started (ms)
+    bool early;                           // true if the man is called before the spooler is full
     QString getId() {return idSession;}
   };
+  // Heap entry of the pending doffer or sleever task
+  struct TaskEntry
+  {
+    int prio;                             // Task priority
+    qint64 seq;                           // Task creation order number
+    TaskSession *ts;                      // Task session
+    bool operator<(const TaskEntry &other) const {return prio < other.prio || (prio == other.prio && seq < other.seq);}
+  };
 
 
-  explicit Supervisor(QWidget *parent = 0);
+  explicit Supervisor(QObject *parent = 0);
   virtual ~Supervisor();
 
   ConfigModel &getConfigModel() {return m_config;}
+  void layout();
   void start();
-  void stop();
+  Q_INVOKABLE void stop();
   bool startWinders();
   int toPixels(int sourceValue);
   int toMillimeters(int sourceValue);
   void SetWholeWidthPixels(int width);
+  QSize getLayoutSize() {return m_layoutSize;}
+  void renderTo(QImage &image);
+  void setTimeCoefficient(int timeCoefficient);
+  void setFailureSeed(quint64 seed) {m_failureSeed = seed;}
+  void setExternalClock(bool external) {m_externalClock = external;}
+  quint64 getFailureSeed() {return m_failures.getSeed();}
+  Q_INVOKABLE void startTrace();
+  Q_INVOKABLE void stopTrace();
+  qint64 simTime();
+  virtual void invalidate(const QRect &rect);
+  virtual void locatorMoved(Locator *locator, int delta);
+  void getKpiValues(QList<KpiValue> &list);
+  const QList<StartPlanReport> &getStartPlans() {return m_startPlans;}
+  TripleBuffer<PlantFrame> &getFrames() {return m_frames;}
+  void captureState(QVector<qint32> &state);
+  int getItemsStateSize();
+  void drawState(QPainter &painter, const QRect &exposed, bool detailed, QVector<qint32> &state);
 
   // Return the object pointer with id
   template<class T> static T* getItemById(QString id, QList<T*> &list)
@@ -98,8 +165,11 @@ public:
   }
 
 signals:
-  void appendLoggerItem(QString idObject);
-  void updateLoggerItem(QString idObject, Logger::FieldNames field);
+  void appendLoggerItem(QString idObject, qint64 time);
+  void updateLoggerItem(QString idObject, Logger::FieldNames field, qint64 time);
+  void updateLatency(QString taskType, Logger::LatencyFields field, qint64 value);
+  void kpiUpdated(QList<KpiValue> values);
+  void frameReady();
 
 public slots:
   void manReached(QString idSession);
@@ -112,11 +182,13 @@ public slots:
   void bobbinsCutNeeded(QString idWinder);
   void winderFailed(QString idWinder);
   void winderAlert(QString idWinder);
+  void winderStarted(QString idWinder);
   void sleeverEmpty(QString idSleever);
   void spoolerFilled(QString idSpooler);
-  void dofferMoved(QString idDoffer, QPoint newPos, int delta);
-  void sleeverMoved(QString idSleever, QPoint newPos, int delta);
   void updateLogger(QString idObject, Logger::FieldNames field);
+  void winderStatusChanged(QString idWinder, int prevStatus, int status);
+  void dofferStatusChanged(QString idDoffer, int prevStatus, int status);
+  void sleeverStatusChanged(QString idSleever, int prevStatus, int status);
 
 protected:
   virtual void timerEvent(QTimerEvent *);
@@ -127,15 +199,20 @@ private:
   void seed();
   void sync();
   void callSleever(QString idWinder);
+  void dofferMoved(Doffer *doffer, int delta);
+  void sleeverMoved(Sleever *sleever, int delta);
 
   ManService *getFreeMan();
   ManService *getLeastBusyMan();
   ManService *getNearestMan(int xPos);
+  int getManWalkTime(int xPos);
   ManService *getManByStrategy(int xPos = 0, ManStrategy ms = NEAREST_OR_LEASTBUSY);
   void startMachine(TaskSession *ts);
   void runManServiceTask(TaskSession *ts);
-  bool tryReserveSpooler(QString idSpooler, SpoolerReservation &spres);
+  bool tryReserveCarrier(QString idDoffer, QString idRecipe, SpoolerReservation &spres);
   void cancelSpoolerReservation(QVector<SpoolerReservation> &resarray);
+  void collectPickups(TaskSession *ts, Doffer *doffer);
+  TaskSession *getPickupTask(TaskSession *trip, const QString &idWinder);
   void runDofferingTask(TaskSession *ts);
   void runSleeverTask(TaskSession *ts);
   void runHandleCollisionTask(TaskSession *ts);
@@ -146,18 +223,47 @@ private:
   void activateLinkedObjects(TaskSession *ts, bool isDofferLinked);
   void processCollision(Doffer *doffer, Sleever *sleever, bool isDofferLead, int delta);
   void handleCollision(Doffer *doffer, Sleever *sleever, bool isDofferPriority, bool waitDoffer, bool waitSleever);
-  void moveDofferAndSleever(QString idDofferSession, QString idWinder, QPoint dest, bool allowReadyDoffer);
+  bool moveDofferAndSleever(QString idDofferSession, QString idWinder, QPoint dest, bool allowReadyDoffer, bool withSleever = true);
   void cancelTask(TaskSession *ts);
+  void appendTask(TaskSession *ts, qint64 startAfter = 0);
+  void setTaskStatus(TaskSession *ts, TaskStatus status);
+  void countTaskLatency(TaskSession *ts, TaskStatus prevStatus);
+  void traceTask(TaskSession *ts);
+  QString newSessionId();
+  QString getObjectGroup(const QString &idObject);
+  bool isManTask(TaskSession *ts);
+  bool isManTaskQueued(TaskSession *ts);
+  ManService::OperFunc getManOperation(TaskSession *ts);
+  PlantItem *getManTaskObject(TaskSession *ts);
+  void dispatchMen();
+  void serveManTasks();
+  PriorityHeap<TaskEntry> *getTaskHeap(TaskSession *ts);
+  int getTaskPrio(TaskSession *ts);
+  void queueTask(TaskSession *ts);
+  void serveTasks(QHash<QString, PriorityHeap<TaskEntry> > &heaps);
+  void planWinderStarts(QHash<QString, qint64> &offsets);
+  void planDepartures();
+  void forecastCarriers();
+  TaskSession *getSpoolerTask(QString idSpooler);
+  bool requestSpoolerChange(Spooler *spooler, bool early);
+  void dispatchDoffer(QString idDoffer, QString idWinder);
   void moveSpoolerToTail(QString idSpooler);
   void countAspectRatio(int space);
   int countNewSleeverX(TaskSession *ts, Doffer *doffer, Sleever *sleever, int destX);
   void setLocatorRectanges(Locator *priObject, Locator *secObject, QRect &primaryRect, QRect &secondaryRect);
+  bool canSleeverPass(Doffer *doffer);
+  void startFailures();
+  void armFailureTimer();
+  void processFailures();
+  bool breakObject(const QString &idObject);
+  void repairObject(const QString &idObject);
   void setGroupBobbinsReady(QString idWinder);
+  QPixmap getServiceZonePixmap(const QSize &size);
 
   // Object models
   QList<WinderModel *> m_windersModel;      // database models
   QList<Winder *> m_winders;                // child objects
-  QList<QFrame *> m_services;               // service zones
+  QList<QRect> m_services;                  // service zone areas
 
   QList<DofferModel *> m_doffersModel;      // database models
   QList<Doffer *> m_doffers;                // child objects
@@ -167,17 +273,52 @@ private:
 
   QList<SpoolerModel *> m_spoolersModel;    // database models
   QList<Spooler *> m_spoolers;              // child objects
+  QStringList m_recipeNames;                // recipe ids of winder models, spooler states refer to them by number
+  QHash<QString, QList<Spooler *> > m_dofferSpoolers;   // child objects by doffer id in reservation order
+  QHash<QString, Spooler *> m_recipeCarriers;           // spooler taking packages by doffer and recipe id
+  QHash<QString, QString> m_spareCarriers;             // recipe the empty spooler is kept for by spooler id
+  QList<StartPlanReport> m_startPlans;                 // last winder start plan of every doffer group
+  QHash<QString, qint64> m_spoolerFillAt;              // forecast session clock time the spooler gets full by spooler id (ms)
 
   QList<ManServiceModel *> m_menModel;      // database models
   QList<ManService *> m_men;                // child objects
 
+  QList<FailureModel *> m_failuresModel;    // database models
+
   ConfigModel m_config;                     // database model
 
   QList<TaskSession *> m_tasks;             // Task session queue
-  int m_task_timer;                         // Task scan timer id
+  QHash<QString, PriorityHeap<TaskEntry> > m_doffingTasks;   // Pending tasks of every doffer by winder priority
+  QHash<QString, PriorityHeap<TaskEntry> > m_sleevingTasks;  // Pending tasks of every sleever by winder priority
+  qint64 m_taskSeq;                         // Next task creation order number
+  int m_sessionSeq;                         // Last task session id number of the run
+  QHash<QString, int> m_winderIndex;        // Dense winder index by winder id
+  QVector<int> m_doffPrio;                  // Doffing priority by winder index
+  QVector<int> m_sleeverPrio;               // Sleeving priority by winder index
+  DispatchPlanner m_planner;                // Predicted winder completions by doffer group
+  TrackModel m_track;                       // Passing zones of the doffer and sleever tracks
+  ManDispatcher m_manDispatcher;            // Routes of men over pending man tasks
+  bool m_menChanged;                        // Man tasks changed since the last routes plan
+  FailureScheduler m_failures;              // Scheduled breakdowns and repairs of plant objects
+  int m_failure_timer;                      // Failure event timer id of the simulation clock
+  quint64 m_failureSeed;                    // Failure random seed, 0 to take it from the clock
+  int m_task_timer;                         // Task scan timer id of the simulation clock
   int m_db_timer;                           // DB Sync timer id
+  SyncWorker m_syncWorker;                  // DB writer thread
+  KinematicsStore m_kinematics;             // Track movement of doffers and sleevers
+  int m_frame_timer;                        // Canvas frame timer id
+  QRect m_dirtyRect;                        // Canvas area invalidated since the last frame
+  TripleBuffer<PlantFrame> m_frames;        // Frames handed over to the canvas
+  qint64 m_frameSeq;                        // Last published frame number
+  int m_clock_timer;                        // Simulation clock tick timer id
+  bool m_externalClock;                     // true if the owner advances the simulation clock
+  QElapsedTimer m_wallClock;                // Wall time since the last clock tick
+  KpiEngine m_kpi;                          // Rolling window KPIs
   int m_wholeWidthPixels;                   // Calculated value of the supervisor width
   float m_aspectRatio;                      // Calculated aspect ratio to convert mm to pixels
+  QSize m_layoutSize;                       // Plant layout size in pixels at 1:1 zoom
+  int m_timeCoefficientOverride;            // Time coefficient used instead of the database one, 0 if not set
+  QVector<qint32> m_snapshot;               // Reusable state buffer for rendering
 
   int m_margin;                             // doffer & sleever constant margin
 
@@ -193,6 +334,26 @@ private:
     }
     return max;
   }
+  // Draw objects from the list in the recorded state
+  template<class T> void drawItemStates(QPainter &painter, QList<T*> &list, const QRect &exposed, bool detailed, qint32 *&state)
+  {
+    foreach(T *it, list)
+      it->renderState(painter, exposed, detailed, state);
+  }
+  // Append states of objects from the list
+  template<class T> void saveItemStates(QList<T*> &list, QVector<qint32> &state)
+  {
+    foreach(T *it, list)
+      it->saveState(state);
+  }
+  // Return the amount of state words of objects from the list
+  template<class T> int getStateSize(QList<T*> &list)
+  {
+    int size = 0;
+    foreach(T *it, list)
+      size += it->stateSize();
+    return size;
+  }
 
 
 };
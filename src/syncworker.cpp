@@ -0,0 +1,61 @@
+#include <QDebug>
+#include "syncworker.h"
+
+const int workerResolution = 50;    // time latency of the worker for new snapshots
+const char *const syncConnection = "scirocco-sync";   // worker thread database connection
+//_________________________________________________________
+//
+// Object constructor
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+SyncWorker::SyncWorker(QObject *parent /*=0*/) :
+  QThread(parent)
+{
+}
+//_________________________________________________________
+//
+// Object destructor. The thread is stopped first
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+SyncWorker::~SyncWorker()
+{
+  stop();
+}
+//_________________________________________________________
+//
+// Stop the thread. The last published snapshot is written first
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void SyncWorker::stop()
+{
+  if (!isRunning()) return;
+  requestInterruption();
+  wait();
+}
+//_________________________________________________________
+//
+// Thread body: write new snapshots until the stop request
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void SyncWorker::run()
+{
+  // database connections can not be shared between threads
+  {
+    QSqlDatabase db = InventoryDatabase::open(syncConnection);
+    bool stopping = false;
+    while (!stopping)
+    {
+      stopping = isInterruptionRequested();
+      if (m_snapshots.take())
+      {
+        SyncSnapshot &snapshot = m_snapshots.front();
+        db.transaction();                                               // start transaction
+        if (InventoryDatabase::updateDoffers(db, snapshot.doffers) &&   // update models
+            InventoryDatabase::updateSleevers(db, snapshot.sleevers))
+          db.commit();                                                  // commit if success
+        else
+          db.rollback();                                                // rollback if failed
+      }
+      if (!stopping)
+        msleep(workerResolution);
+    }
+    InventoryDatabase::close(db);
+  }
+  QSqlDatabase::removeDatabase(syncConnection);
+}
@@ -0,0 +1,39 @@
+#ifndef SYNCWORKER_H
+#define SYNCWORKER_H
+
+#include <QThread>
+#include "invdatabase.h"
+#include "triplebuffer.h"
+
+// Plant state published for the database update
+struct SyncSnapshot
+{
+  QList<DofferSyncModel> doffers;     // doffer update models
+  QList<SleeverSyncModel> sleevers;   // sleever update models
+};
+//_________________________________________________________
+//
+// Class writes published plant snapshots into the database on its
+// own thread. Snapshots are handed over through the triple buffer,
+// so neither side ever waits for the other and the worker always
+// gets the newest snapshot
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+class SyncWorker : public QThread
+{
+  Q_OBJECT
+public:
+  explicit SyncWorker(QObject *parent = 0);
+  virtual ~SyncWorker();
+
+  SyncSnapshot &backBuffer() {return m_snapshots.back();}
+  void publish() {m_snapshots.publish();}
+  void stop();
+
+protected:
+  virtual void run();
+
+private:
+  TripleBuffer<SyncSnapshot> m_snapshots;   // filled by the supervisor, written by the worker
+};
+
+#endif
@@ -0,0 +1,279 @@
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QDebug>
+#include "tracer.h"
+#include "simclock.h"
+
+bool TraceRecorder::m_recording = false;
+int TraceRecorder::m_timeCoefficient = 1;
+qint64 TraceRecorder::m_startTime = 0;
+QHash<QString, int> TraceRecorder::m_pids;
+QList<QString> TraceRecorder::m_processNames;
+QHash<QString, TraceRecorder::Span> TraceRecorder::m_spans;
+QList<QJsonObject> TraceRecorder::m_events;
+//_________________________________________________________
+//
+// Register the plant object as the trace process
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void TraceRecorder::registerObject(const QString &idObject, const QString &kind)
+{
+  QString name = kind + " " + idObject;
+  if (m_pids.contains(idObject))
+    m_processNames[m_pids.value(idObject) - 1] = name;
+  else
+  {
+    m_processNames.append(name);
+    m_pids.insert(idObject, m_processNames.size());
+  }
+}
+//_________________________________________________________
+//
+// Set simulation time coefficient to convert session clock time
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void TraceRecorder::setTimeCoefficient(int timeCoefficient)
+{
+  m_timeCoefficient = timeCoefficient > 0 ? timeCoefficient : 1;
+}
+//_________________________________________________________
+//
+// Start the new recording. Previous events are dropped
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void TraceRecorder::start()
+{
+  m_events.clear();
+  m_spans.clear();
+  m_startTime = SimClock::now();
+  m_recording = true;
+}
+//_________________________________________________________
+//
+// Stop the recording. Opened slices are closed
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void TraceRecorder::stop()
+{
+  if (!m_recording) return;
+  flush();
+  m_recording = false;
+}
+//_________________________________________________________
+//
+// Close all opened slices at the current time
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void TraceRecorder::flush()
+{
+  qint64 time = now();
+  foreach(const QString &key, m_spans.keys())
+  {
+    if (key.startsWith("task/"))
+      closeTaskSpan(key, key.mid(5), time);
+    else if (key.startsWith("state/"))
+      closeTaskSpan(key, key.mid(6), time);
+    else
+      closeSpan(key, time);
+  }
+}
+//_________________________________________________________
+//
+// Switch the object status slice
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void TraceRecorder::setStatus(const QString &idObject, const QString &status)
+{
+  if (!m_recording) return;
+
+  int pid = processId(idObject);
+  QString key = QString("%1/%2").arg(pid).arg(STATUS);
+  if (m_spans.contains(key) && m_spans.value(key).name == status) return;
+
+  qint64 time = now();
+  closeSpan(key, time);
+  if (!status.isEmpty())
+    openSpan(key, pid, STATUS, status, time);
+}
+//_________________________________________________________
+//
+// Switch the movement phase slice. The movement slice is opened
+// with the first phase and closed with empty phase name
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void TraceRecorder::setMotion(const QString &idObject, const QString &phase)
+{
+  if (!m_recording) return;
+
+  int pid = processId(idObject);
+  QString moveKey = QString("%1/%2").arg(pid).arg(MOTION);
+  QString phaseKey = QString("%1/%2").arg(pid).arg(PHASE);
+  if (m_spans.contains(phaseKey) && m_spans.value(phaseKey).name == phase) return;
+
+  // both slices use the same time to keep phases nested into the movement
+  qint64 time = now();
+  closeSpan(phaseKey, time);
+  if (phase.isEmpty())
+  {
+    closeSpan(moveKey, time);
+    return;
+  }
+  if (!m_spans.contains(moveKey))
+    openSpan(moveKey, pid, MOTION, "move", time);
+  openSpan(phaseKey, pid, MOTION, phase, time);
+}
+//_________________________________________________________
+//
+// Switch the task session state. The session slice is opened with
+// the first state and closed with empty status, args are attached
+// to the slice end in that case
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void TraceRecorder::setTaskState(const QString &idSession, const QString &idAssignee, const QString &type,
+                                 const QString &status, const QJsonObject &args)
+{
+  if (!m_recording) return;
+
+  QString taskKey = "task/" + idSession;
+  QString stateKey = "state/" + idSession;
+  if (m_spans.contains(stateKey) && m_spans.value(stateKey).name == status) return;
+
+  qint64 time = now();
+  closeTaskSpan(stateKey, idSession, time);
+  if (status.isEmpty())
+  {
+    closeTaskSpan(taskKey, idSession, time, args);
+    return;
+  }
+  int pid = processId(idAssignee);
+  if (!m_spans.contains(taskKey))
+    openSpan(taskKey, pid, 0, type, time, args);
+  openSpan(stateKey, pid, 0, status, time);
+}
+//_________________________________________________________
+//
+// Save recorded events as trace event JSON
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool TraceRecorder::save(const QString &fileName)
+{
+  QJsonArray events;
+  // process and thread names
+  for(int i = 0; i < m_processNames.size(); i++)
+  {
+    QJsonObject args;
+    args["name"] = m_processNames.at(i);
+    QJsonObject meta;
+    meta["ph"] = "M";
+    meta["pid"] = i + 1;
+    meta["name"] = "process_name";
+    meta["args"] = args;
+    events.append(meta);
+
+    QJsonObject sortArgs;
+    sortArgs["sort_index"] = i + 1;
+    meta["name"] = "process_sort_index";
+    meta["args"] = sortArgs;
+    events.append(meta);
+
+    args["name"] = "status";
+    meta["name"] = "thread_name";
+    meta["tid"] = STATUS;
+    meta["args"] = args;
+    events.append(meta);
+
+    args["name"] = "motion";
+    meta["tid"] = MOTION;
+    meta["args"] = args;
+    events.append(meta);
+  }
+  foreach(const QJsonObject &it, m_events)
+    events.append(it);
+
+  QJsonObject root;
+  root["traceEvents"] = events;
+  root["displayTimeUnit"] = "ms";
+
+  QFile file(fileName);
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+  {
+    qDebug() << "Trace saving failed" << file.errorString() << fileName;
+    return false;
+  }
+  file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+  file.close();
+  return true;
+}
+//_________________________________________________________
+//
+// Return simulation time since the recording start (us)
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+qint64 TraceRecorder::now()
+{
+  return (SimClock::now() - m_startTime) * 1000 * m_timeCoefficient;
+}
+//_________________________________________________________
+//
+// Return trace process id of the object. Unknown objects
+// get their own process
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+int TraceRecorder::processId(const QString &idObject)
+{
+  if (m_pids.contains(idObject))
+    return m_pids.value(idObject);
+  m_processNames.append(idObject.isEmpty() ? QString("Supervisor") : idObject);
+  m_pids.insert(idObject, m_processNames.size());
+  return m_processNames.size();
+}
+//_________________________________________________________
+//
+// Open the slice
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void TraceRecorder::openSpan(const QString &key, int pid, int tid, const QString &name, qint64 time,
+                             const QJsonObject &args /*= QJsonObject()*/)
+{
+  Span span;
+  span.name = name;
+  span.startTime = time;
+  span.pid = pid;
+  span.tid = tid;
+  span.args = args;
+  m_spans.insert(key, span);
+}
+//_________________________________________________________
+//
+// Close the object slice and add it as the complete event
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void TraceRecorder::closeSpan(const QString &key, qint64 time)
+{
+  if (!m_spans.contains(key)) return;
+  Span span = m_spans.take(key);
+
+  QJsonObject event;
+  event["name"] = span.name;
+  event["cat"] = span.tid == STATUS ? "status" : "motion";
+  event["ph"] = "X";
+  event["ts"] = span.startTime;
+  event["dur"] = time - span.startTime;
+  event["pid"] = span.pid;
+  event["tid"] = span.tid;
+  m_events.append(event);
+}
+//_________________________________________________________
+//
+// Close the task slice and add it as the async begin / end pair
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void TraceRecorder::closeTaskSpan(const QString &key, const QString &idSession, qint64 time,
+                                  const QJsonObject &args /*= QJsonObject()*/)
+{
+  if (!m_spans.contains(key)) return;
+  Span span = m_spans.take(key);
+
+  QJsonObject event;
+  event["name"] = span.name;
+  event["cat"] = "task";
+  event["id"] = idSession;
+  event["pid"] = span.pid;
+  event["tid"] = 0;
+  event["ph"] = "b";
+  event["ts"] = span.startTime;
+  event["args"] = span.args;
+  m_events.append(event);
+
+  event["ph"] = "e";
+  event["ts"] = time;
+  event["args"] = args;
+  m_events.append(event);
+}
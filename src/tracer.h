@@ -0,0 +1,68 @@
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <QString>
+#include <QList>
+#include <QHash>
+#include <QJsonObject>
+//_________________________________________________________
+//
+// Class records task sessions, object states and locator motion
+// as trace event JSON (chrome://tracing, ui.perfetto.dev).
+// Every plant object is a trace process with status and motion
+// threads, task sessions are async slices of the assignee process.
+// Timestamps are simulation microseconds.
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+class TraceRecorder
+{
+public:
+  static void registerObject(const QString &idObject, const QString &kind);
+  static void setTimeCoefficient(int timeCoefficient);
+
+  static void start();
+  static void stop();
+  static void flush();
+  static bool isRecording() {return m_recording;}
+
+  static void setStatus(const QString &idObject, const QString &status);
+  static void setMotion(const QString &idObject, const QString &phase);
+  static void setTaskState(const QString &idSession, const QString &idAssignee, const QString &type,
+                           const QString &status, const QJsonObject &args);
+  static bool save(const QString &fileName);
+
+private:
+  // Trace threads of the plant object
+  enum Layer
+  {
+    STATUS = 1,     // object status slices
+    MOTION,         // movement slices with nested phase slices
+    PHASE           // movement phase slices (key only, drawn on MOTION thread)
+  };
+  // Opened slice waiting for its end
+  struct Span
+  {
+    QString name;           // slice name
+    qint64 startTime;       // slice start time (us)
+    int pid;                // trace process id
+    int tid;                // trace thread id
+    QJsonObject args;       // slice arguments
+  };
+
+  static qint64 now();
+  static int processId(const QString &idObject);
+  static void openSpan(const QString &key, int pid, int tid, const QString &name, qint64 time,
+                       const QJsonObject &args = QJsonObject());
+  static void closeSpan(const QString &key, qint64 time);
+  static void closeTaskSpan(const QString &key, const QString &idSession, qint64 time,
+                            const QJsonObject &args = QJsonObject());
+
+  static bool m_recording;                      // true if events are recorded
+  static int m_timeCoefficient;                 // simulation time coefficient
+  static qint64 m_startTime;                    // session clock time of the recording start (ms)
+  static QHash<QString, int> m_pids;            // object id -> trace process id
+  static QList<QString> m_processNames;         // trace process names, index is pid - 1
+  static QHash<QString, Span> m_spans;          // opened slices
+  static QList<QJsonObject> m_events;           // recorded trace events
+};
+
+#endif
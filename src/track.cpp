@@ -0,0 +1,46 @@
+#include "track.h"
+//_________________________________________________________
+//
+// Add the passing zone keeping the zones sorted
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void TrackModel::appendZone(int left, int right)
+{
+  PassingZone zone;
+  zone.left = left;
+  zone.right = right;
+  int i = m_zones.size();
+  while (i > 0 && m_zones[i - 1].left > left)
+    i--;
+  m_zones.insert(i, zone);
+}
+//_________________________________________________________
+//
+// Return true if the interval lies within one passing zone
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool TrackModel::isInZone(int left, int right) const
+{
+  // zones are sorted and do not overlap, look for the last one
+  // starting at the interval start or before it
+  int lo = 0;
+  int hi = m_zones.size();
+  while (lo < hi)
+  {
+    int mid = (lo + hi) >> 1;
+    if (m_zones[mid].left <= left)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return lo > 0 && right <= m_zones[lo - 1].right;
+}
+//_________________________________________________________
+//
+// Lane rule: the sleever may pass the doffer if the doffer stands
+// and its body is inside a passing zone. The moving doffer may leave
+// the zone at any step, so the objects have to stop and link then
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool TrackModel::canPass(int dofferLeft, int dofferRight, bool dofferMoving) const
+{
+  if (dofferMoving) return false;
+  return isInZone(dofferLeft, dofferRight);
+}
@@ -0,0 +1,31 @@
+#ifndef TRACK_H
+#define TRACK_H
+
+#include <QVector>
+// Track interval where the sleever lane bypasses the doffer lane
+struct PassingZone
+{
+  int left;               // zone start x position
+  int right;              // zone end x position
+};
+//_________________________________________________________
+//
+// Class describes the doffer and sleever tracks. Both tracks are single
+// lanes, so doffers can not pass doffers and sleevers can not pass
+// sleevers. Inside a passing zone the sleever track swings out to the
+// second lane, there a sleever may pass a doffer which stands wholly
+// in the zone. Doffers have no second lane and never pass sleevers.
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+class TrackModel
+{
+public:
+  void clear() {m_zones.clear();}
+  void appendZone(int left, int right);
+  bool isInZone(int left, int right) const;
+  bool canPass(int dofferLeft, int dofferRight, bool dofferMoving) const;
+
+private:
+  QVector<PassingZone> m_zones;   // passing zones sorted by x position
+};
+
+#endif
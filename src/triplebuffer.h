@@ -0,0 +1,56 @@
+#ifndef TRIPLEBUFFER_H
+#define TRIPLEBUFFER_H
+
+#include <QAtomicInt>
+//_________________________________________________________
+//
+// Template class hands the newest value over from one writer thread
+// to one reader thread. The writer fills the back buffer and swaps it
+// with the middle one, the reader swaps the middle one with its front
+// buffer. Both swaps are single atomic exchanges, so neither side
+// ever waits for the other. Buffers are reused, their memory stays
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+template<class T> class TripleBuffer
+{
+public:
+  // Buffers 0, 1 and 2 are back, middle and front
+  TripleBuffer() : m_middle(1) {m_back = 0; m_front = 2;}
+
+  T &back() {return m_buffers[m_back];}
+  T &front() {return m_buffers[m_front];}
+
+  //_________________________________________________________
+  //
+  // Hand the filled back buffer over to the reader. The previous
+  // value is dropped if the reader has not taken it yet
+  //- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+  void publish()
+  {
+    m_back = m_middle.fetchAndStoreOrdered(m_back | newValue) & indexMask;
+  }
+  //_________________________________________________________
+  //
+  // Take the newest value into the front buffer. Return false if
+  // nothing is published since the last take
+  //- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+  bool take()
+  {
+    if (!(m_middle.loadAcquire() & newValue)) return false;
+    m_front = m_middle.fetchAndStoreOrdered(m_front) & indexMask;
+    return true;
+  }
+
+private:
+  enum
+  {
+    newValue = 4,     // middle index flag: the value is not taken by the reader
+    indexMask = 3     // middle index bits
+  };
+
+  T m_buffers[3];       // back, middle and front buffers
+  int m_back;           // buffer filled by the writer thread
+  int m_front;          // buffer read by the reader thread
+  QAtomicInt m_middle;  // handed over buffer index, newValue flag is set if it is not taken yet
+};
+
+#endif
@@ -1,18 +1,17 @@
 #include "supervisor.h"
 #include "winder.h"
+#include "profiler.h"
+#include "tracer.h"
+#include "simclock.h"
 
-const int timerResolution = 100;  // default tick latency for timers
+const char *const statusNames[] = {"EMPTY", "LOADED", "READY", "CUTEDGE", "FAIL"};   // status names for the trace
 //_________________________________________________________
 //
-// Object constructor. Set parameters from model, common styles and sizes
+// Object constructor. Set parameters and sizes from model
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-Winder::Winder(WinderModel &model, int timeCoefficient, QWidget *parent /*=0*/) :
-  QFrame(parent)
+Winder::Winder(WinderModel &model, int timeCoefficient, QObject *parent /*=0*/) :
+  PlantItem(parent)
 {
-  setLineWidth(1);
-  setFrameStyle(NoFrame | Plain);
-  setSizePolicy(QSizePolicy::Fixed, QSizePolicy::Fixed);
-
   //calculate and set widget sizes from model
   Supervisor *supervisor = (Supervisor *)parent;
   int winderWidth = supervisor->toPixels(model.width);
@@ -25,6 +24,8 @@ Winder::Winder(WinderModel &model, int timeCoefficient, QWidget *parent /*=0*/)
   m_timeExchange = model.timeExchange;
   m_halfMode = model.isHalfMode;
   m_id = model.idWinder;
+  m_recipe = model.idRecipe;
+  m_idText.setText(m_id);
 
   // set winder status
   m_status = EMPTY;
@@ -32,6 +33,7 @@ Winder::Winder(WinderModel &model, int timeCoefficient, QWidget *parent /*=0*/)
                               // but supervisor notification instead. Supervisor will send a man to cut bobbins
   m_readiness = 0;
   m_timeLeft = m_timeWind;
+  m_windStart = 0;
   m_timeCoefficient = timeCoefficient;
 
   // init timer ids
@@ -103,14 +105,41 @@ void Winder::drawSpools(QPainter &painter, QRect &rct, bool isHalf)
 }
 //_________________________________________________________
 //
-// Draw the control content according to its state
+// Return the background color of the status
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+QColor Winder::getStatusColor(Status status)
+{
+  switch(status)
+  {
+    case READY:
+      return QColor(232, 150, 55);
+    case FAIL:
+      return QColor(255, 97, 135);
+    case LOADED:
+      return QColor(95, 178, 150);
+    case EMPTY:
+      return QColor(190, 190, 190);
+    case CUTEDGE:
+      return QColor(115, 174, 206);
+    default:
+      return QColor(120, 120, 120);
+  }
+}
+//_________________________________________________________
+//
+// Return the cached status artwork: background, beams, sleeves and
+// ready bobbins. It depends on the size and state only, so all
+// winders of the same size share the same pixmaps
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-void Winder::paintEvent(QPaintEvent *pe)
+QPixmap Winder::getStatusPixmap(const QSize &size, Status status, bool isHalf)
 {
-  Q_UNUSED(pe)
+  QString key = QString("winder/%1x%2/%3/%4").arg(size.width()).arg(size.height()).arg(status).arg(isHalf);
+  QPixmap pixmap;
+  if (QPixmapCache::find(key, &pixmap))
+    return pixmap;
 
   QPainter painter;
-  QRect srcRect = rect();
+  QRect srcRect(QPoint(0, 0), size);
   QColor defColor(120, 120, 120);
 
   // calculate sizes
@@ -119,34 +148,62 @@ void Winder::paintEvent(QPaintEvent *pe)
   QRect beamLeft(QPoint(rct.left() + (rct.width() >> 3), rct.bottom()), bmSize);
   QRect beamRight(QPoint(rct.left() + 5 * (rct.width() >> 3), rct.bottom()), bmSize);
 
-  painter.begin(this);    // open drawing context
+  pixmap = QPixmap(size);
+  pixmap.fill(Qt::transparent);
+  painter.begin(&pixmap);   // open drawing context
 
   // draw background
-  switch(m_status)
+  painter.fillRect(rct, QBrush(getStatusColor(status), Qt::SolidPattern));
+
+  // draw beams and/or sleeves
+  switch(status)
   {
     case READY:
-      painter.fillRect(rct, QBrush(QColor(232, 150, 55), Qt::SolidPattern));
-      break;
     case FAIL:
-      painter.fillRect(rct, QBrush(QColor(255, 97, 135), Qt::SolidPattern));
+    case CUTEDGE:
+      drawSpools(painter, beamLeft, isHalf);
+      if (status == FAIL)
+        drawBeam(painter, beamRight, isHalf, defColor);
+      else
+        drawSleeve(painter, beamRight, isHalf);
       break;
     case LOADED:
-      painter.fillRect(rct, QBrush(QColor(95, 178, 150), Qt::SolidPattern));
+      drawSleeve(painter, beamLeft, isHalf);
+      drawSleeve(painter, beamRight, isHalf);
       break;
     case EMPTY:
-      painter.fillRect(rct, QBrush(QColor(190, 190, 190), Qt::SolidPattern));
-      break;
-    case CUTEDGE:
-      painter.fillRect(rct, QBrush(QColor(115, 174, 206), Qt::SolidPattern));
-      break;
-    default:
-      painter.fillRect(rct, QBrush(defColor, Qt::SolidPattern));
+      drawBeam(painter, beamLeft, isHalf, defColor);
+      drawSleeve(painter, beamRight, isHalf);
       break;
   }
 
+  painter.end();            // close drawing context
+  QPixmapCache::insert(key, pixmap);
+  return pixmap;
+}
+//_________________________________________________________
+//
+// Draw the control content according to its state. The status
+// artwork is cached, only the id, the countdown and the winded
+// bobbins are drawn live
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Winder::draw(QPainter &painter)
+{
+  PROFILE_SCOPE("Winder::draw");
+
+  QRect srcRect = rect();
+
+  // calculate sizes
+  QRect rct(srcRect.left(), srcRect.top(), srcRect.width(), srcRect.height() >> 1);
+  QSize bmSize(rct.width() >> 2, rct.height());
+  QRect beamRight(QPoint(rct.left() + 5 * (rct.width() >> 3), rct.bottom()), bmSize);
+
+  // draw background, beams and sleeves
+  painter.drawPixmap(srcRect.topLeft(), getStatusPixmap(srcRect.size(), m_status, m_halfMode));
+
   // draw info panel: id and winding time
   painter.setPen(QPen(Qt::white, 1, Qt::SolidLine));
-  painter.drawText(rct.left() + 5, 15, m_id);
+  painter.drawStaticText(rct.left() + 5, 15 - painter.fontMetrics().ascent(), m_idText);
   if (m_wind_timer > 0)
   {
       QString str = QString().setNum(m_timeLeft * m_timeCoefficient / 1000);
@@ -154,35 +211,52 @@ void Winder::paintEvent(QPaintEvent *pe)
       painter.drawText(rct.left() + 5, rct.bottom() - 5, str);
   }
 
-  // draw beams and/or sleeves
-  switch(m_status)
-  {
-    case READY:
-    case FAIL:
-    case CUTEDGE:
-      drawSpools(painter, beamLeft, m_halfMode);
-      if (m_status == FAIL)
-        drawBeam(painter, beamRight, m_halfMode, defColor);
-      else
-        drawSleeve(painter, beamRight, m_halfMode);
-      break;
-    case LOADED:
-      drawSleeve(painter, beamLeft, m_halfMode);
-      drawSleeve(painter, beamRight, m_halfMode);
-      break;
-    case EMPTY:
-      drawBeam(painter, beamLeft, m_halfMode, defColor);
-      drawSleeve(painter, beamRight, m_halfMode);
-      break;
-  }
-
   // draw bobbins
   if (m_wind_timer > 0 && m_status != FAIL)
   {
     drawBobbins(painter, beamRight, m_halfMode, m_readiness);
   }
-
-  painter.end();        // close drawing context
+}
+//_________________________________________________________
+//
+// Draw the simplified control: solid status block
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Winder::drawGlyph(QPainter &painter)
+{
+  painter.fillRect(rect(), QBrush(getStatusColor(m_status), Qt::SolidPattern));
+}
+//_________________________________________________________
+//
+// Append the compact state: position, status and winding progress
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Winder::saveState(QVector<qint32> &state)
+{
+  updateProgress();
+  PlantItem::saveState(state);
+  state.append(m_status);
+  state.append(m_readiness);
+  state.append(m_timeLeft);
+  state.append(m_wind_timer > 0 ? 1 : 0);
+}
+//_________________________________________________________
+//
+// Return the amount of state words
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+int Winder::stateSize()
+{
+  return PlantItem::stateSize() + 4;
+}
+//_________________________________________________________
+//
+// Swap drawing fields with the recorded ones. The wind timer id is
+// swapped for the drawing only, which checks it for zero
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Winder::exchangeState(qint32 *state)
+{
+  exchangeField(m_status, state[0]);
+  exchangeField(m_readiness, state[1]);
+  exchangeField(m_timeLeft, state[2]);
+  exchangeField(m_wind_timer, state[3]);
 }
 //_________________________________________________________
 //
@@ -190,16 +264,15 @@ void Winder::paintEvent(QPaintEvent *pe)
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void Winder::timerEvent(QTimerEvent* te)
 {
-  // wind timer handler
+  // wind timer handler. The timer is due at the alert and at the
+  // end of winding only, the progress is counted from the clock
   if (te->timerId() == m_wind_timer)
   {
-    // update ready percentage to reflect bobbins animation
-    m_timeLeft = m_timeLeft <= timerResolution ? 0 : (m_timeLeft - timerResolution);
-    m_readiness = 100 * (m_timeWind - m_timeLeft) / m_timeWind;
-    // if timer is over
+    updateProgress();
+    SimClock::killTimer(te->timerId());
+    // if winding is over
     if (m_timeLeft == 0)
     {
-      killTimer(te->timerId());
       m_wind_timer = 0;
       // set winder status
       if (m_status != LOADED)
@@ -213,18 +286,21 @@ void Winder::timerEvent(QTimerEvent* te)
         // switch machine onto exchange task
         startMachine(EXCHANGE);
     }
-    // if alert is possible notify supervisor
-    else if (m_timeLeft == m_timeAlert && !m_cutEdgeMode)
+    // the alert time, the timer is due again at the end of winding
+    else
     {
-      emit winderAlert(m_id);
+      m_wind_timer = SimClock::startTimer(this, m_timeLeft);
+      // if alert is possible notify supervisor
+      if (!m_cutEdgeMode)
+        emit winderAlert(m_id);
     }
-    update();
+    refresh();
   }
   // rotate timer handler. It's just a duration, not counter
   else if (te->timerId() == m_rotate_timer)
   {
     // the timer is over, kill it
-    killTimer(te->timerId());
+    SimClock::killTimer(te->timerId());
     m_rotate_timer = 0;
     // if cut edge mode is on notify supervisor
     if (m_cutEdgeMode)
@@ -240,7 +316,7 @@ void Winder::timerEvent(QTimerEvent* te)
     }
     // start the next winding task
     startMachine(START);
-    update();
+    refresh();
   }
 }
 //_________________________________________________________
@@ -255,12 +331,14 @@ void Winder::startMachine(OperFunc operation)
       m_timeLeft = m_timeWind;
       m_readiness = 0;
       m_rotate_timer = 0;
-      m_wind_timer = startTimer(timerResolution);
+      m_windStart = SimClock::now();
+      m_wind_timer = SimClock::startTimer(this, m_timeAlert > 0 && m_timeAlert < m_timeWind ? m_timeWind - m_timeAlert : m_timeWind);
+      emit windingStarted(m_id);
       break;
     case EXCHANGE:
       m_timeLeft = m_timeExchange;
       m_wind_timer = 0;
-      m_rotate_timer = startTimer(m_timeExchange);
+      m_rotate_timer = SimClock::startTimer(this, m_timeExchange);
       break;
     case STOP:
       break;
@@ -268,11 +346,40 @@ void Winder::startMachine(OperFunc operation)
 }
 //_________________________________________________________
 //
+// Count the winding time left and the readiness from the clock.
+// The winder is repainted when the drawn countdown or bobbins change
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Winder::updateProgress()
+{
+  if (m_wind_timer == 0) return;
+  int readiness = m_readiness;
+  int seconds = m_timeLeft * m_timeCoefficient / 1000;
+  m_timeLeft = qMax<qint64>(m_timeWind - (SimClock::now() - m_windStart), 0);
+  m_readiness = m_timeWind > 0 ? 100 * (m_timeWind - m_timeLeft) / m_timeWind : 100;
+  if (m_readiness != readiness || m_timeLeft * m_timeCoefficient / 1000 != seconds)
+    refresh();
+}
+//_________________________________________________________
+//
+// Return the time until the next bobbins are ready (ms)
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+int Winder::getTimeToReady()
+{
+  updateProgress();
+  return m_timeLeft + m_timeExchange;
+}
+//_________________________________________________________
+//
 // Public status setting method
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void Winder::setStatus(Status state)
 {
+  Status prevStatus = m_status;
   m_status = state;
+  TraceRecorder::setStatus(m_id, statusNames[state]);
+  // notify supervisor
+  if (prevStatus != state)
+    emit statusChanged(m_id, prevStatus, state);
 }
 //_________________________________________________________
 //
@@ -284,4 +391,26 @@ void Winder::startWinding()
   if (m_status != LOADED) return;
   startMachine(START);
 }
+//_________________________________________________________
+//
+// Stop the machine at once. The winding is lost, the winder has
+// failed until it is started again
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Winder::breakDown()
+{
+  if (m_wind_timer > 0)
+  {
+    SimClock::killTimer(m_wind_timer);
+    m_wind_timer = 0;
+  }
+  if (m_rotate_timer > 0)
+  {
+    SimClock::killTimer(m_rotate_timer);
+    m_rotate_timer = 0;
+  }
+  setStatus(FAIL);
+  // notify supervisor
+  emit winderFailed(m_id);
+  refresh();
+}
 
@@ -1,14 +1,14 @@
 #ifndef WINDER_H
 #define WINDER_H
 
-#include <QFrame>
 #include <QtGui>
+#include "plantitem.h"
 #include "invdatabase.h"
 //_________________________________________________________
 //
 // Class represents winder widget.
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-class Winder : public QFrame
+class Winder : public PlantItem
 {
   Q_OBJECT
 public:
@@ -28,34 +28,47 @@ public:
     START,              // start winding
     STOP                // reserved
   };
-  explicit Winder(WinderModel &model, int timeCoefficient, QWidget *parent = 0);
+  explicit Winder(WinderModel &model, int timeCoefficient, QObject *parent = 0);
+  virtual void draw(QPainter &painter);
+  virtual void drawGlyph(QPainter &painter);
+  virtual void saveState(QVector<qint32> &state);
+  virtual int stateSize();
 
   QString getId() {return m_id;}
+  QString getRecipe() {return m_recipe;}
   Status getStatus() {return m_status;}
   bool getCutEdgeMode() {return m_cutEdgeMode;}
+  int getTimeToReady();
+  bool isWinding() {return m_status == LOADED && m_wind_timer > 0;}
   void setCutEdgeMode(bool newState) {m_cutEdgeMode = newState;}
 
   void setStatus(Status state);
+  void updateProgress();
   void startWinding();
+  void breakDown();
 
   static void drawBobbins(QPainter &painter, QRect &rct, bool isHalf, int percentage = 100);
   static void drawBeam(QPainter &painter, QRect &rct, bool isHalf, QColor color);
   static void drawSpools(QPainter &painter, QRect &rct, bool isHalf);
   static void drawSleeve(QPainter &painter, QRect &rct, bool isHalf);
+  static QColor getStatusColor(Status status);
+  static QPixmap getStatusPixmap(const QSize &size, Status status, bool isHalf);
 
   QRect getBobbinsRect();
 
 signals:
+  void statusChanged(QString idObject, int prevStatus, int status);
   void bobbinsReady(QString idWinder);
   void bobbinsCutNeeded(QString idWinder);
   void winderFailed(QString idWinder);
   void winderAlert(QString idWinder);
+  void windingStarted(QString idWinder);
 
 public slots:
 
 protected:
   virtual void timerEvent(QTimerEvent *);
-  virtual void paintEvent(QPaintEvent *);
+  virtual void exchangeState(qint32 *state);
 
 private:
   void startMachine(OperFunc operation);
@@ -70,7 +83,10 @@ private:
 
   int m_readiness;        // winding completed percentage for the right tray
   QString m_id;           // object id
+  QString m_recipe;       // recipe id of packages, empty if not set
+  QStaticText m_idText;   // prepared id caption
   int m_timeLeft;         // time left counter
+  qint64 m_windStart;     // session clock time of the winding start (ms)
 
   int m_wind_timer;       // wind timer id
   int m_rotate_timer;     // tray rotate timer id